@@ -0,0 +1,89 @@
+/*
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+*/
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "arena.h"
+#include "nolibcall.h"
+
+
+#ifdef ARENA_POISON
+/* Fllt [from, to) mit dem Muster. Beide Grenzen sind auf ARENA_ALIGN
+ausgerichtet, es gengen also ganze Worte. */
+NO_LIBCALL static void poison(arena_t *a, uint32_t from, uint32_t to,
+                              uint32_t pattern)
+{
+    uint32_t *p = (uint32_t*)(a->base + from);
+    uint32_t *e = (uint32_t*)(a->base + to);
+
+    while (p < e)
+        *p++ = pattern;
+}
+#endif
+
+
+
+//----------------------------------------------------------------------------
+
+void arena_init(arena_t *a, void *mem, uint32_t size)
+{
+    a->base  = (uint8_t*)mem;
+    a->size  = size & ~(ARENA_ALIGN - 1);
+    a->used  = 0;
+    a->peak  = 0;
+    a->fails = 0;
+
+#ifdef ARENA_POISON
+    poison(a, 0, a->size, ARENA_FREED);
+#endif
+}
+
+
+
+void *arena_alloc(arena_t *a, uint32_t size)
+{
+    uint32_t start = a->used;
+
+    /* erst prfen, dann runden - sonst luft das Runden bei riesigen
+       Gren ber und ergibt 0 */
+    if (size > a->size - start ||
+        ((size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1)) > a->size - start) {
+        ++a->fails;
+        return 0;
+    }
+    size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+    a->used = start + size;
+    if (a->used > a->peak)
+        a->peak = a->used;
+
+#ifdef ARENA_POISON
+    poison(a, start, a->used, ARENA_FRESH);
+#endif
+
+    return a->base + start;
+}
+
+
+
+arena_mark_t arena_mark(const arena_t *a)
+{
+    return a->used;
+}
+
+
+
+void arena_reset(arena_t *a, arena_mark_t m)
+{
+    if (m > a->used)
+        return;
+
+#ifdef ARENA_POISON
+    poison(a, m, a->used, ARENA_FREED);
+#endif
+
+    a->used = m;
+}
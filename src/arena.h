@@ -0,0 +1,88 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+/*
+ * In den Dateien arena.h und arena.c findet sich eine Speicherverwaltung
+ * fr Zwischenergebnisse, die nur fr die Dauer eines Verarbeitungsschritts
+ * gebraucht werden - z.B. die Puffer eines Filters oder einer FFT, die
+ * einen Block von Messungen des Beschleunigungssensors bearbeiten.
+ *
+ * Eine Arena ist ein zusammenhngender Speicherbereich, der von vorne nach
+ * hinten vergeben wird ("bump pointer"): arena_alloc() rckt nur einen
+ * Zeiger vor, einzelne Puffer werden nie freigegeben. Stattdessen merkt
+ * sich arena_mark() den aktuellen Stand, und arena_reset() gibt alles
+ * danach Vergebene auf einmal zurck - typischerweise am Ende jedes
+ * Blocks:
+ *
+ *     arena_mark_t m = arena_mark(&scratch);
+ *     int16_t *x = arena_alloc(&scratch, n * sizeof(int16_t));
+ *     ...
+ *     arena_reset(&scratch, m);
+ *
+ * Marken lassen sich schachteln, solange sie in umgekehrter Reihenfolge
+ * zurckgesetzt werden. Beides kostet nur wenige Takte, und es entstehen
+ * keine Lcken.
+ *
+ * Jeder Puffer beginnt auf einer durch ARENA_ALIGN teilbaren Adresse. Die
+ * SIMD-Befehle des Cortex-M4 (z.B. __SMLAD, s. core_cm4_simd.h) verarbeiten
+ * zwei 16-Bit Werte in einem 32-Bit Wort, LDRD und LDM lesen mehrere Worte
+ * auf einmal - ausgerichtet lassen sich int16_t-Puffer also paarweise
+ * lesen. Wo der Speicher liegt, legt der Aufrufer mit ARENA_STORAGE fest:
+ * im CCM-RAM (ARENA_CCM) ist er ohne Wartezyklen und ohne Konkurrenz durch
+ * den DMA erreichbar, fr DMA-Puffer muss er im SRAM (ARENA_SRAM) liegen.
+ *
+ * Mit ARENA_POISON wird zurckgegebener Speicher mit ARENA_FREED und neu
+ * vergebener mit ARENA_FRESH gefllt. Wer einen Puffer nach arena_reset()
+ * oder vor dem ersten Schreiben liest, erkennt das im Debugger sofort.
+ *
+ * Eine Arena gehrt genau einem Programmteil; die Funktionen drfen nicht
+ * gleichzeitig aus Interruptroutinen aufgerufen werden.
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+// Ausrichtung aller Puffer (Zweierpotenz, mindestens 4)
+#define ARENA_ALIGN   8
+
+// Speicher einer Arena (s.o.)
+#define ARENA_CCM     __attribute__((section(".ccmram")))
+#define ARENA_SRAM
+
+#define ARENA_STORAGE(name, bytes, where) \
+    static uint64_t name[((bytes) + 7) / 8] \
+        where __attribute__((aligned(ARENA_ALIGN)))
+
+// Fllmuster fr ARENA_POISON
+//#define ARENA_POISON
+#define ARENA_FREED   0xDEADBEEF
+#define ARENA_FRESH   0xA5A5A5A5
+
+typedef struct
+{
+    uint8_t  *base;     // Anfang des Speichers
+    uint32_t  size;     // Gre in Byte
+    uint32_t  used;     // vergebene Byte
+    uint32_t  peak;     // hchster Wert von used seit arena_init()
+    uint32_t  fails;    // Anforderungen, fr die der Platz nicht reichte
+} arena_t;
+
+// Stand einer Arena fr arena_reset()
+typedef uint32_t arena_mark_t;
+
+/* Richtet eine Arena ber dem Speicher mem (size Byte) ein. mem sollte
+mit ARENA_STORAGE angelegt sein. */
+void arena_init(arena_t *a, void *mem, uint32_t size);
+
+/* Liefert einen auf ARENA_ALIGN ausgerichteten Puffer mit size Byte oder
+0, falls der Platz nicht reicht. */
+void *arena_alloc(arena_t *a, uint32_t size);
+
+/* Liefert den aktuellen Stand bzw. kehrt zu ihm zurck. */
+arena_mark_t arena_mark(const arena_t *a);
+void arena_reset(arena_t *a, arena_mark_t m);
+
+#endif
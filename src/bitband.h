@@ -0,0 +1,54 @@
+#ifndef BITBAND_H
+#define BITBAND_H
+
+/*
+ * Der Cortex-M4 bildet jedes einzelne Bit der ersten 1MB des SRAM (ab
+ * 0x20000000) und der ersten 1MB der Peripherie (ab 0x40000000) auf ein
+ * eigenes 32-Bit Wort in einem "Alias"-Bereich ab (bit-banding, s. [1]
+ * Abschnitt 2.3.3 und das "Cortex-M4 Devices Generic User Guide"):
+ *
+ *   Alias = Alias-Basis + (Byte-Offset * 32) + (Bitnummer * 4)
+ *
+ * mit der Alias-Basis 0x22000000 fr das SRAM und 0x42000000 fr die
+ * Peripherie. Schreibt man eine 0 oder 1 in ein solches Alias-Wort, so
+ * wird genau dieses eine Bit gelscht bzw. gesetzt. Das dafr ntige
+ * Lesen-ndern-Schreiben erledigt die Busmatrix, und zwar ununterbrechbar.
+ * Ein Interrupt kann sich also nicht mehr zwischen Lesen und Schreiben
+ * drngen, wie es bei "flags |= 0x04" passieren kann. Liest man ein
+ * Alias-Wort, so erhlt man den Wert des Bits (0 oder 1).
+ *
+ * Zwei Dinge sind zu beachten:
+ *  - Das CCM-RAM (ab 0x10000000) und SRAM jenseits der ersten 1MB sind
+ *    nicht bit-band-fhig.
+ *  - Auch das Alias-Wort fhrt intern ein Lesen-ndern-Schreiben des
+ *    ganzen Registers durch. Fr Register mit "Befehls"-Bits wie BSRR oder
+ *    mit "rc_w0"/"rc_w1"-Flags (z.B. TIMx_SR, DMA_LIFCR) ist ein einfaches
+ *    Schreiben des ganzen Registers daher die richtige Wahl.
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#define BITBAND_SRAM_BASE    0x20000000UL
+#define BITBAND_SRAM_ALIAS   0x22000000UL
+#define BITBAND_PERI_BASE    0x40000000UL
+#define BITBAND_PERI_ALIAS   0x42000000UL
+
+/* Alias-Wort fr Bit "bit" an der Adresse "addr". Aus den oberen 4 Bits
+der Adresse ergibt sich, ob es sich um SRAM oder Peripherie handelt. Ist
+addr eine Konstante (z.B. &GPIOD->ODR), so wird die gesamte Adresse vom
+Compiler berechnet. Liegt das Bit in einem Wort, so ist "bit" von 0 bis 31
+zu zhlen, bezogen auf die Adresse des Wortes. */
+#define BITBAND(addr, bit) \
+    (*(volatile uint32_t*)((((uint32_t)(addr)) & 0xF0000000UL) + 0x02000000UL \
+        + ((((uint32_t)(addr)) & 0x000FFFFFUL) << 5) + ((uint32_t)(bit) << 2)))
+
+// Bit atomar setzen, lschen und abfragen
+#define BITBAND_SET(addr, bit)    (BITBAND(addr, bit) = 1)
+#define BITBAND_CLEAR(addr, bit)  (BITBAND(addr, bit) = 0)
+#define BITBAND_TEST(addr, bit)   (BITBAND(addr, bit))
+
+#endif
@@ -0,0 +1,128 @@
+/*
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+*/
+
+/* Dieses Programm ist der Bootloader aus boot.h. Es wird getrennt vom
+brigen Programm gebaut (make boot) und enthlt daher ein eigenes main(). */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "boot.h"
+#include "cycles.h"
+#include "gpio.h"
+
+// u.a. Definition der Hardwareregister des STM32F4
+#include "libfoo/stm32f4xx.h"
+
+
+
+/* CRC ber words Worte mit der CRC-Einheit. RESET (Bit 0 in CRC_CR) setzt
+das Ergebnis auf den Startwert 0xFFFFFFFF, jedes nach CRC_DR geschriebene
+Wort wird eingerechnet. */
+static uint32_t crc_unit(const uint32_t *data, uint32_t words)
+{
+    CRC->CR = 0x00000001;
+    while (words--)
+        CRC->DR = *data++;
+
+    return CRC->DR;
+}
+
+/* Prft das Programm in einem Slot. Liefert 1 und dessen Version, falls der
+Kopf und die CRC stimmen und die ersten beiden Vektoren (Stack Pointer und
+Reset_Handler) plausibel sind. */
+static int check(uint32_t slot, uint32_t *version)
+{
+    const boot_header_t *h = (const boot_header_t*)slot;
+    const uint32_t *v = (const uint32_t*)(slot + BOOT_HEADER);
+
+    if (h->magic != BOOT_MAGIC || !h->length || (h->length & 3) ||
+        h->length > BOOT_SLOT_SIZE - BOOT_HEADER)
+        return 0;
+
+    // Stack im RAM, Reset_Handler (Thumb, Bit 0 gesetzt) im Programm
+    if (v[0] < 0x20000000 || v[0] > 0x20020000 ||
+        !(v[1] & 1) || v[1] < (uint32_t)v || v[1] >= (uint32_t)v + h->length)
+        return 0;
+
+    if (crc_unit(v, h->length / 4) != h->crc)
+        return 0;
+
+    *version = h->version;
+    return 1;
+}
+
+
+/* Springt in das Programm: Vektortabelle umstellen, Stack Pointer aus dem
+ersten Vektor laden und den Reset_Handler aufrufen - so, wie es der
+Prozessor nach einem Reset selbst tut. Interrupts hat der Bootloader keine
+eingeschaltet. */
+static void __attribute__((noreturn)) jump(uint32_t vectors)
+{
+    const uint32_t *v = (const uint32_t*)vectors;
+
+    SCB->VTOR = vectors;
+    __DSB();
+    __set_MSP(v[0]);
+    ((void (*)(void))v[1])();
+
+    while (1);
+}
+
+
+/* Kein gltiges Programm: die rote LED (PD14) blinkt. */
+static void __attribute__((noreturn)) fail(void)
+{
+    uint32_t t;
+
+    RCC->AHB1ENR |= 0x00000008;
+    GPIO_CONFIGURE(GPIOD, GPIO_PIN(14),
+        GPIO_MODE_OUT | GPIO_PP | GPIO_2MHZ | GPIO_NOPULL);
+
+    while (1) {
+        GPIO_TOGGLE(GPIOD, 0x4000);
+        t = cycles_now();
+        while (cycles_now() - t < 16000000 / 4);
+    }
+}
+
+
+
+//----------------------------------------------------------------------------
+
+int main(void)
+{
+    volatile boot_info_t *info = BOOT_INFO;
+    uint32_t t0, t1, slot, va = 0, vb = 0;
+    int a, b;
+
+    cycles_init();
+    t0 = cycles_now();
+
+    RCC->AHB1ENR |= 0x00001000;     // CRC-Einheit mit Takt versorgen
+
+    a  = check(BOOT_SLOT_A, &va);
+    t1 = cycles_now();
+    info->checkA = t1 - t0;
+    b  = check(BOOT_SLOT_B, &vb);
+    info->checkB = cycles_now() - t1;
+
+    RCC->AHB1ENR &= ~0x00001000;
+
+    // sind beide gltig, so startet die hhere Version
+    if (a && (!b || (int32_t)(va - vb) >= 0))
+        slot = BOOT_SLOT_A;
+    else if (b)
+        slot = BOOT_SLOT_B;
+    else
+        fail();
+
+    info->magic   = BOOT_MAGIC;
+    info->slot    = slot;
+    info->version = slot == BOOT_SLOT_A ? va : vb;
+    info->total   = cycles_now() - t0;
+
+    jump(slot + BOOT_HEADER);
+}
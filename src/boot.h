@@ -0,0 +1,90 @@
+#ifndef BOOT_H
+#define BOOT_H
+
+/*
+ * In den Dateien boot.h und boot.c findet sich ein kleiner Bootloader. Er
+ * liegt an der Stelle, an der sonst das Programm beginnt (0x08000000), und
+ * startet eines von zwei Programmen ("images"), die in zwei getrennten
+ * Bereichen ("slots") des Flash-Speichers liegen:
+ *
+ *     0x08000000  Sektor 0 und 1     Bootloader (32KB, stm32_boot.ld)
+ *     0x08020000  Sektor 5 und 6     Slot A (256KB, stm32_slot_a.ld)
+ *     0x08060000  Sektor 7 und 8     Slot B (256KB, stm32_slot_b.ld)
+ *     0x080C0000  Sektor 10 und 11   kvstore.c
+ *
+ * Ein neues Programm wird immer in den Slot geschrieben, der gerade nicht
+ * luft. Geht dabei etwas schief, so bleibt das alte Programm erhalten.
+ *
+ * Am Anfang jedes Slots steht ein Kopf (boot_header_t) mit Versionsnummer,
+ * Lnge und CRC-32 des Programms, das 512 Byte spter beginnt - mit seiner
+ * Vektortabelle, deren Adresse der Bootloader vor dem Sprung nach SCB->VTOR
+ * schreibt (die Tabelle muss dafr auf 512 Byte ausgerichtet sein). Den
+ * Kopf erzeugt tools/imgpack.c auf dem PC aus dem fertig gelinkten
+ * Programm.
+ *
+ * Die CRC rechnet der Bootloader mit der CRC-Einheit des STM32F4 (s. "CRC
+ * calculation unit" in [1]): Sie verarbeitet ein 32-Bit Wort in 4 Takten,
+ * das Prfen des Programms kostet also kaum Zeit. Sind beide Slots gltig,
+ * so startet die hhere Versionsnummer.
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+// Lage der Slots (s.o.)
+#define BOOT_SLOT_A     0x08020000
+#define BOOT_SLOT_B     0x08060000
+#define BOOT_SLOT_SIZE  0x00040000
+
+// Abstand der Vektortabelle vom Anfang des Slots
+#define BOOT_HEADER     0x200
+
+// Kennung im Kopf eines Slots ("IMG1")
+#define BOOT_MAGIC      0x31474D49
+
+/* Der Kopf eines Slots. Die restlichen Bytes bis BOOT_HEADER sind 0xFF. */
+typedef struct
+{
+    uint32_t magic;     // BOOT_MAGIC
+    uint32_t version;   // die hhere Version startet
+    uint32_t length;    // Lnge des Programms in Byte (Vielfaches von 4)
+    uint32_t crc;       // CRC-32 des Programms, s. boot_crc32()
+} boot_header_t;
+
+/* Informationen, die der Bootloader dem Programm bergibt. Sie liegen in
+den letzten 32 Byte des CCM-Speichers, die stm32_boot.ld und die Skripte der
+Slots aussparen - der Startup-Code des Programms lsst sie daher unberhrt.
+Die Zeiten sind Takte bei 16MHz (HSI), der Bootloader ndert den Takt nicht. */
+typedef struct
+{
+    uint32_t magic;     // BOOT_MAGIC, falls der Bootloader gestartet hat
+    uint32_t slot;      // Adresse des gestarteten Slots
+    uint32_t version;   // dessen Version
+    uint32_t checkA;    // Takte fr die Prfung von Slot A
+    uint32_t checkB;    // ... und Slot B
+    uint32_t total;     // Takte vom Beginn von main() bis zum Sprung
+} boot_info_t;
+
+#define BOOT_INFO  ((volatile boot_info_t*)0x1000FFE0)
+
+/* CRC-32 wie sie die CRC-Einheit berechnet: Polynom 0x04C11DB7, Startwert
+0xFFFFFFFF, die Daten als 32-Bit Worte mit dem hchsten Bit zuerst, ohne
+abschlieendes XOR. Diese Software-Variante dient tools/imgpack.c. */
+static inline uint32_t boot_crc32(uint32_t crc, const uint32_t *data,
+                                  uint32_t words)
+{
+    uint32_t i;
+
+    while (words--) {
+        crc ^= *data++;
+        for (i = 0; i < 32; ++i)
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : crc << 1;
+    }
+
+    return crc;
+}
+
+#endif
@@ -0,0 +1,129 @@
+/*
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+*/
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "button.h"
+#include "sched.h"
+#include "swtimer.h"
+
+// u.a. Definition der Hardwareregister des STM32F4
+#include "libfoo/stm32f4xx.h"
+
+
+/* Der Ablauf der Gesten. Whrend des Drckens luft der Timer gesture bis
+zum langen Drcken, nach dem Loslassen bis zum Ende der Wartezeit auf den
+zweiten Klick. Beides schliet sich aus, ein Timer gengt also. */
+#define IDLE     0      // nichts los
+#define PRESSED  1      // gedrckt, gesture luft bis BUTTON_LONG_US
+#define LONG     2      // LONG gemeldet, warten auf das Loslassen
+#define GAP      3      // losgelassen, gesture luft bis BUTTON_DOUBLE_US
+#define SECOND   4      // zum zweiten Mal gedrckt
+
+volatile button_stats_t button_stats;
+
+static sched_task_t *task;
+static uint32_t      debounce;
+static volatile int  stable;        // entprellter Zustand
+static int           phase;
+
+static swtimer_t     debounceTimer;
+static swtimer_t     gestureTimer;
+
+
+
+/* Der Pegel war ein ganzes Entprellfenster lang unverndert. Die beiden
+Rckruffunktionen laufen in der Interruptroutine von Timer 2, EXTI0_IRQ-
+Handler() hat dieselbe Prioritt - beide unterbrechen sich also nicht. */
+static void debounce_expired(swtimer_t *t)
+{
+    int level = GPIOA->IDR & 0x00000001;
+
+    if (level == stable) {
+        ++button_stats.glitches;
+        return;
+    }
+    stable = level;
+
+    if (level) {
+        ++button_stats.presses;
+        sched_post(task, BUTTON_EV_DOWN);
+
+        if (phase == GAP) {
+            swtimer_cancel(&gestureTimer);
+            phase = SECOND;
+        } else {
+            swtimer_start(&gestureTimer, BUTTON_LONG_US);
+            phase = PRESSED;
+        }
+    } else {
+        sched_post(task, BUTTON_EV_UP);
+
+        if (phase == PRESSED) {
+            swtimer_start(&gestureTimer, BUTTON_DOUBLE_US);
+            phase = GAP;
+        } else {
+            if (phase == SECOND)
+                sched_post(task, BUTTON_EV_DOUBLE);
+            phase = IDLE;
+        }
+    }
+}
+
+static void gesture_expired(swtimer_t *t)
+{
+    if (phase == PRESSED) {
+        sched_post(task, BUTTON_EV_LONG);
+        phase = LONG;
+    } else if (phase == GAP) {
+        sched_post(task, BUTTON_EV_CLICK);
+        phase = IDLE;
+    }
+}
+
+
+
+//----------------------------------------------------------------------------
+
+void button_init(sched_task_t *t, uint32_t window)
+{
+    task     = t;
+    debounce = window;
+    stable   = GPIOA->IDR & 0x00000001;
+    phase    = IDLE;
+
+    debounceTimer.fn = debounce_expired;
+    gestureTimer.fn  = gesture_expired;
+
+    /* ber den SYSCFG-Block (Takt ber Bit 14 im RCC_APB2ENR) wird die
+       EXTI-Leitung 0 mit Port A verbunden (EXTICR1, Bits 0 bis 3 = 0000)
+       und fr beide Flanken (RTSR und FTSR) freigeschaltet. EXTI0 ist
+       Interrupt Nummer 6 (Tabelle 30 in [1]). */
+    RCC->APB2ENR      |= 0x00004000;
+    SYSCFG->EXTICR[0] &= 0xFFFFFFF0;
+    EXTI->RTSR        |= 0x00000001;
+    EXTI->FTSR        |= 0x00000001;
+    EXTI->PR           = 0x00000001;
+    EXTI->IMR         |= 0x00000001;
+    NVIC->ISER[0]      = 0x00000040;
+}
+
+
+
+int button_pressed(void)
+{
+    return stable;
+}
+
+
+
+/* Jede Flanke schiebt das Ende des Entprellfensters hinaus. */
+void EXTI0_IRQHandler(void)
+{
+    EXTI->PR = 0x00000001;
+    ++button_stats.edges;
+    swtimer_start(&debounceTimer, debounce);
+}
@@ -0,0 +1,73 @@
+#ifndef BUTTON_H
+#define BUTTON_H
+
+/*
+ * In den Dateien button.h und button.c findet sich die Auswertung des
+ * User-Buttons (PA0) des discovery boards. Auf dem board fehlt der
+ * Kondensator C38, der den Taster entprellen sollte (s. discovery.c) - beim
+ * Drcken und Loslassen wechselt der Pegel daher oft mehrmals innerhalb
+ * weniger Millisekunden.
+ *
+ * Statt den Pin stndig abzufragen, meldet die Leitung EXTI0 jede Flanke.
+ * Jede Flanke startet einen Software-Timer (swtimer.c) neu; erst wenn der
+ * Pegel fr die Dauer des Entprellfensters ("debounce") unverndert war,
+ * gilt er als neuer Zustand des Tasters. Solange niemand den Taster be-
+ * rhrt, kostet er also keinen einzigen Takt.
+ *
+ * Aus den entprellten Zustnden werden Gesten erkannt und der beim Aufruf
+ * von button_init() angegebenen Aufgabe des Schedulers (sched.c) gemeldet:
+ *
+ *   DOWN/UP  jeder entprellte Wechsel
+ *   CLICK    einmal kurz gedrckt, danach BUTTON_DOUBLE_US lang nichts
+ *   DOUBLE   zweimal kurz gedrckt, das zweite Mal innerhalb von
+ *            BUTTON_DOUBLE_US nach dem Loslassen
+ *   LONG     lnger als BUTTON_LONG_US gedrckt (noch whrend des Drckens)
+ *
+ * Ein Klick wird also erst BUTTON_DOUBLE_US nach dem Loslassen gemeldet.
+ * Wer darauf nicht warten mag, verwendet DOWN bzw. UP.
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "sched.h"
+#include "swtimer.h"
+
+// Voreinstellung fr das Entprellfenster (s. button_init())
+#define BUTTON_DEBOUNCE_US  SWTIMER_MS(20)
+
+// Grenzen fr die Gesten
+#define BUTTON_DOUBLE_US    SWTIMER_MS(300)
+#define BUTTON_LONG_US      SWTIMER_MS(800)
+
+// Ereignisse (Bits in events der Aufgabe)
+#define BUTTON_EV_DOWN      0x00000001
+#define BUTTON_EV_UP        0x00000002
+#define BUTTON_EV_CLICK     0x00000004
+#define BUTTON_EV_DOUBLE    0x00000008
+#define BUTTON_EV_LONG      0x00000010
+
+// Statistik, z.B. zur Betrachtung im Debugger
+typedef struct
+{
+    uint32_t edges;     // Interrupts der Leitung EXTI0
+    uint32_t presses;   // entprellte Tastendrcke
+    uint32_t glitches;  // Prellen, nach dem der alte Pegel anlag
+} button_stats_t;
+
+extern volatile button_stats_t button_stats;
+
+/* Richtet die Leitung EXTI0 fr beide Flanken an PA0 ein (den Pin selbst
+stellt discovery_basic_init() ein). Der Scheduler muss zuvor mit
+sched_init() initialisiert worden sein. task erhlt die Ereignisse
+BUTTON_EV_*, window ist das Entprellfenster in us (z.B.
+BUTTON_DEBOUNCE_US). */
+void button_init(sched_task_t *task, uint32_t window);
+
+/* Liefert 1, solange der Taster (entprellt) gedrckt ist. */
+int button_pressed(void);
+
+#endif
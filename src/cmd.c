@@ -0,0 +1,134 @@
+/*
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+*/
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "cmd.h"
+#include "uart.h"
+#include "log.h"
+
+
+volatile cmd_stats_t cmd_stats;
+
+static const cmd_t *cmds;
+static uint32_t     cmdCount;
+
+
+
+static uint32_t skip_spaces(const uart_slice_t *line, uint32_t pos)
+{
+    while (pos < uart_slice_len(line) && uart_slice_at(line, pos) == ' ')
+        ++pos;
+
+    return pos;
+}
+
+
+/* Vergleicht das Wort ab pos mit name. Das Wort endet mit einem Leerzeichen
+oder dem Ende der Zeile. Liefert die Position dahinter oder 0, falls das
+Wort nicht passt. */
+static uint32_t word_is(const uart_slice_t *line, uint32_t pos,
+                        const char *name)
+{
+    uint32_t len = uart_slice_len(line);
+
+    while (*name) {
+        if (pos >= len || uart_slice_at(line, pos) != (uint8_t)*name)
+            return 0;
+        ++pos;
+        ++name;
+    }
+
+    if (pos < len && uart_slice_at(line, pos) != ' ')
+        return 0;
+
+    return pos;
+}
+
+
+static void help(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < cmdCount; ++i)
+        log_printf("%s - %s\n", cmds[i].name, cmds[i].help);
+}
+
+
+
+//----------------------------------------------------------------------------
+
+void cmd_init(const cmd_t *table, uint32_t count)
+{
+    cmds     = table;
+    cmdCount = count;
+
+    uart_rx_start(cmd_dispatch);
+}
+
+
+
+void cmd_dispatch(const uart_slice_t *line)
+{
+    uint32_t pos = skip_spaces(line, 0);
+    uint32_t i, end;
+
+    if (pos == uart_slice_len(line))
+        return;
+
+    for (i = 0; i < cmdCount; ++i) {
+        end = word_is(line, pos, cmds[i].name);
+        if (end) {
+            ++cmd_stats.executed;
+            cmds[i].fn(line, end);
+            return;
+        }
+    }
+
+    if (word_is(line, pos, "help")) {
+        help();
+        return;
+    }
+
+    ++cmd_stats.unknown;
+    log_printf("? (help listet alle Kommandos)\n");
+}
+
+
+
+int cmd_arg(const uart_slice_t *line, uint32_t *pos, uint32_t *value)
+{
+    uint32_t len = uart_slice_len(line);
+    uint32_t p   = skip_spaces(line, *pos);
+    uint32_t v = 0, base = 10, digits = 0;
+    uint8_t c;
+
+    if (p + 1 < len && uart_slice_at(line, p) == '0' &&
+        (uart_slice_at(line, p + 1) | 0x20) == 'x') {
+        base = 16;
+        p += 2;
+    }
+
+    for (; p < len; ++p) {
+        c = uart_slice_at(line, p);
+        if (c >= '0' && c <= '9')
+            c -= '0';
+        else if (base == 16 && (c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+            c = (c | 0x20) - 'a' + 10;
+        else
+            break;
+        v = v * base + c;
+        ++digits;
+    }
+
+    if (!digits || (p < len && uart_slice_at(line, p) != ' '))
+        return 0;
+
+    *pos   = p;
+    *value = v;
+
+    return 1;
+}
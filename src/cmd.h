@@ -0,0 +1,58 @@
+#ifndef CMD_H
+#define CMD_H
+
+/*
+ * In den Dateien cmd.h und cmd.c findet sich ein einfacher Kommando-
+ * interpreter fr Zeilen, die ber uart.c empfangen werden. Eine Zeile
+ * besteht aus einem Kommandowort und optionalen, durch Leerzeichen
+ * getrennten Argumenten, z.B. "led 2 1". Welche Kommandos es gibt, legt
+ * eine Tabelle fest, die der Anwender mit cmd_init() bergibt. Das
+ * Kommando "help" listet sie auf.
+ *
+ * Die Zeilen werden nicht kopiert, sondern direkt im Empfangsring
+ * ausgewertet (s. uart_slice_t). Die Kommandos laufen daher im Interrupt
+ * und sollten kurz sein.
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "uart.h"
+
+/* Funktion eines Kommandos. pos ist die Position hinter dem Kommandowort,
+ab der cmd_arg() die Argumente liest. */
+typedef void (*cmd_fn)(const uart_slice_t *line, uint32_t pos);
+
+typedef struct
+{
+    const char *name;
+    cmd_fn      fn;
+    const char *help;       // Kurzbeschreibung fr "help"
+} cmd_t;
+
+// Statistik, z.B. zur Betrachtung im Debugger
+typedef struct
+{
+    uint32_t executed;  // ausgefhrte Kommandos
+    uint32_t unknown;   // unbekannte Kommandos
+} cmd_stats_t;
+
+extern volatile cmd_stats_t cmd_stats;
+
+/* Legt die Tabelle der Kommandos fest und startet den Empfang ber
+uart_rx_start(). uart_init() muss zuvor aufgerufen worden sein. */
+void cmd_init(const cmd_t *table, uint32_t count);
+
+/* Sucht das Kommando einer Zeile in der Tabelle und fhrt es aus. Wird von
+cmd_init() an uart_rx_start() bergeben. */
+void cmd_dispatch(const uart_slice_t *line);
+
+/* Liest ab *pos ein Argument als vorzeichenlose Dezimalzahl (oder hexa-
+dezimal mit "0x"). Liefert 0, falls kein Argument mehr folgt oder es keine
+Zahl ist. */
+int cmd_arg(const uart_slice_t *line, uint32_t *pos, uint32_t *value);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef CYCLES_H
+#define CYCLES_H
+
+/*
+ * Der Cortex-M4 besitzt in seiner "Data Watchpoint and Trace"-Einheit (DWT)
+ * einen 32-Bit Zhler, der mit jedem Prozessortakt um eins erhht wird.
+ * Damit lsst sich die Laufzeit von Codeabschnitten taktgenau messen. Die
+ * Register der DWT sind in der (lteren) CMSIS-Datei core_cm4.h nicht
+ * definiert, daher legen wir sie wie in discovery.c selbst an. Eine
+ * Beschreibung findet sich im "ARMv7-M Architecture Reference Manual"
+ * (Abschnitt C1.8).
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+// Debug Exception and Monitor Control Register, Bit 24 = TRCENA
+#define CYCLES_DEMCR   (*(volatile uint32_t*)0xE000EDFC)
+// DWT Control Register, Bit 0 = CYCCNTENA
+#define CYCLES_CTRL    (*(volatile uint32_t*)0xE0001000)
+// DWT Cycle Count Register
+#define CYCLES_CYCCNT  (*(volatile uint32_t*)0xE0001004)
+
+/* Schaltet den Taktzhler ein. Ohne TRCENA ist die DWT abgeschaltet. */
+static inline void cycles_init(void)
+{
+    CYCLES_DEMCR |= 0x01000000;
+    CYCLES_CYCCNT = 0;
+    CYCLES_CTRL  |= 0x00000001;
+}
+
+/* Liefert den aktuellen Stand des Taktzhlers. Da der Zhler nach etwa
+25 Sekunden (2^32 / 168MHz) berluft, sollten immer nur Differenzen
+betrachtet werden. Diese sind dank vorzeichenloser Arithmetik auch ber
+einen berlauf hinweg korrekt. */
+static inline uint32_t cycles_now(void)
+{
+    return CYCLES_CYCCNT;
+}
+
+#endif
@@ -9,6 +9,37 @@
 
 #include "discovery.h"
 
+// Makros zur Konfiguration der GPIO-Pins
+#include "gpio.h"
+
+
+
+/* Der Registersatz eines GPIO-Ports als zusammengesetzter Datentyp. Eine
+ausfhrliche Erluterung hierzu findet sich in discovery_basic_init(). */
+typedef struct
+{
+    volatile uint32_t MODER;    /* GPIO port mode register,
+                                    Address offset: 0x00 */
+    volatile uint32_t OTYPER;   /* GPIO port output type register,
+                                    Address offset: 0x04 */
+    volatile uint32_t OSPEEDR;  /* GPIO port output speed register,
+                                    Address offset: 0x08 */
+    volatile uint32_t PUPDR;    /* GPIO port pull-up/pull-down register,
+                                    Address offset: 0x0C */
+    volatile uint32_t IDR;      /* GPIO port input data register,
+                                    Address offset: 0x10 */
+    volatile uint32_t ODR;      /* GPIO port output data register,
+                                    Address offset: 0x14 */
+    volatile uint16_t BSRRL;    /* GPIO port bit set/reset low register,
+                                    Address offset: 0x18 */
+    volatile uint16_t BSRRH;    /* GPIO port bit set/reset high register,
+                                    Address offset: 0x1A */
+    volatile uint32_t LCKR;     /* GPIO port configuration lock register,
+                                    Address offset: 0x1C */
+    volatile uint32_t AFR[2];   /* GPIO alternate function registers,
+                                    Address offset: 0x24-0x28 */
+} GPIO_TDef;
+
 
 
 /* Die Methode discovery_init() initialisiert zunchst nur die
@@ -95,30 +126,18 @@ hintereinander an einer Basisadresse wiederfinden, auch als einen zusammenge-
 setzen Datentyp beschreiben. Fr die GPIO-Register, die in [1] ab Seite 148
 beschrieben sind, ergibt sich damit der folgende zusammengesetzte Datentyp: */
 
+/*
 typedef struct
 {
-    volatile uint32_t MODER;    /* GPIO port mode register,
-                                    Address offset: 0x00 */
-    volatile uint32_t OTYPER;   /* GPIO port output type register,
-                                    Address offset: 0x04 */
-    volatile uint32_t OSPEEDR;  /* GPIO port output speed register,
-                                    Address offset: 0x08 */
-    volatile uint32_t PUPDR;    /* GPIO port pull-up/pull-down register,
-                                    Address offset: 0x0C */
-    volatile uint32_t IDR;      /* GPIO port input data register,
-                                    Address offset: 0x10 */
-    volatile uint32_t ODR;      /* GPIO port output data register,
-                                    Address offset: 0x14 */
-    volatile uint16_t BSRRL;    /* GPIO port bit set/reset low register,
-                                    Address offset: 0x18 */
-    volatile uint16_t BSRRH;    /* GPIO port bit set/reset high register,
-                                    Address offset: 0x1A */
-    volatile uint32_t LCKR;     /* GPIO port configuration lock register,
-                                    Address offset: 0x1C */
-    volatile uint32_t AFR[2];   /* GPIO alternate function registers,
-                                    Address offset: 0x24-0x28 */
+    volatile uint32_t MODER;    // Address offset: 0x00
+    volatile uint32_t OTYPER;   // Address offset: 0x04
+    ...
+    volatile uint32_t AFR[2];   // Address offset: 0x24-0x28
 } GPIO_TDef;
 
+Da wir den Datentyp auch in discovery_acc_init() bentigen, ist er nicht
+hier, sondern einmalig am Anfang dieser Datei vollstndig definiert. */
+
 /* Durch die Verwendung der in <stdint.h> definierten Standard-Integertypen
 kann die Bitbreite jedes Eintrags im Struct GPIO_TDef exakt festgelegt 
 werden. Es ist hierbei zwingend notwendig, dass die in der Dokumentation auf
@@ -159,21 +178,20 @@ Bits 24:25, 26:27, 28:29 und 30:31. Sucht man sich f
 eintrge die entsprechenden Informationen auf den Seiten 148ff zusammen, so 
 kommt die folgende Konfiguration der LED-Pins PD12 bis PD15 zustande: */
 
-// Bits 24 bis 31 im MODER-Register "freirumen"
-GPIOD->MODER &= 0x00FFFFFF;
-// setze Bits 24 bis 31 im MODER-Register auf 0101 0101
-GPIOD->MODER |= 0x55000000;
+/* Man kann diese Masken wie oben von Hand ausrechnen - dabei verrechnet man
+sich aber leicht. Die Makros in gpio.h erledigen das zur bersetzungszeit.
+brig bleibt fr jedes Register genau ein Lesen-ndern-Schreiben, z.B.
 
-// setze Bits 12 bis 15 im OTYPER-Register auf 0
-GPIOD->OTYPER &= 0xFFFF0FFF;
+    GPIOD->MODER   = (GPIOD->MODER   & 0x00FFFFFF) | 0x55000000;
+    GPIOD->OTYPER  =  GPIOD->OTYPER  & 0xFFFF0FFF;
+    GPIOD->OSPEEDR = (GPIOD->OSPEEDR & 0x00FFFFFF) | 0x55000000;
+    GPIOD->PUPDR   =  GPIOD->PUPDR   & 0x00FFFFFF;
 
-// Bits 24 bis 31 im OSPEEDR-Register "freirumen"
-GPIOD->OSPEEDR &= 0x00FFFFFF;
-// setze Bits 24 bis 31 im OSPEEDR-Register auf 0101 0101 (25MHz)
-GPIOD->OSPEEDR |= 0x55000000;
+Die Geschwindigkeit "01" entspricht hierbei 25MHz: */
 
-// Setze Bits 24 bis 31 im PUPDR-Register auf 0000 0000
-GPIOD->PUPDR &= 0x00FFFFFF;
+GPIO_CONFIGURE(GPIOD,
+    GPIO_PIN(12) | GPIO_PIN(13) | GPIO_PIN(14) | GPIO_PIN(15),
+    GPIO_MODE_OUT | GPIO_PP | GPIO_25MHZ | GPIO_NOPULL);
 
 /* Auf hnliche Weise wie wir soeben die PINs fr unsere LEDs konfiguriert 
 haben, knnen wir uns nun dem Input Pin fr den Taster zuwenden. In Tabelle 14
@@ -183,11 +201,8 @@ bedeutet, dass hier die konkreten Registerwerte keine Bedeutung haben. H
 wird dies auch als "don't care" bezeichnet. Wir mssen fr unseren Input-Pin
 also nur das MODER-Register und das PUPDR-Register einstellen: */
 
-// Bits 0 und 1 im MODER-Register auf 00 setzen
-GPIOA->MODER &= 0xFFFFFFFC;
-
-// Bits 0 und 1 im PUPDR-Register auf 00 setzen
-GPIOA->PUPDR &= 0xFFFFFFFC;
+// MODER(0) = 00, PUPDR(0) = 00, OTYPER und OSPEEDR bleiben unberhrt
+GPIO_CONFIGURE(GPIOA, GPIO_PIN(0), GPIO_MODE_IN | GPIO_NOPULL);
 
 /* Die Werte, die an den einzelnen IO-Pins eines Ports anliegen, stehen im 
 IDR-Register. Sie werden in jedem Takt von der Hardwareseite aus aktualisiert.
@@ -199,12 +214,13 @@ STM32 nicht von anderen Mikrocontrollern. Er hat aber noch zwei zus
 Register: BSRRL und BSRRH. Dies sind Set- und Reset-Register fr die IO-Pins
 des jeweiligen Ports. Schreibt man eine 1 in ein Bit des BSRRL-Registers, so
 wird der zugehrige Pin logisch 1, Schreibt man eine 1 in ein Bit des BSRRH-
-Registers, so wird der zugehrige Pin logisch 0. Setzen wir also die LED-Pins
-initial auf 0:*/
+Registers, so wird der zugehrige Pin logisch 0. Nullen werden ignoriert.
+Ein "|=" ist daher berflssig - es wrde das Register nur unntig vorher
+lesen. Setzen wir also die LED-Pins initial auf 0:*/
 
 // Bits 12 bis 15 des BSRRH-Registers auf 1 
 //   -> (IO Pins 12 bis 15 auf logisch 0)
-GPIOD->BSRRH |= 0xF000;
+GPIOD->BSRRH = 0xF000;
 
 /* Die Konfiguration der einfachen Komponenten (LEDs und Taster) des discovery 
 boards ist damit abgeschlossen. */
@@ -247,99 +263,32 @@ passenden Pointer gezimmert: */
 static const uint32_t GPIOA_BASE = 0x40020000;
 static const uint32_t GPIOE_BASE = 0x40021000;
 
-typedef struct
-{
-    volatile uint32_t MODER;    /* GPIO port mode register,
-                                    Address offset: 0x00 */
-    volatile uint32_t OTYPER;   /* GPIO port output type register,
-                                    Address offset: 0x04 */
-    volatile uint32_t OSPEEDR;  /* GPIO port output speed register,
-                                    Address offset: 0x08 */
-    volatile uint32_t PUPDR;    /* GPIO port pull-up/pull-down register,
-                                    Address offset: 0x0C */
-    volatile uint32_t IDR;      /* GPIO port input data register,
-                                    Address offset: 0x10 */
-    volatile uint32_t ODR;      /* GPIO port output data register,
-                                    Address offset: 0x14 */
-    volatile uint16_t BSRRL;    /* GPIO port bit set/reset low register,
-                                    Address offset: 0x18 */
-    volatile uint16_t BSRRH;    /* GPIO port bit set/reset high register,
-                                    Address offset: 0x1A */
-    volatile uint32_t LCKR;     /* GPIO port configuration lock register,
-                                    Address offset: 0x1C */
-    volatile uint32_t AFR[2];   /* GPIO alternate function registers,
-                                    Address offset: 0x24-0x28 */
-} GPIO_TDef;
-
 volatile GPIO_TDef *GPIOA = (GPIO_TDef*)(GPIOA_BASE);
 volatile GPIO_TDef *GPIOE = (GPIO_TDef*)(GPIOE_BASE);
 
 /* Wir konfigurieren nun PA5 bis PA7 als Alternate Function 5 (S.56 in [2]):
-Die Taktleitung SPI1_SCK an PA5 wird als Output-Push-Pull mit 2MHz 
-konfiguriert (s.Tabelle 14 auf S.138 in [1]): */
-
-//MODER = 10, OTYPER = 0, OSPEEDR = 00, PUPDR = 00
-
-// Bits 10 und 11, S.148 in [1]:
-GPIOA->MODER &= 0xFFFFF3FF;
-GPIOA->MODER |= 0x00000800;
-
-// Bit 5, S.148 in [1]:
-GPIOA->OTYPER &= 0xFFFFFFDF;
-
-// Bits 10 und 11, S.149 in [1]:
-GPIOA->OSPEEDR &= 0xFFFFF3FF;
-
-// Bits 10 und 11, S.149 in [1]:
-GPIOA->PUPDR &= 0xFFFFF3FF;
-
-// Alternate Function 5, Bits 20 bis 23, S.152 in [1]:
-GPIOA->AFR[0] &= 0xFF0FFFFF;
-GPIOA->AFR[0] |= 0x00500000;
-
-/* Der SPI1 Master In Slave Out (MISO) an PA6 wird als Input Open-Drain mit 
-2MHz konfiguriert (s.Tabelle 14 auf S.138 in [1]): */
-
-//MODER = 10, OTYPER = 1, OSPEEDR = 00, PUPDR = 00
+Die Taktleitung SPI1_SCK an PA5 und der SPI1 Master Out Slave In (MOSI) an
+PA7 werden als Output-Push-Pull mit 2MHz konfiguriert, der SPI1 Master In
+Slave Out (MISO) an PA6 als Input Open-Drain mit 2MHz (s.Tabelle 14 auf
+S.138 in [1]):
 
-// Bits 12 und 13, S.148 in [1]:
-GPIOA->MODER &= 0xFFFFCFFF;
-GPIOA->MODER |= 0x00002000;
+PA5, PA7: MODER = 10, OTYPER = 0, OSPEEDR = 00, PUPDR = 00, AF = 5
+PA6:      MODER = 10, OTYPER = 1, OSPEEDR = 00, PUPDR = 00, AF = 5
 
-// Bit 6, S.148 in [1]:
-GPIOA->OTYPER |= 0x00000040;
+Da alle drei Pins am selben Port hngen, fasst GPIO_CONFIGURE2 die beiden
+Gruppen zusammen und schreibt jedes der fnf Register nur einmal:
 
-// Bits 12 und 13, S.149 in [1]:
-GPIOA->OSPEEDR &= 0xFFFFCFFF;
+    MODER:   Bits 10 bis 15 = 10 10 10  (Maske 0xFFFF03FF, Wert 0x0000A800)
+    OTYPER:  Bits 5 bis 7   = 0 1 0     (Maske 0xFFFFFF1F, Wert 0x00000040)
+    OSPEEDR: Bits 10 bis 15 = 00        (Maske 0xFFFF03FF)
+    PUPDR:   Bits 10 bis 15 = 00        (Maske 0xFFFF03FF)
+    AFR[0]:  Bits 20 bis 31 = 5 5 5     (Maske 0x000FFFFF, Wert 0x55500000) */
 
-// Bits 12 und 13, S.149 in [1]:
-GPIOA->PUPDR &= 0xFFFFCFFF;
-
-// Alternate Function 5, Bits 24 bis 27, S.152 in [1]:
-GPIOA->AFR[0] &= 0xF0FFFFFF;
-GPIOA->AFR[0] |= 0x05000000;
-
-/* Der SPI1 Master Out Slave In (MOSI) an PA7 wird wieder als Output-Push-Pull
-mit 2MHz konfiguriert (s.Tabelle 14 auf S.138 in [1]): */
-
-//MODER = 10, OTYPER = 0, OSPEEDR = 00, PUPDR = 00
-
-// Bits 14 und 15, S.148 in [1]:
-GPIOA->MODER &= 0xFFFF3FFF;
-GPIOA->MODER |= 0x00008000;
-
-// Bit 7, S.148 in [1]:
-GPIOA->OTYPER &= 0xFFFFFF7F;
-
-// Bits 14 und 15, S.149 in [1]:
-GPIOA->OSPEEDR &= 0xFFFF3FFF;
-
-// Bits 14 und 15, S.149 in [1]:
-GPIOA->PUPDR &= 0xFFFF3FFF;
-
-// Alternate Function 5, Bits 28 bis 31, S.152 in [1]:
-GPIOA->AFR[0] &= 0x0FFFFFFF;
-GPIOA->AFR[0] |= 0x50000000;
+GPIO_CONFIGURE2(GPIOA,
+    GPIO_PIN(5) | GPIO_PIN(7),
+        GPIO_MODE_AF | GPIO_PP | GPIO_2MHZ | GPIO_NOPULL | GPIO_AF(5),
+    GPIO_PIN(6),
+        GPIO_MODE_AF | GPIO_OD | GPIO_2MHZ | GPIO_NOPULL | GPIO_AF(5));
 
 
 /* Nachdem nun die SPI-Pins konfiguriert sind, mssen wir PE2 noch als
@@ -348,21 +297,12 @@ dem Beschleunigungssensor aktiviert wird: */
 
 //MODER = 01, OTYPER = 0, OSPEEDR = 00, PUPDR = 00
 
-// Bits 4 und 5, S.148 in [1]:
-GPIOE->MODER &= 0xFFFFFFCF;
-GPIOE->MODER |= 0x00000010;
-
-// Bit 2, S.148 in [1]:
-GPIOE->OTYPER &= 0xFFFFFFFB;
-
-// Bits 4 und 5, S.149 in [1]:
-GPIOE->OSPEEDR &= 0xFFFFFFCF;
-
-// Bits 4 und 5, S.149 in [1]:
-GPIOE->PUPDR &= 0xFFFFFFCF;
+// Bits 4 und 5 bzw. Bit 2, S.148f in [1]:
+GPIO_CONFIGURE(GPIOE, GPIO_PIN(2),
+    GPIO_MODE_OUT | GPIO_PP | GPIO_2MHZ | GPIO_NOPULL);
 
 // Pin PE2 auf 0 setzen
-GPIOE->BSRRH |= 0x0004;
+GPIOE->BSRRH = 0x0004;
 
 
 
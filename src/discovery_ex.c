@@ -11,12 +11,72 @@
 // u.a. Definition der Hardwareregister des STM32F4
 #include "libfoo/stm32f4xx.h"
 
+// Beschleunigungssensor und Neigungsanzeige
+#include "lis302dl.h"
+#include "orientation.h"
+
+// F_CPU und Taktzhler fr die Laufzeitmessungen
+#include "rcc.h"
+#include "cycles.h"
+
+// Schalten der Pins per BSRR und atomarer Zugriff auf einzelne Bits
+#include "gpio.h"
+#include "bitband.h"
+
+// Software-Timer auf Basis von Timer 2 und ereignisgesteuerter Scheduler
+#include "swtimer.h"
+#include "sched.h"
+
+// premptiver Kernel mit Threads
+#include "kernel.h"
+
+// PWM ber Timer 4 mit DMA burst
+#include "pwm_burst.h"
+#include "led.h"
+
+// Verwaltung der DMA-Streams und memcpy per DMA
+#include "dma.h"
+#include "dma_copy.h"
+
+// Textausgabe ber USART2
+#include "uart.h"
+#include "log.h"
+#include "telemetry.h"
+#include "cmd.h"
+#include "kvstore.h"
+#include "boot.h"
+#include "power.h"
+#include "button.h"
+#include "mempool.h"
+#include "arena.h"
+#include "mpu.h"
+
 /* Hier das Beispiel auswhlen, welches laufen soll: */
 //#define LED_AND_BUTTON
 //#define LED_AND_TIMER
 //#define TIMER_IRQ
 //#define PWM_LED
 //#define DMA_LED
+//#define ACC_TILT
+//#define ACC_BATCH_BENCH
+//#define BITBAND_BENCH
+//#define SWTIMER_BENCH
+//#define KERNEL_BENCH
+//#define DMA_BURST_LED
+//#define WAVE_PLAYER
+//#define LED_ENGINE
+//#define DMA_COPY_BENCH
+//#define DMA_MODE_BENCH
+//#define UART_LOG_BENCH
+//#define TELEMETRY_ACC
+//#define UART_COMMANDS
+//#define KV_STORE
+//#define BOOT_INFO_LOG
+//#define POWER_STOP
+//#define BUTTON_GESTURES
+//#define MEMPOOL_BENCH
+//#define ACC_ARENA
+//#define MPU_BENCH
 
 //----------------------------------------------------------------------------
 //----------------------------------------------------------------------------
@@ -24,94 +84,169 @@
 
 
 
+#if defined(LED_AND_BUTTON) || defined(PWM_LED)
+
+/* Die Beispiele, die den Scheduler (s. sched.h) verwenden, ermitteln mit
+   einer Aufgabe niedrigster Prioritt einmal pro Sekunde, wie viel Zeit der
+   Prozessor schlafend verbracht hat. */
+
+static sched_task_t idleTask;
+static swtimer_t    idleTimer;
+
+// Anteil der Schlafzeit in 1/100 Prozent (zur Betrachtung im Debugger)
+volatile uint32_t idleLoad;
+
+static void idle_task(sched_task_t *t, uint32_t events)
+{
+    idleLoad = sched_idle();
+}
+
+static void idle_stats_start(void)
+{
+    idleTask.fn   = idle_task;
+    idleTask.prio = SCHED_PRIOS - 1;
+
+    idleTimer.fn     = sched_timer_post;
+    idleTimer.arg    = &idleTask;
+    idleTimer.period = SWTIMER_MS(1000);
+    swtimer_start(&idleTimer, idleTimer.period);
+}
+
+#endif
+
+#ifdef LED_AND_BUTTON
+
+/* Die eigentliche Arbeit dieses Beispiels erledigt die Aufgabe buttonTask.
+   Sie wird vom Scheduler immer dann aufgerufen, wenn sich der Zustand des
+   Tasters gendert hat. */
+
+static sched_task_t buttonTask;
+
+static void button_task(sched_task_t *t, uint32_t events)
+{
+    /* Der User-Button des discovery bords ist am Pin 0 des Port A ange-
+       schlossen. Seinen aktuellen Zustand (gedrckt = 1, ungedrckt = 0)
+       knnen wir aus dem "Input Data Register" (IDR) des Ports A ablesen
+       (Seite 150 in [1]). Im Gegensatz zur bisherigen Vorgehensweise 
+       definieren wir an dieser Stelle das Hardware-Register nicht explizit
+       als Pointer-Variable, sondern verwenden bequemerweise die korrespon-
+       dierende Definition in der Datei "stm32f4xx.h" (s. obiges #include).
+       Da das Register GPIOA->IDR uns den Status aller 16 IO-Pins des 
+       Ports A anzeigt, mssen wir den Pin, der uns interessiert (Pin 0)
+       mit einer sogenannten Bitmaske (hier: 0x00000001) isolieren: */
+    
+    if ((GPIOA->IDR & 0x00000001) == 1) {
+        
+    /* Man beachte hierbei die Klammerung des &-Terms. Diese Klammerung 
+       ist wichtig, da der Vergleichsoperator "==" strker bindet als der
+       Bitweise-Und-Operator "&". Diese strkere Bindung wrde ohne 
+       Klammerung dazu fhren, dass erst der Vergleich 0x00000001 == 1 
+       und erst dann die &-Verknpfung mit dem Register erfolgen wrde.
+       Noch viel Schlimmer: Der Code wrde in diesem Fall sogar mit 
+       fehlender Klammerung funktionieren! Der Vergleich 0x00000001 == 1
+       resultiert in den Wahrheitswert "true", der sogleich auf den Wert
+       1 abgebildet wrde. Die &-Verknpfung von 1 mit dem Register ergibt
+       genau dann eins, wenn der Taster gedrckt ist. Diese 1 wrde 
+       wiederum vom if-Konstrukt als Wahheitswert "true" interpretiert! 
+       Das ganze bricht natrlich bereits dann in sich zusammen, wenn z.B.
+       der Taster nicht an Pin 0, sondern an Pin 1 angeschlossen wre.
+        
+       Die Ansteuerung der einzelnen Pins eines GPIO-Ports kann beim STM32
+       auf zwei verschiedene Arten erfolgen. Zum einen kann der logische
+       Zustand eines IO-Ports ber das zugehrige "output data register" 
+       (ODR) gesetzt werden (Seite 150 in [1]). Die unteren 16-Bit dieses 
+       Registers (die oberen Bits sind reserviert und drfen nicht ver-
+       ndert werden) korrespondieren hierbei mit den einzelnen Pins des 
+       Ports. Mchte man also beispielsweise Pin 12 von Port D auf 1 
+       setzen, so wrde man dies mit dem Aufruf
+
+       GPIOD->ODR |= 0x00001000;
+
+       machen. Um Pin 12 auf 0 zu setzen, muss eine Bitweise-Und-Operation
+       verwendet werden. Die passende Bit-Maske hat hierbei an allen 
+       Stellen auer an Stelle 12 eine 1. Daraus folgt der Aufruf:
+       
+       GPIOD->ODR &= 0xFFFFEFFF;
+       
+       Hufig findet in diesem Zusammenhang auch die Bitweise-Negation "~"
+       Verwendung, um keine "von Hand" invertierte Bitmaske verwenden zu 
+       mssen:
+       
+       GPIOD->ODR &= ~(0x00001000);
+       
+       Im Folgenden soll jedoch die zweite Mglichkeit fr die Ansteuerung
+       der IO-Pins eines GPIO-Ports verwendet werden. Der STM32 hat hierfr
+       das sogenannte "bit set/reset register" (BSRR) (Seite 150/151 in 
+       [1]). Die unteren (low) 16-Bit und die oberen (high) 16-Bit dieses 
+       32-Bit-Registers werden blicherweise getrennt unter den Bezeich-
+       nungen BSRRL (low) und BSRRH (high) angesprochen. Hierbei reprsen-
+       tieren die Bits beider Register nicht den logischen Zustand des 
+       korrespondierenden IO-Pins, sondern sind als "Befehlsschnittstelle"
+       zu verstehen. Schreibt man in eines der Bits eine "1", so ent-
+       spricht dies dem Kommando an den Mikrocontroller, den korrespon-
+       dierenden IO-Pin auf logisch 1 im Falle des BSRRL-Registers oder 
+       auf logisch 0 im Falle des BSRRH-Registers zu setzen. In beiden 
+       Fllen wird also eine "1" verwendet. Die Wahl des Registers (BSRRL 
+       oder BSRRH) bestimmt, ob der IO-Pin auf 0 oder 1 geschaltet wird.
+       Bits, in die eine "0" geschrieben wird, bleiben ohne Wirkung. Daher
+       gengt eine einfache Zuweisung. Eine Bitweise-Oder-Operation "|="
+       wrde das Register erst lesen und dann schreiben, was unntig Zeit
+       kostet. Vor allem aber ist eine einzelne Zuweisung "atomar": Anders
+       als bei "ODR |= ..." kann sich keine Interruptroutine, die andere
+       Pins desselben Ports schaltet, zwischen Lesen und Schreiben drngen
+       und deren nderung berschreiben.
+       
+       Fr unser einfaches LED-Beispiel ergibt sich damit, dass wir im
+       Falle des gedrckten Tasters die IO-Pins 12 bis 15 des Ports D
+       auf 1 setzen wollen. Wir verwenden also das BSRRL-Register: */
+        GPIOD->BSRRL = 0xF000;
+    } else {
+    /* Ist der Taster nicht gedrckt, wollen wir die IO-Pins 12 bis 15 des
+       Ports D auf 0 setzen. Wir verwenden also das BSRRH-Register: */
+        GPIOD->BSRRH = 0xF000;
+    }
+}
+
+#endif
+
 /* In diesem einfachen Beispiel werden die 4 LEDs des discovery boards
 eingeschaltet, wenn der User-Button des boards gedrckt wird.*/
 void led_and_button_example(void)
 {
 #ifdef LED_AND_BUTTON
     
-    /* endlose Hauptschleife 
-       (die "1" wird als "wahr" bzw. "true" interpretiert) */
-    while(1) {
-        
-        /* Der User-Button des discovery bords ist am Pin 0 des Port A ange-
-           schlossen. Seinen aktuellen Zustand (gedrckt = 1, ungedrckt = 0)
-           knnen wir aus dem "Input Data Register" (IDR) des Ports A ablesen
-           (Seite 150 in [1]). Im Gegensatz zur bisherigen Vorgehensweise 
-           definieren wir an dieser Stelle das Hardware-Register nicht explizit
-           als Pointer-Variable, sondern verwenden bequemerweise die korrespon-
-           dierende Definition in der Datei "stm32f4xx.h" (s. obiges #include).
-           Da das Register GPIOA->IDR uns den Status aller 16 IO-Pins des 
-           Ports A anzeigt, mssen wir den Pin, der uns interessiert (Pin 0)
-           mit einer sogenannten Bitmaske (hier: 0x00000001) isolieren: */
-        
-        if ((GPIOA->IDR & 0x00000001) == 1) {
-            
-        /* Man beachte hierbei die Klammerung des &-Terms. Diese Klammerung 
-           ist wichtig, da der Vergleichsoperator "==" strker bindet als der
-           Bitweise-Und-Operator "&". Diese strkere Bindung wrde ohne 
-           Klammerung dazu fhren, dass erst der Vergleich 0x00000001 == 1 
-           und erst dann die &-Verknpfung mit dem Register erfolgen wrde.
-           Noch viel Schlimmer: Der Code wrde in diesem Fall sogar mit 
-           fehlender Klammerung funktionieren! Der Vergleich 0x00000001 == 1
-           resultiert in den Wahrheitswert "true", der sogleich auf den Wert
-           1 abgebildet wrde. Die &-Verknpfung von 1 mit dem Register ergibt
-           genau dann eins, wenn der Taster gedrckt ist. Diese 1 wrde 
-           wiederum vom if-Konstrukt als Wahheitswert "true" interpretiert! 
-           Das ganze bricht natrlich bereits dann in sich zusammen, wenn z.B.
-           der Taster nicht an Pin 0, sondern an Pin 1 angeschlossen wre.
-            
-           Die Ansteuerung der einzelnen Pins eines GPIO-Ports kann beim STM32
-           auf zwei verschiedene Arten erfolgen. Zum einen kann der logische
-           Zustand eines IO-Ports ber das zugehrige "output data register" 
-           (ODR) gesetzt werden (Seite 150 in [1]). Die unteren 16-Bit dieses 
-           Registers (die oberen Bits sind reserviert und drfen nicht ver-
-           ndert werden) korrespondieren hierbei mit den einzelnen Pins des 
-           Ports. Mchte man also beispielsweise Pin 12 von Port D auf 1 
-           setzen, so wrde man dies mit dem Aufruf
-
-           GPIOD->ODR |= 0x00001000;
-
-           machen. Um Pin 12 auf 0 zu setzen, muss eine Bitweise-Und-Operation
-           verwendet werden. Die passende Bit-Maske hat hierbei an allen 
-           Stellen auer an Stelle 12 eine 1. Daraus folgt der Aufruf:
-           
-           GPIOD->ODR &= 0xFFFFEFFF;
-           
-           Hufig findet in diesem Zusammenhang auch die Bitweise-Negation "~"
-           Verwendung, um keine "von Hand" invertierte Bitmaske verwenden zu 
-           mssen:
-           
-           GPIOD->ODR &= ~(0x00001000);
-           
-           Im Folgenden soll jedoch die zweite Mglichkeit fr die Ansteuerung
-           der IO-Pins eines GPIO-Ports verwendet werden. Der STM32 hat hierfr
-           das sogenannte "bit set/reset register" (BSRR) (Seite 150/151 in 
-           [1]). Die unteren (low) 16-Bit und die oberen (high) 16-Bit dieses 
-           32-Bit-Registers werden blicherweise getrennt unter den Bezeich-
-           nungen BSRRL (low) und BSRRH (high) angesprochen. Hierbei reprsen-
-           tieren die Bits beider Register nicht den logischen Zustand des 
-           korrespondierenden IO-Pins, sondern sind als "Befehlsschnittstelle"
-           zu verstehen. Schreibt man in eines der Bits eine "1", so ent-
-           spricht dies dem Kommando an den Mikrocontroller, den korrespon-
-           dierenden IO-Pin auf logisch 1 im Falle des BSRRL-Registers oder 
-           auf logisch 0 im Falle des BSRRH-Registers zu setzen. In beiden 
-           Fllen wird also eine "1", die man bequem mit einer Bitweisen-Oder-
-           Operation schreiben kann, verwendet. Die Wahl des Registers (BSRRL 
-           oder BSRRH) bestimmt, ob der IO-Pin auf 0 oder 1 geschaltet wird.
-           
-           Fr unser einfaches LED-Beispiel ergibt sich damit, dass wir im
-           Falle des gedrckten Tasters die IO-Pins 12 bis 15 des Ports D
-           auf 1 setzen wollen. Wir verwenden also das BSRRL-Register: */
-            GPIOD->BSRRL |= 0xF000;
-        } else {
-        /* Ist der Taster nicht gedrckt, wollen wir die IO-Pins 12 bis 15 des
-           Ports D auf 0 setzen. Wir verwenden also das BSRRH-Register: */
-            GPIOD->BSRRH |= 0xF000;
-            
-        }
-        
-    } // end while (1)
+    /* Die naheliegende Lsung wre eine endlose Hauptschleife, die stndig
+       den Taster abfragt:
+       
+       while (1) {
+           if ((GPIOA->IDR & 0x00000001) == 1) ...
+       }
+       
+       Der Prozessor wrde dann mit vollen 168MHz nichts anderes tun, als
+       immer wieder dasselbe Bit zu lesen. Stattdessen lassen wir uns von
+       der Hardware melden, wenn sich am Taster etwas ndert: button.c
+       richtet dafr die Leitung EXTI0 ein und meldet der Aufgabe buttonTask
+       jeden Wechsel - entprellt, da auf dem board der Kondensator C38
+       fehlt (s. button.h).
+       
+       Der Scheduler bernimmt die Hauptschleife. Die Aufgabe fr den Taster
+       wird einmal von Hand gemeldet, damit die LEDs gleich zu Beginn den
+       Zustand des Tasters anzeigen. Fr die Messung der Schlafzeit meldet
+       ein periodischer Software-Timer jede Sekunde die Aufgabe idleTask. */
+    
+    sched_init();
+    
+    buttonTask.fn   = button_task;
+    buttonTask.prio = 0;
+    button_init(&buttonTask, BUTTON_DEBOUNCE_US);
+    idle_stats_start();
+    
+    sched_post(&buttonTask, 1);
+    
+    /* sched_run() kehrt nicht zurck. Solange niemand den Taster drckt,
+       schlft der Prozessor - idleLoad zeigt dann knapp 100%. */
+    
+    sched_run();
     
 #endif
 }
@@ -228,8 +363,8 @@ void led_and_timer_example(void)
        kurz unsere 4 LEDs in eine hbsche Startkonfiguration bringen, in der
        zwei gegenberliegende LEDs an und die anderen aus sind: */
     
-    GPIOD->BSRRL |= 0xA000; // Pin 13 und 15 ein
-    GPIOD->BSRRH |= 0x5000; // Pin 12 und 14 aus
+    GPIOD->BSRRL = 0xA000; // Pin 13 und 15 ein
+    GPIOD->BSRRH = 0x5000; // Pin 12 und 14 aus
     
     /* In der folgenden Hauptschleife verwenden wir das sogenannte 
        berlaufereignis des Zhlers, um unsere Hauptschleife im 1 Sekunden-
@@ -244,16 +379,19 @@ void led_and_timer_example(void)
     while (1) {
         // Warten auf berlaufereignis
         while ((TIM3->SR & 0x0001) == 0);
-        // Resetten von Bit 0
-        TIM3->SR &= 0xFFFE;
+        // Resetten von Bit 0 (die brigen Bits sind "rc_w0", d.h. das
+        // Schreiben einer 1 verndert sie nicht; ein "&=" ist unntig)
+        TIM3->SR = 0xFFFE;
         // von hier an bis zum Ende der While-Schleife haben wir 1 Sekunde Zeit
         
         // Als erstes wollen wir die LEDs "toggeln", d.h. die LEDs, die an 
         // sind, sollen ausgehen, und die LEDs, die aus sind, sollen angehen.
-        // Dies lsst sich elegant ber eine XOR-Operation auf dem ODR-Register 
-        // der GPIO-Pins erledigen:
+        // Dies liee sich ber eine XOR-Operation auf dem ODR-Register der
+        // GPIO-Pins erledigen ("GPIOD->ODR ^= 0x0000F000;"). Das Makro
+        // GPIO_TOGGLE aus gpio.h liest das ODR stattdessen nur und schaltet
+        // die Pins dann mit einem einzigen Schreibzugriff auf das BSRR:
         
-        GPIOD->ODR ^= 0x0000F000;
+        GPIO_TOGGLE(GPIOD, 0xF000);
         
         // nun wollen wir eine halbe Sekunde warten und dann die LEDs erneut 
         // toggeln. ber das Register CNT (S.406 in [1]) knnen wir auf den
@@ -265,7 +403,7 @@ void led_and_timer_example(void)
         
         // und nun das erneute Toggeln... 
         
-        GPIOD->ODR ^= 0x0000F000;
+        GPIO_TOGGLE(GPIOD, 0xF000);
         
         // Am Ende unserer Schleife mssen wir nicht etwa auf einen Zhlerwert 
         // von 10000 warten, da wir ja am Anfang der Schleife bereits auf das
@@ -372,8 +510,8 @@ void timer_irq_example(void)
        kurz die LEDs initialisiert. Zwei LEDs werden eingeschaltet und zwei
        LEDs werden ausgeschaltet: */
     
-    GPIOD->BSRRL |= 0xA000; // Pin 13 und 15 ein
-    GPIOD->BSRRH |= 0x5000; // Pin 12 und 14 aus
+    GPIOD->BSRRL = 0xA000; // Pin 13 und 15 ein
+    GPIOD->BSRRH = 0x5000; // Pin 12 und 14 aus
     
     while (1) {
     
@@ -415,18 +553,18 @@ void TIM3_IRQHandler(void)
        diese vom NVIC aufgerufen werden. Schnieke!
        
        In unserem Fall wollen wir die LEDs toggeln. Zu diesem Zweck verwenden
-       wir diesmal das ODR-Register und XORen die Bits der LEDs einfach mit 1.
-       Dadurch toggeln die Ausgnge bei jedem Interruptaufruf elegant hin und 
-       her: */
+       wir wie zuvor das Makro GPIO_TOGGLE. Dadurch toggeln die Ausgnge bei
+       jedem Interruptaufruf elegant hin und her: */
     
-    GPIOD->ODR ^= 0x0000F000;
+    GPIO_TOGGLE(GPIOD, 0xF000);
     
     /* Um dem NVIC zu signalisieren, dass der Interrupt behandelt wurde, muss
        nun hndisch das passende Bit im Status-Register SR auf 0 zurckgesetzt
        werden. Geschieht dies nicht, so wrde der NVIC die Interruptroutine
-       sofort erneut aufrufen: */
+       sofort erneut aufrufen. Da die Bits im SR durch Schreiben einer 1 nicht
+       verndert werden, gengt eine einfache Zuweisung: */
     
-    TIM3->SR &= 0xFFFE;
+    TIM3->SR = 0xFFFE;
     
     /* Eigentlich wre unsere Arbeit damit getan. Aber leider gibt es bei 
        diesem Minimalbeispiel ein kleines Problem. Da unser Programm effektiv
@@ -460,6 +598,14 @@ void TIM3_IRQHandler(void)
 //----------------------------------------------------------------------------
 //----------------------------------------------------------------------------
 
+#ifdef PWM_LED
+
+// Die Aufgabe, die die Helligkeit der LEDs weiterschaltet (s.u.)
+static sched_task_t pwmTask;
+static void pwm_task(sched_task_t *t, uint32_t events);
+
+#endif
+
 /* In diesem Beispiel soll die Verwendung eines Timers zur PWM-Generierung
 erlutert werden. */
 void pwm_led_example(void)
@@ -617,12 +763,18 @@ void pwm_led_example(void)
     /* Warum wir als Maximalwert 10000 Sechzehntel verwenden, wird weiter unten
        deutlich werden... */
 
-    while (1) {
-        
-    /* Die Hauptschleife bleibt mal wieder leer, da wir auch hier Timer 3 mit 
-       Interrupt verwenden ...*/
-        
-    }
+    /* Die Hauptschleife bliebe mal wieder leer, da wir auch hier Timer 3 mit 
+       Interrupt verwenden. Eine leere Schleife hlt den Prozessor aber mit
+       voller Geschwindigkeit beschftigt. Wir berlassen die Hauptschleife
+       daher dem Scheduler, der den Prozessor zwischen den 16 Interrupts pro
+       Sekunde schlafen legt (s. idleLoad): */
+    
+    sched_init();
+    pwmTask.fn   = pwm_task;
+    pwmTask.prio = 0;
+    idle_stats_start();
+    
+    sched_run();
     
 #endif
 }
@@ -648,9 +800,10 @@ static const uint16_t compareValues[16] = {
 volatile uint8_t idx1 = 0;
 volatile uint8_t idx2 = 8;
 
-void TIM3_IRQHandler(void) 
+static void pwm_task(sched_task_t *t, uint32_t events)
 {   
-    /* In der Interruptroutine werden die CCR-Register mit einem neuen 
+    /* In der Aufgabe pwm_task, die die Interruptroutine (s.u.) bei jedem
+       berlauf von Timer 3 meldet, werden die CCR-Register mit einem neuen 
        Wert aus unserem compareValues-Array gem der Indizes idx1 und idx2
        versorgt. */
     
@@ -675,11 +828,16 @@ void TIM3_IRQHandler(void)
        von 10000/16 gewhlt haben. Da das Array 16 Werte enthlt, laufen wir
        mit diesem Maximalwert genau 1 mal pro Sekunde durch das Array. Die LEDs
        blinken also weiterhin im 1 Sekunden-Takt. */
+}
 
-
-    /* Wie zuvor mssen wir auch hier das Flag im Status-Register des Timers
-       am Ende der Interruptroutine auf 0 zurcksetzen. */
-    TIM3->SR &= 0xFFFE;
+void TIM3_IRQHandler(void) 
+{   
+    /* Die Interruptroutine selbst meldet nur noch die Aufgabe pwm_task beim
+       Scheduler. Wie zuvor mssen wir auch hier das Flag im Status-Register
+       des Timers auf 0 zurcksetzen. */
+    
+    sched_post(&pwmTask, 1);
+    TIM3->SR = 0xFFFE;
     
     /* Und auch hier ist wieder unser "Bugfix" am Start... */
     temp = TIM3->SR; 
@@ -833,16 +991,15 @@ void dma_pwm_led_example(void)
     DMA1_Stream7->CR &= 0xFFFFFFFE;
     while ((DMA1_Stream7->CR & 0x00000001) == 1);
     
-    /* Als nchstes lschen wir die Status-Eintrge der 4 Streams in den 
-       Status-Registern LISR und HISR (S.181/182): */
+    /* Als nchstes lschen wir die Status-Eintrge der 4 Streams. Die Status-
+       Register LISR und HISR (S.181/182) sind "read only", das Lschen erfolgt
+       daher ber die "flag clear register" LIFCR und HIFCR. Eine 1 lscht das
+       zugehrige Flag, eine 0 bleibt ohne Wirkung: */
     
-    DMA1->LISR &= 0xFF82FFFF;
-    DMA1->HISR &= 0xF0FFF082;
+    DMA1->LIFCR = 0x007D0000;
+    DMA1->HIFCR = 0x0F000F7D;
     
-    /* Interessanterweise sind diese Register in [1] als "read only" beschrieben,
-       obwohl die Anleitung auf S.179 etwas anderes verlauten lsst.
-       
-       Die Konfiguration des DMA-controllers geht nun mit dem Einstellen der 
+    /* Die Konfiguration des DMA-controllers geht nun mit dem Einstellen der 
        Peripherie-Adresse weiter. Je nach Modus des DMA kann diese Adresse als
        Quell- oder als Zieladresse vom DMA-controller interpretiert werden. In
        unserem Fall wollen Daten an die Peripherie schicken. Es handelt sich
@@ -1007,3 +1164,1903 @@ void dma_pwm_led_example(void)
 
 
 
+
+
+
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+
+/* In diesem Beispiel wird der Beschleunigungssensor des discovery boards
+   ausgelesen und die Neigung des boards ber die 4 LEDs angezeigt. */
+void acc_tilt_example(void)
+{
+#ifdef ACC_TILT
+    /* Der LIS302DL misst die Beschleunigung entlang dreier Achsen. Liegt das
+       board ruhig, so misst der Sensor nur die Erdbeschleunigung. Aus der
+       Richtung dieses Vektors lsst sich die Neigung des boards bestimmen.
+       Die Umrechnung in Winkel bernimmt orientation.c mithilfe des CORDIC-
+       Verfahrens, die Ansteuerung des Sensors ber SPI1 findet sich in
+       lis302dl.c. Meldet sich der Sensor nicht, so bleiben wir hier stehen: */
+
+    if (!lis302dl_init())
+        while (1);
+
+    /* Timer 4 wird als PWM-Generator fr die LEDs eingerichtet: */
+    orientation_init();
+
+    /* Der Sensor liefert 100 Messungen pro Sekunde. Mit Timer 3 lesen wir
+       ihn im gleichen Takt aus (10000 Ticks pro Sekunde / 100): */
+
+    /* Da wir im Interrupt von Timer 3 auf das Ende einer SPI-bertragung
+       warten, muss der DMA-Interrupt des SPI-Busses den Timer-Interrupt
+       unterbrechen drfen. Wir geben Timer 3 daher ber das IP-Register
+       des NVIC eine niedrigere Prioritt (1 statt 0). Der STM32F4 wertet
+       nur die oberen 4 Bit dieses Registers aus: */
+
+    NVIC->IP[29]   = 0x10;        // Prioritt von Timer 3 herabsetzen
+    NVIC->ISER[0] |= 0x20000000;  // Interrupt von Timer 3 beim NVIC aktivieren
+
+    RCC->APB1ENR |= 0x00000002;   // Timer 3 mit Takt versorgen
+    TIM3->CR1    &= 0xFC00;       // Einfacher Upcounter
+    TIM3->PSC     = 8400;         // Prescaler von 8400 -> 10000 Ticks /Sekunde
+    TIM3->ARR     = 10000 / 100;  // 100 berlufe pro Sekunde
+    TIM3->DIER    = 0x0001;       // "berlauf"-Interrupt aktivieren
+    TIM3->EGR    |= 1;            // "manuelles Update"
+    TIM3->CR1    |= 1;            // Timer 3 anschalten
+
+    while (1) {
+
+    /* Die Hauptschleife bleibt leer. Das Verhltnis der Variablen
+       orientation_updates und orientation_samples zeigt im Debugger, wie
+       selten die Winkel tatschlich neu berechnet werden mssen. */
+
+    }
+
+#endif
+}
+
+#ifdef ACC_TILT
+
+void TIM3_IRQHandler(void)
+{
+    int8_t xyz[3];
+
+    lis302dl_read_xyz(xyz);
+    orientation_update(xyz);
+
+    TIM3->SR = 0xFFFE;
+    temp = TIM3->SR;
+}
+
+#endif
+
+
+
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+
+#ifdef ACC_BATCH_BENCH
+
+volatile uint32_t batchIrqs[LIS302DL_MAX_WATERMARK];
+volatile uint32_t batchWakeups[LIS302DL_MAX_WATERMARK];
+volatile uint32_t batchLoad[LIS302DL_MAX_WATERMARK];
+
+static uint32_t benchWatermark;
+
+/* Der Verbraucher holt immer genau benchWatermark Messungen ab und fttert
+   damit die Neigungsanzeige. Damit bleibt auch die adaptive watermark auf
+   dem eingestellten Wert stehen. */
+static void batch_consumer(uint32_t available)
+{
+    int8_t buf[LIS302DL_MAX_WATERMARK][3];
+    uint32_t i, n;
+
+    n = lis302dl_batch_fetch(buf, benchWatermark);
+    for (i = 0; i < n; ++i)
+        orientation_update(buf[i]);
+}
+
+#endif
+
+/* Dieses Beispiel misst, wie viele Interrupts und Aufwachvorgnge die
+   gepufferte Erfassung des Beschleunigungssensors bei verschiedenen
+   watermarks verursacht und wie viel Rechenzeit dabei anfllt. */
+void acc_batch_benchmark(void)
+{
+#ifdef ACC_BATCH_BENCH
+    /* Die Ergebnisse landen in den Arrays batchIrqs, batchWakeups und
+       batchLoad (s.u.) und knnen nach Ablauf des Beispiels im Debugger
+       betrachtet werden. Index i entspricht einer watermark von i + 1.
+       Die Last wird in Hundertstel Prozent angegeben. Jede watermark wird
+       eine halbe Sekunde lang gemessen: */
+
+    uint32_t wm, t0;
+
+    if (!lis302dl_init())
+        while (1);
+
+    orientation_init();
+    cycles_init();
+
+    for (wm = 1; wm <= LIS302DL_MAX_WATERMARK; ++wm) {
+        benchWatermark = wm;
+        lis302dl_batch_start(wm, batch_consumer);
+
+        t0 = cycles_now();
+        while (cycles_now() - t0 < F_CPU / 2);
+
+        lis302dl_batch_stop();
+
+        batchIrqs[wm - 1]    = lis302dl_stats.irqs * 2;
+        batchWakeups[wm - 1] = lis302dl_stats.wakeups * 2;
+        batchLoad[wm - 1]    = (uint32_t)(((uint64_t)lis302dl_stats.cycles
+                                           * 20000) / F_CPU);
+    }
+
+    /* Erwartungsgem bleibt die Zahl der Interrupts bei 2 pro Messung
+       (EXTI1 und DMA), da der Sensor keinen eigenen FIFO hat. Die Zahl der
+       Aufwachvorgnge des Verbrauchers sinkt dagegen mit 400 / watermark,
+       und mit ihr der Anteil der Rechenzeit, der auf den Aufruf des
+       Verbrauchers entfllt. */
+
+    while (1);
+
+#endif
+}
+
+
+
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+
+#ifdef BITBAND_BENCH
+
+// Anzahl der Durchlufe pro Messung (jeweils 8 Zugriffe)
+#define BITBAND_RUNS 256
+
+/* Ergebnis: Takte pro Zugriff in 1/100 Takt, bereits bereinigt um die
+   Kosten der leeren Schleife. Die Reihenfolge entspricht der Aufzhlung
+   in bitband_benchmark(). */
+volatile uint32_t bitbandCycles[8];
+
+// ein Flag-Wort im SRAM, das auch von Interruptroutinen benutzt werden knnte
+static volatile uint32_t bitbandFlags;
+
+#define BITBAND_REPEAT8(x) x; x; x; x; x; x; x; x
+
+#define BITBAND_MEASURE(idx, op) \
+    do { \
+        uint32_t i_, t_ = cycles_now(); \
+        for (i_ = 0; i_ < BITBAND_RUNS; ++i_) { \
+            BITBAND_REPEAT8(op); \
+        } \
+        t_ = cycles_now() - t_; \
+        bitbandCycles[idx] = (t_ > empty) \
+            ? ((t_ - empty) * 100) / (BITBAND_RUNS * 8) : 0; \
+    } while (0)
+
+#endif
+
+/* Dieses Beispiel vergleicht die Laufzeit verschiedener Arten, ein
+   einzelnes Bit in einem Hardwareregister oder im SRAM zu verndern. */
+void bitband_benchmark(void)
+{
+#ifdef BITBAND_BENCH
+    /* Gemessen wird mit dem Taktzhler der DWT (s. cycles.h):
+
+       0: GPIOD->ODR |= 0x1000          (Lesen-ndern-Schreiben)
+       1: GPIOD->BSRRL |= 0x1000        (liest unntig das BSRR)
+       2: GPIOD->BSRRL = 0x1000         (ein Schreibzugriff)
+       3: BITBAND_SET(&GPIOD->ODR, 12)  (bit-band, Peripherie)
+       4: bitbandFlags |= 0x04          (Lesen-ndern-Schreiben im SRAM)
+       5: BITBAND_SET(&bitbandFlags, 2) (bit-band, SRAM)
+       6: TIM3->SR &= 0xFFFE            (Flag lschen per "&=")
+       7: TIM3->SR = 0xFFFE             (Flag lschen per Zuweisung)
+
+       Die Ergebnisse landen in bitbandCycles und knnen im Debugger
+       betrachtet werden. Bei den Zugriffen auf die Peripherie kommen zu
+       den Takten des Prozessors die Wartezyklen der Busbrcken hinzu. */
+
+    uint32_t i, t, empty;
+
+    // Timer 3 mit Takt versorgen, damit sein SR beschrieben werden kann
+    RCC->APB1ENR |= 0x00000002;
+
+    cycles_init();
+
+    // die Kosten der leeren Schleife werden von allen Messungen abgezogen
+    t = cycles_now();
+    for (i = 0; i < BITBAND_RUNS; ++i)
+        __asm__ volatile ("" ::: "memory");
+    empty = cycles_now() - t;
+
+    BITBAND_MEASURE(0, GPIOD->ODR |= 0x1000);
+    BITBAND_MEASURE(1, GPIOD->BSRRL |= 0x1000);
+    BITBAND_MEASURE(2, GPIOD->BSRRL = 0x1000);
+    BITBAND_MEASURE(3, BITBAND_SET(&GPIOD->ODR, 12));
+    BITBAND_MEASURE(4, bitbandFlags |= 0x04);
+    BITBAND_MEASURE(5, BITBAND_SET(&bitbandFlags, 2));
+    BITBAND_MEASURE(6, TIM3->SR &= 0xFFFE);
+    BITBAND_MEASURE(7, TIM3->SR = 0xFFFE);
+
+    /* Zur Kontrolle leuchtet nun die grne LED an PD12. */
+
+    while (1);
+
+#endif
+}
+
+
+
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+
+#ifdef SWTIMER_BENCH
+
+// Anzahl der Timer fr die Messung (je 28 Byte)
+#define SWTIMER_BENCH_COUNT 2048
+
+/* Ergebnis: durchschnittliche Takte fr das Starten, das Abbrechen und das
+   Ablaufen (inkl. Umsortieren und Interrupt) eines Timers. */
+volatile uint32_t swtimerCycles[3];
+
+static swtimer_t benchTimers[SWTIMER_BENCH_COUNT];
+static swtimer_t ledTimers[4];
+
+static void bench_expired(swtimer_t *t)
+{
+    /* Nichts zu tun - gemessen wird nur die Verwaltung. */
+}
+
+static void led_expired(swtimer_t *t)
+{
+    GPIO_TOGGLE(GPIOD, (uint32_t)t->arg);
+}
+
+#endif
+
+/* Dieses Beispiel misst die Kosten der Software-Timer aus swtimer.c und
+   lsst im Anschluss die 4 LEDs mit verschiedenen Perioden blinken, die
+   sich alle einen einzigen Hardware-Timer (Timer 2) teilen. */
+void swtimer_benchmark(void)
+{
+#ifdef SWTIMER_BENCH
+    /* Die Verzgerungen werden mit einem einfachen Pseudo-Zufallszahlen-
+       generator (linear kongruent) zwischen 1ms und etwa 1s gewhlt, damit
+       die Timer ber alle Ebenen des timing wheels verteilt werden. Die
+       Ergebnisse landen in swtimerCycles. */
+
+    uint32_t i, t0, fired, cycles;
+    uint32_t rnd = 12345;
+
+    swtimer_init();
+    cycles_init();
+
+    // Starten
+    t0 = cycles_now();
+    for (i = 0; i < SWTIMER_BENCH_COUNT; ++i) {
+        rnd = rnd * 1664525 + 1013904223;
+        benchTimers[i].fn = bench_expired;
+        swtimer_start(&benchTimers[i], SWTIMER_MS(1) + (rnd >> 12));
+    }
+    swtimerCycles[0] = (cycles_now() - t0) / SWTIMER_BENCH_COUNT;
+
+    // jeden zweiten Timer abbrechen...
+    t0 = cycles_now();
+    for (i = 0; i < SWTIMER_BENCH_COUNT; i += 2)
+        swtimer_cancel(&benchTimers[i]);
+    swtimerCycles[1] = (cycles_now() - t0) / (SWTIMER_BENCH_COUNT / 2);
+
+    // ...und wieder starten
+    for (i = 0; i < SWTIMER_BENCH_COUNT; i += 2) {
+        rnd = rnd * 1664525 + 1013904223;
+        swtimer_start(&benchTimers[i], SWTIMER_MS(1) + (rnd >> 12));
+    }
+
+    // Ablaufen: Die Zeit in der Interruptroutine wird dort gezhlt
+    fired  = swtimer_stats.fired;
+    cycles = swtimer_stats.cycles;
+    while (swtimer_stats.active > 0);
+    swtimerCycles[2] = (swtimer_stats.cycles - cycles)
+                     / (swtimer_stats.fired - fired);
+
+    /* Zum Abschluss 4 periodische Timer fr die LEDs. Die Hauptschleife
+       bleibt dabei leer, und Timer 3 bleibt fr andere Aufgaben frei. */
+    for (i = 0; i < 4; ++i) {
+        ledTimers[i].fn     = led_expired;
+        ledTimers[i].arg    = (void*)(0x1000UL << i);
+        ledTimers[i].period = SWTIMER_MS(125) << i;
+        swtimer_start(&ledTimers[i], ledTimers[i].period);
+    }
+
+    while (1);
+
+#endif
+}
+
+
+
+
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+
+
+
+#ifdef KERNEL_BENCH
+
+// Anzahl der Wechsel je Messung
+#define KERNEL_BENCH_COUNT 1000
+
+/* Ergebnis: durchschnittliche und grte Anzahl Takte von der Freigabe der
+   Semaphore bis zum Weiterlaufen des wartenden Threads fr
+   [0] Thread -> Thread,
+   [1] Thread -> Thread, beide mit FPU-Nutzung,
+   [2] Interruptroutine -> Thread. */
+volatile uint32_t kernelCycles[3];
+volatile uint32_t kernelCyclesMax[3];
+
+static k_thread_t benchHigh, benchLow;
+static k_sem_t    benchSem;
+
+static volatile uint32_t benchT0;
+static volatile uint32_t benchMode;
+static volatile float    benchF = 1.0f;
+static uint32_t          benchSum[3];
+
+static void bench_high(void *arg)
+{
+    uint32_t dt;
+
+    while (1) {
+        k_sem_wait(&benchSem);
+        dt = cycles_now() - benchT0;
+
+        if (benchMode == 1)
+            benchF = benchF * 1.0001f;
+
+        benchSum[benchMode] += dt;
+        if (dt > kernelCyclesMax[benchMode])
+            kernelCyclesMax[benchMode] = dt;
+    }
+}
+
+static void bench_low(void *arg)
+{
+    uint32_t i;
+
+    for (benchMode = 0; benchMode < 3; ++benchMode) {
+        for (i = 0; i < KERNEL_BENCH_COUNT; ++i) {
+            /* Eine Gleitkommarechnung setzt das FPCA-Bit in CONTROL. Beim
+               nchsten Interrupt reserviert der Prozessor dann Platz fr
+               die FPU-Register, und PendSV_Handler sichert s16-s31. */
+            if (benchMode == 1)
+                benchF = benchF * 0.9999f;
+
+            benchT0 = cycles_now();
+            if (benchMode == 2) {
+                EXTI->SWIER = 0x00000004;
+                __DSB();
+            } else {
+                k_sem_post(&benchSem);
+            }
+        }
+        kernelCycles[benchMode] = benchSum[benchMode] / KERNEL_BENCH_COUNT;
+    }
+
+    // fertig: grne LED an, der Thread endet
+    GPIOD->BSRRL = 0x1000;
+}
+
+/* Die Leitung EXTI2 ist mit keinem Pin verbunden (EXTICR bleibt 0, PA2 ist
+   frei) und wird nur per Software ber SWIER ausgelst. */
+void EXTI2_IRQHandler(void)
+{
+    EXTI->PR = 0x00000004;
+    k_sem_post(&benchSem);
+}
+
+#endif
+
+/* Dieses Beispiel startet den premptiven Kernel aus kernel.c mit zwei
+   Threads und misst, wie lange ein Threadwechsel dauert. */
+void kernel_benchmark(void)
+{
+#ifdef KERNEL_BENCH
+    /* Der Thread hoher Prioritt wartet an einer Semaphore, die der Thread
+       niedriger Prioritt (bzw. eine Interruptroutine) freigibt. Gemessen
+       wird mit dem Taktzhler der DWT vom Aufruf von k_sem_post() bzw. vom
+       Auslsen des Interrupts bis zum Weiterlaufen des wartenden Threads.
+       Darin enthalten sind jeweils der Eintritt in PendSV, der eigentliche
+       Wechsel und der Rcksprung. Die Ergebnisse landen in kernelCycles und
+       kernelCyclesMax. */
+
+    cycles_init();
+    k_init();
+    k_sem_init(&benchSem, 0);
+
+    // EXTI2 (Interrupt Nummer 8) ohne Flanke, nur per SWIER
+    EXTI->IMR     |= 0x00000004;
+    NVIC->ISER[0]  = 0x00000100;
+
+    k_thread_create(&benchHigh, bench_high, 0, 1, 512);
+    k_thread_create(&benchLow,  bench_low,  0, 2, 512);
+
+    k_start();
+
+#endif
+}
+
+
+
+
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+
+
+
+#ifdef DMA_BURST_LED
+
+// frames einer Blinkperiode: 1 Sekunde bei 400Hz PWM-Frequenz
+#define BURST_FRAMES 400
+
+// Durchlufe der Messschleife
+#define BURST_BENCH_LOOPS 100000
+
+/* Ergebnis: Takte fr die Messschleife
+   [0] ohne DMA,
+   [1] mit 4 Streams, ausgelst von Timer 3 (wie dma_pwm_led_example()),
+   [2] mit einem Stream im burst (pwm_burst.c),
+   jeweils bei 100000 Aktualisierungen aller 4 Compare-Werte pro Sekunde. */
+volatile uint32_t burstCycles[3];
+
+static uint16_t burstFrames[BURST_FRAMES][PWM_BURST_CHANNELS];
+
+/* 16 Werte pro Kanal: fr die 4 Streams als 4 Spalten hintereinander, fr
+   den burst als 16 frames zu je 4 Werten. Der Inhalt spielt keine Rolle. */
+static uint16_t burstBench[16 * PWM_BURST_CHANNELS];
+
+/* Die Messschleife liest Timer 4 ber den APB1 - denselben Bus, ber den
+   der DMA-Controller in die Compare-Register schreibt. Jeder DMA-Transfer,
+   der gerade den Bus belegt, verzgert die Schleife. */
+static uint32_t burst_bench_loop(void)
+{
+    volatile uint32_t sink;
+    uint32_t i, t0;
+
+    t0 = cycles_now();
+    for (i = 0; i < BURST_BENCH_LOOPS; ++i)
+        sink = TIM4->CNT;
+    (void)sink;
+
+    return cycles_now() - t0;
+}
+
+#endif
+
+/* Dieses Beispiel lsst die LEDs wie dma_pwm_led_example() paarweise
+   auf- und abblenden, bentigt dafr aber nur einen einzigen DMA-Stream
+   und keinen zweiten Timer. Zuvor wird die Buslast beider Varianten
+   verglichen. */
+void dma_burst_led_example(void)
+{
+#ifdef DMA_BURST_LED
+    /* Zum Vergleich laufen beide Varianten mit 100kHz: Timer 4 mit einem
+       Prescaler von 0 und ARR = 839 (84MHz / 840), fr die alte Variante
+       zustzlich Timer 3 mit denselben Einstellungen als Auslser der 4
+       Streams. Die Zahl der bertragenen Daten ist in beiden Fllen gleich
+       (4 Halbworte pro Update). Der burst spart aber 3 Streams, den Timer 3
+       und die Arbitrierung zwischen 4 Streams - die Streams 2, 4, 5 und 7
+       (Kanal 5) stehen damit wieder fr andere Peripherie zur Verfgung. */
+
+    static const uint8_t reqs[4] = {
+        DMA_REQ_TIM3_CH1, DMA_REQ_TIM3_CH2, DMA_REQ_TIM3_CH3, DMA_REQ_TIM3_CH4
+    };
+    static dma_stream_t streams[4];
+    static const uint16_t compareValues[16] = {
+          5,  15,  30,  60, 150, 500, 750, 995,
+        995, 750, 500, 150,  60,  30,  15,   5
+    };
+    uint32_t i, k, a, b, f;
+
+    cycles_init();
+
+    for (i = 0; i < 16 * PWM_BURST_CHANNELS; ++i)
+        burstBench[i] = (uint16_t)(i * 13);
+
+    // [0] ohne DMA
+    pwm_burst_init(0, 839, PWM_BURST_CHANNELS);
+    burstCycles[0] = burst_bench_loop();
+
+    /* [1] 4 Streams, ausgelst von den 4 Compare-Kanlen des Timer 3. Die
+       Streams (DMA1 Stream 4, 5, 7 und 2, Kanal 5) liefert dma.c, das auch
+       die Flags lscht. */
+    if (!dma_claim_set(reqs, streams, 4))
+        while (1);
+    for (k = 0; k < 4; ++k) {
+        streams[k].stream->PAR  = (uint32_t)(&TIM4->CCR1 + 2 * k);
+        streams[k].stream->M0AR = (uint32_t)(burstBench + 16 * k);
+        streams[k].stream->NDTR = 16;
+        streams[k].stream->CR   = streams[k].chsel | 0x00002D40;
+        streams[k].stream->CR  |= 0x00000001;
+    }
+
+    RCC->APB1ENR |= 0x00000002;
+    TIM3->CR1   = 0x0000;
+    TIM3->PSC   = 0;
+    TIM3->ARR   = 839;
+    TIM3->CCMR1 = 0x0000;
+    TIM3->CCMR2 = 0x0000;
+    TIM3->CCER  = 0x0000;
+    TIM3->CCR1  = 420;
+    TIM3->CCR2  = 420;
+    TIM3->CCR3  = 420;
+    TIM3->CCR4  = 420;
+    TIM3->DIER  = 0x1E00;
+    TIM3->EGR   = 0x0001;
+    TIM3->CR1   = 0x0001;
+
+    burstCycles[1] = burst_bench_loop();
+
+    TIM3->CR1  = 0x0000;
+    TIM3->DIER = 0x0000;
+    for (k = 0; k < 4; ++k)
+        dma_release(&streams[k]);
+
+    // [2] ein Stream im burst, ausgelst vom Update des Timer 4
+    pwm_burst_play(burstBench, 16);
+    burstCycles[2] = burst_bench_loop();
+    pwm_burst_stop();
+
+    /* Nun das eigentliche Blinken: Bei 400Hz PWM-Frequenz (84MHz / 210 /
+       1000) wird jeder frame fr 2.5ms bernommen. Die 16 Stufen aus
+       compareValues werden dazu auf je 25 frames linear interpoliert - die
+       LEDs blenden dadurch deutlich weicher als mit 16 Stufen pro Sekunde.
+       Wie in dma_pwm_led_example() laufen CCR2 und CCR4 um eine halbe
+       Periode versetzt. */
+
+    for (f = 0; f < BURST_FRAMES; ++f) {
+        for (k = 0; k < PWM_BURST_CHANNELS; ++k) {
+            i = (f / 25 + (k & 1) * 8) % 16;
+            a = compareValues[i];
+            b = compareValues[(i + 1) % 16];
+            burstFrames[f][k] = (uint16_t)((a * (25 - f % 25) + b * (f % 25)) / 25);
+        }
+    }
+
+    pwm_burst_init(209, 999, PWM_BURST_CHANNELS);
+    pwm_burst_play(&burstFrames[0][0], BURST_FRAMES);
+
+    /* Die Hauptschleife bleibt leer - kein Interrupt, kein Timer 3. */
+    while (1);
+
+#endif
+}
+
+
+
+
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+
+
+
+#ifdef WAVE_PLAYER
+
+// Lnge der beiden Wellenformen in frames
+#define WAVE_FADE_FRAMES   400
+#define WAVE_CHASE_FRAMES  200
+
+static uint16_t waveFade[WAVE_FADE_FRAMES][PWM_BURST_CHANNELS];
+static uint16_t waveChase[WAVE_CHASE_FRAMES][PWM_BURST_CHANNELS];
+
+/* Das "Programm": welche Tabelle mit welchem Prescaler. Bei ARR = 999 und
+   einem Prescaler von 209 laufen 400 frames pro Sekunde, bei 104 doppelt so
+   viele. */
+static const struct {
+    const uint16_t *frames;
+    uint16_t        count;
+    uint16_t        psc;
+} waveProgram[4] = {
+    { &waveFade[0][0],  WAVE_FADE_FRAMES,  209 },
+    { &waveFade[0][0],  WAVE_FADE_FRAMES,  104 },
+    { &waveChase[0][0], WAVE_CHASE_FRAMES, 209 },
+    { &waveChase[0][0], WAVE_CHASE_FRAMES, 104 }
+};
+
+static swtimer_t waveTimer;
+static uint32_t  waveStep;
+
+/* Luft alle 3 Sekunden im Interrupt von Timer 2. Die neue Tabelle wird nur
+   eingereiht und am Ende des laufenden Durchlaufs bernommen, der neue
+   Prescaler gilt ab dem nchsten Update. */
+static void wave_next(swtimer_t *t)
+{
+    waveStep = (waveStep + 1) % 4;
+    pwm_burst_rate(waveProgram[waveStep].psc, 999);
+    pwm_burst_queue(waveProgram[waveStep].frames, waveProgram[waveStep].count);
+}
+
+#endif
+
+/* Dieses Beispiel spielt ber pwm_burst.c zwei Wellenformen verschiedener
+   Lnge mit wechselnder Geschwindigkeit auf den 4 LEDs ab. */
+void wave_player_example(void)
+{
+#ifdef WAVE_PLAYER
+    /* Anders als bei compareValues in den vorherigen Beispielen sind Lnge
+       und Abspielrate der Tabellen hier frei whlbar. Die erste Tabelle
+       blendet die LEDs paarweise auf und ab, die zweite ist ein Lauflicht,
+       bei dem jede LED nach dem Einschalten langsam verlischt. Die Tabellen
+       werden einmal zur Laufzeit berechnet. */
+
+    uint32_t f, k, x;
+
+    for (f = 0; f < WAVE_FADE_FRAMES; ++f) {
+        // Dreieck 0..999..0 ber die halbe Tabelle, quadriert
+        x = f % (WAVE_FADE_FRAMES / 2);
+        x = x < WAVE_FADE_FRAMES / 4 ? x : WAVE_FADE_FRAMES / 2 - x;
+        x = x * 1000 / (WAVE_FADE_FRAMES / 4);
+        for (k = 0; k < PWM_BURST_CHANNELS; ++k)
+            waveFade[f][k] = (uint16_t)(((f < WAVE_FADE_FRAMES / 2) == (k & 1))
+                                        ? 0 : x * x / 1000);
+    }
+
+    for (f = 0; f < WAVE_CHASE_FRAMES; ++f) {
+        x = f % (WAVE_CHASE_FRAMES / 4);
+        for (k = 0; k < PWM_BURST_CHANNELS; ++k)
+            waveChase[f][k] = (uint16_t)((f / (WAVE_CHASE_FRAMES / 4) == k)
+                ? 1000 - x * 1000 / (WAVE_CHASE_FRAMES / 4) : 0);
+    }
+
+    pwm_burst_init(waveProgram[0].psc, 999, PWM_BURST_CHANNELS);
+    pwm_burst_play(waveProgram[0].frames, waveProgram[0].count);
+
+    swtimer_init();
+    waveTimer.fn     = wave_next;
+    waveTimer.period = SWTIMER_MS(3000);
+    swtimer_start(&waveTimer, waveTimer.period);
+
+    /* Zwischen den Wechseln hat der Prozessor nichts zu tun. Die Statistik
+       in pwm_burst_stats zeigt, dass es pro Wechsel hchstens zwei Inter-
+       rupts gibt. */
+    while (1)
+        __WFI();
+
+#endif
+}
+
+
+
+
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+
+
+
+#ifdef LED_ENGINE
+
+static swtimer_t ledTimer;
+static uint32_t  ledPhase;
+
+/* Alle 500ms beginnt die nchste LED eine 2 Sekunden lange berblendung,
+   abwechselnd auf volle Helligkeit und auf Stufe 1 (gerade noch sichtbar).
+   Gerade das langsame Auf- und Abblenden im dunklen Bereich zeigt den
+   Unterschied zu pwm_led_example(). */
+static void led_engine_step(swtimer_t *t)
+{
+    uint32_t k  = ledPhase % LED_COUNT;
+    uint32_t up = (ledPhase / LED_COUNT) % 2 == 0;
+
+    ledPhase++;
+    led_fade(k, up ? LED_LEVELS - 1 : 1, 2000);
+}
+
+#endif
+
+/* Dieses Beispiel blendet die 4 LEDs mit der Helligkeitssteuerung aus
+   led.c (16-Bit PWM, Gamma-Korrektur, dithering) langsam auf und ab. */
+void led_engine_example(void)
+{
+#ifdef LED_ENGINE
+    /* Die berblendungen selbst kosten keine Rechenzeit in der Haupt-
+       schleife: led.c berechnet die PWM-Werte blockweise im DMA-Interrupt,
+       ein Software-Timer stt alle 500ms die nchste berblendung an. */
+
+    led_init();
+
+    swtimer_init();
+    ledTimer.fn     = led_engine_step;
+    ledTimer.period = SWTIMER_MS(500);
+    swtimer_start(&ledTimer, ledTimer.period);
+
+    while (1)
+        __WFI();
+
+#endif
+}
+
+
+
+
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+
+
+
+#ifdef DMA_COPY_BENCH
+
+// Gren von 16 Byte bis 64KB, jeweils Faktor 4
+#define COPY_SIZES 7
+
+static const uint32_t copySizes[COPY_SIZES] = {
+    16, 64, 256, 1024, 4096, 16384, 65536
+};
+
+/* Ergebnis in Takten je Gre (Durchsatz in MB/s = Gre * 168 / Takte):
+   copyCpu:    dma_copy_cpu(),
+   copyDma:    dma_memcpy_async() bis zum Ende des Auftrags, ohne den
+               Umweg ber den Prozessor fr kleine Gren,
+   copySubmit: davon die Zeit bis zur Rckkehr aus dma_memcpy_async() -
+               danach ist der Prozessor frei fr anderes.
+   copyPacked: [0] Prozessor, [1] DMA, [2] Rckkehr aus dma_memcpy_async()
+               fr 4KB mit einer Quelle, die um ein Byte verschoben ist
+               (PSIZE = Byte, "packing"). */
+volatile uint32_t copyCpu[COPY_SIZES];
+volatile uint32_t copyDma[COPY_SIZES];
+volatile uint32_t copySubmit[COPY_SIZES];
+volatile uint32_t copyPacked[3];
+
+/* Bis 32KB wird innerhalb von copyBuf von der ersten in die zweite Hlfte
+   kopiert, 64KB kommen aus dem Flash (ab 0x08000000, also das Programm
+   selbst). Mehr als die 64KB passen neben dem Rest nicht in den RAM. */
+static uint8_t copyBuf[65536] __attribute__((aligned(16)));
+
+static dma_copy_t copyJob;
+
+static uint32_t copy_bench_dma(uint8_t *dst, const uint8_t *src, uint32_t len,
+                               volatile uint32_t *submit)
+{
+    uint32_t t0 = cycles_now();
+
+    dma_memcpy_async(&copyJob, dst, src, len, 0);
+    *submit = cycles_now() - t0;
+    dma_copy_wait(&copyJob);
+
+    return cycles_now() - t0;
+}
+
+#endif
+
+/* Dieses Beispiel vergleicht das Kopieren verschieden groer Speicher-
+   bereiche durch den Prozessor und durch den DMA-Controller 2. */
+void dma_copy_benchmark(void)
+{
+#ifdef DMA_COPY_BENCH
+    /* Aus dem Vergleich von copyCpu und copyDma ergibt sich die Schwelle
+       DMA_COPY_THRESHOLD in dma_copy.h: Ein DMA-Auftrag kostet einige
+       hundert Takte, bevor das erste Byte fliet. Der Prozessor schafft im
+       besten Fall etwa ein Wort pro Takt - bei groen Blcken ist er also
+       kaum langsamer, hat aber whrend eines DMA-Transfers die Hnde frei
+       (copySubmit). */
+
+    const uint8_t *src;
+    uint8_t *dst;
+    uint32_t i, t0;
+
+    cycles_init();
+    dma_copy_init();
+
+    // jeden Auftrag per DMA ausfhren, um auch kleine Gren zu messen
+    dma_copy_threshold = 0;
+
+    for (i = 0; i < COPY_SIZES; ++i) {
+        if (copySizes[i] <= sizeof(copyBuf) / 2) {
+            src = copyBuf;
+            dst = copyBuf + sizeof(copyBuf) / 2;
+        } else {
+            src = (const uint8_t*)0x08000000;
+            dst = copyBuf;
+        }
+
+        t0 = cycles_now();
+        dma_copy_cpu(dst, src, copySizes[i]);
+        copyCpu[i] = cycles_now() - t0;
+
+        copyDma[i] = copy_bench_dma(dst, src, copySizes[i], &copySubmit[i]);
+    }
+
+    t0 = cycles_now();
+    dma_copy_cpu(copyBuf + 32768, copyBuf + 1, 4096);
+    copyPacked[0] = cycles_now() - t0;
+    copyPacked[1] = copy_bench_dma(copyBuf + 32768, copyBuf + 1, 4096,
+                                   &copyPacked[2]);
+
+    dma_copy_threshold = DMA_COPY_THRESHOLD;
+
+    // fertig: grne LED an
+    GPIOD->BSRRL = 0x1000;
+
+    while (1);
+
+#endif
+}
+
+
+
+
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+
+
+
+#ifdef DMA_MODE_BENCH
+
+#define MODE_COUNT  5
+#define MODE_WORK   1024
+
+/* Die untersuchten Einstellungen. Die Peripherie (ein 16-Bit Register von
+   Timer 3) wird immer mit einzelnen Halbworten beschrieben, gelesen wird aus
+   dem Speicher
+   [0] im direct mode wie in dma_pwm_led_example(),
+   [1] ber den FIFO, ebenfalls mit einzelnen Halbworten,
+   [2] in bursts von 8 Halbworten,
+   [3] mit einzelnen Worten (packing: 1 Lesezugriff fr 2 Anforderungen),
+   [4] in bursts von 4 Worten (1 Lesezugriff fr 8 Anforderungen). */
+static const dma_mode_t modes[MODE_COUNT] = {
+    { DMA_SIZE_16, DMA_BURST_1, DMA_SIZE_16, DMA_BURST_1, DMA_FIFO_DIRECT },
+    { DMA_SIZE_16, DMA_BURST_1, DMA_SIZE_16, DMA_BURST_1, DMA_FIFO_1_2    },
+    { DMA_SIZE_16, DMA_BURST_1, DMA_SIZE_16, DMA_BURST_8, DMA_FIFO_FULL   },
+    { DMA_SIZE_16, DMA_BURST_1, DMA_SIZE_32, DMA_BURST_1, DMA_FIFO_1_4    },
+    { DMA_SIZE_16, DMA_BURST_1, DMA_SIZE_32, DMA_BURST_4, DMA_FIFO_FULL   }
+};
+
+/* Ergebnis:
+   modeCycles:    Takte der Rechenschleife, [0] ohne DMA, [1 + k] whrend
+                  der Stream mit modes[k] luft,
+   modeSlowdown:  Verlangsamung gegenber [0] in Promille,
+   modeTransfers: bertragene Halbworte whrend der Messung - bleibt der
+                  Wert hinter den Anforderungen des Timers zurck, so kommt
+                  der Stream nicht hinterher. */
+volatile uint32_t modeCycles[MODE_COUNT + 1];
+volatile uint32_t modeSlowdown[MODE_COUNT];
+volatile uint32_t modeTransfers[MODE_COUNT];
+
+static uint16_t modeBuf[256] __attribute__((aligned(16)));
+static uint32_t modeWork[MODE_WORK];
+static volatile uint32_t modeSink;
+static volatile uint32_t modeWraps;
+
+static dma_stream_t modeStream;
+
+static void mode_bench_irq(dma_stream_t *s)
+{
+    dma_clear(s, DMA_FLAG_ALL);
+    modeWraps++;
+}
+
+/* Liest und schreibt stndig den RAM - wie der DMA-Controller, der modeBuf
+   liest. Beide treffen sich an der Busmatrix vor dem SRAM. */
+static uint32_t mode_bench_loop(void)
+{
+    uint32_t i, k, t0, sum = 0;
+
+    t0 = cycles_now();
+    for (k = 0; k < 16; ++k) {
+        for (i = 0; i < MODE_WORK; ++i) {
+            sum += modeWork[i];
+            modeWork[i] = sum;
+        }
+    }
+    modeSink = sum;
+
+    return cycles_now() - t0;
+}
+
+#endif
+
+/* Dieses Beispiel misst, wie stark ein laufender DMA-Stream den Prozessor
+   je nach FIFO- und burst-Einstellung ausbremst. */
+void dma_mode_benchmark(void)
+{
+#ifdef DMA_MODE_BENCH
+    /* Timer 3 fordert mit jedem Update (84MHz / 16 = 5.25MHz) einen
+       Transfer an. Der Stream (DMA1 Stream 2, Kanal 5) schreibt dann im
+       Kreis die 256 Halbworte aus modeBuf nach TIM3->CCR1 - ohne
+       Ausgangspin passiert dabei nichts Sichtbares. Gleichzeitig luft
+       mode_bench_loop(). Jeder Lesezugriff des DMA-Controllers auf den RAM
+       kann den Prozessor einige Takte warten lassen, mit FIFO und bursts
+       gibt es davon deutlich weniger. */
+
+    uint32_t k, cr;
+
+    cycles_init();
+
+    RCC->APB1ENR |= 0x00000002;
+    TIM3->PSC  = 0;
+    TIM3->ARR  = 15;
+    TIM3->DIER = 0x0100;        // UDE: DMA-Anforderung beim Update
+
+    modeStream.fn = mode_bench_irq;
+    if (!dma_claim(DMA_REQ_TIM3_UP, &modeStream))
+        while (1);
+    modeStream.stream->PAR = (uint32_t)(&(TIM3->CCR1));
+
+    modeCycles[0] = mode_bench_loop();
+
+    for (k = 0; k < MODE_COUNT; ++k) {
+        if (!dma_mode(&modeStream, &modes[k], &cr))
+            continue;
+
+        // MINC, CIRC, Speicher zu Peripherie, TCIE
+        modeStream.stream->M0AR = (uint32_t)modeBuf;
+        modeStream.stream->NDTR = 256;
+        modeStream.stream->CR   = modeStream.chsel | cr | 0x00000550;
+        modeStream.stream->CR  |= 0x00000001;
+
+        modeWraps = 0;
+        TIM3->CNT  = 0;
+        TIM3->CR1 |= 0x0001;
+
+        modeCycles[k + 1] = mode_bench_loop();
+
+        TIM3->CR1 &= 0xFFFE;
+        dma_disable(&modeStream);
+        dma_clear(&modeStream, DMA_FLAG_ALL);
+
+        modeTransfers[k] = modeWraps * 256 + (256 - modeStream.stream->NDTR);
+        modeSlowdown[k]  = (modeCycles[k + 1] - modeCycles[0]) * 1000
+                           / modeCycles[0];
+    }
+
+    TIM3->DIER = 0x0000;
+    dma_release(&modeStream);
+
+    // fertig: grne LED an
+    GPIOD->BSRRL = 0x1000;
+
+    while (1);
+
+#endif
+}
+
+
+
+
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+
+
+
+#ifdef UART_LOG_BENCH
+
+/* Ergebnis:
+   logCycles, logCyclesMax: durchschnittliche und grte Anzahl Takte eines
+                            Aufrufs von log_printf() in der Interruptroutine,
+   logBytesPerSec:          gesendete Bytes in der ersten Sekunde, in der
+                            das Hauptprogramm ohne Pause Text ausgibt. Bei
+                            2MBaud und 10 Bit pro Byte (Start, 8 Daten,
+                            Stopp) sind hchstens 200000 mglich. */
+volatile uint32_t logCycles;
+volatile uint32_t logCyclesMax;
+volatile uint32_t logBytesPerSec;
+
+static volatile uint32_t logCalls;
+static uint32_t          logSum;
+
+void TIM3_IRQHandler(void)
+{
+    uint32_t t0, dt;
+
+    TIM3->SR = 0xFFFE;
+
+    t0 = cycles_now();
+    log_printf("irq %u t=%08x\n", logCalls, t0);
+    dt = cycles_now() - t0;
+
+    logSum += dt;
+    logCalls++;
+    logCycles = logSum / logCalls;
+    if (dt > logCyclesMax)
+        logCyclesMax = dt;
+}
+
+#endif
+
+/* Dieses Beispiel gibt ber USART2 (PA2, 2MBaud) Text aus dem Haupt-
+   programm und aus einer Interruptroutine aus und misst den Durchsatz sowie
+   die Kosten eines Aufrufs von log_printf(). */
+void uart_log_benchmark(void)
+{
+#ifdef UART_LOG_BENCH
+    /* Zum Mitlesen wird ein USB-Seriell-Wandler, der 2MBaud beherrscht, mit
+       PA2 (TX) und GND verbunden. Timer 3 ruft 1000 Mal pro Sekunde
+       log_printf() in seiner Interruptroutine auf, whrend das Hauptprogramm
+       eine Sekunde lang so schnell wie mglich Zeilen ausgibt. Ist der Ring
+       voll, so gehen Zeilen verloren (uart_stats.dropped) - gewartet wird
+       nie, auch nicht in der Interruptroutine. */
+
+    uint32_t t0, sent0, i = 0;
+
+    cycles_init();
+    uart_init(2000000);
+
+    log_printf("\nuart_log_benchmark\n");
+
+    NVIC->ISER[0] |= 0x20000000;  // Interrupt von Timer 3 beim NVIC aktivieren
+
+    RCC->APB1ENR |= 0x00000002;
+    TIM3->PSC     = 83;           // 1MHz
+    TIM3->ARR     = 999;          // 1000 berlufe pro Sekunde
+    TIM3->DIER    = 0x0001;
+    TIM3->CR1    |= 0x0001;
+
+    sent0 = uart_stats.sent;
+    t0    = cycles_now();
+    while (cycles_now() - t0 < F_CPU)
+        log_printf("main %u\n", i++);
+    logBytesPerSec = uart_stats.sent - sent0;
+
+    log_printf("%u Bytes/s, log_printf: %u Takte (max. %u)\n",
+               logBytesPerSec, logCycles, logCyclesMax);
+
+    // danach nur noch die Ausgaben der Interruptroutine
+    while (1)
+        __WFI();
+
+#endif
+}
+
+
+
+
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+
+
+
+#ifdef TELEMETRY_ACC
+
+// Messungen pro Paket
+#define TELEM_BATCH 8
+
+/* Ergebnis: Rechenzeit fr Erfassung und Versand in 1/100 Prozent, einmal
+   pro Sekunde neu ermittelt. */
+volatile uint32_t telemLoad;
+
+/* Wird im Interrupt aufgerufen, sobald TELEM_BATCH Messungen vorliegen.
+   Der Sensor liefert alle 2.5ms eine Messung, die Zeitpunkte der lteren
+   Messungen werden daher vom Zeitpunkt des Abholens zurckgerechnet. */
+static void telem_consumer(uint32_t available)
+{
+    int8_t buf[TELEM_BATCH][3];
+    uint32_t i, n, t;
+
+    n = lis302dl_batch_fetch(buf, TELEM_BATCH);
+    t = telemetry_time();
+    for (i = 0; i < n; ++i)
+        telemetry_put(TELEM_ACC, t - (n - 1 - i) * 2500, buf[i]);
+    telemetry_flush();
+}
+
+#endif
+
+/* Dieses Beispiel sendet die Messungen des Beschleunigungssensors (400Hz,
+   3 Achsen) im Binrformat aus telemetry.c ber USART2. */
+void telemetry_acc_example(void)
+{
+#ifdef TELEMETRY_ACC
+    /* Auf dem PC wird der Datenstrom aufgezeichnet und mit
+       tools/telemetry_decode.c in eine CSV-Datei umgewandelt. Ein Paket
+       mit 8 Messungen belegt nach COBS 57 Byte, bei 50 Paketen pro Sekunde
+       also knapp 3KB - das sind nur 1.5% dessen, was bei 2MBaud mglich
+       ist.
+
+       Die Rechenzeit wird ber die Schlafzeit der Hauptschleife bestimmt:
+       Bei gesperrten Interrupts (PRIMASK) weckt ein Interrupt den Prozessor
+       zwar auf, die Interruptroutine luft aber erst nach dem Freigeben.
+       Die Zeit zwischen dem Einschlafen und dem Aufwachen ist also reine
+       Schlafzeit. */
+
+    uint32_t t0, t1, start, idle = 0;
+
+    cycles_init();
+    uart_init(2000000);
+    telemetry_init();
+
+    if (!lis302dl_init())
+        while (1);
+
+    lis302dl_batch_start(TELEM_BATCH, telem_consumer);
+
+    start = cycles_now();
+    while (1) {
+        __disable_irq();
+        t0 = cycles_now();
+        __WFI();
+        t1 = cycles_now();
+        __enable_irq();
+
+        idle += t1 - t0;
+        if (t1 - start >= F_CPU) {
+            telemLoad = 10000 - (uint32_t)(((uint64_t)idle * 10000)
+                                           / (t1 - start));
+            idle  = 0;
+            start = t1;
+        }
+    }
+
+#endif
+}
+
+
+
+
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+
+
+
+#ifdef UART_COMMANDS
+
+// led <0..3> <0|1>: schaltet eine der 4 LEDs (PD12 bis PD15)
+static void cmd_led(const uart_slice_t *line, uint32_t pos)
+{
+    uint32_t n, on;
+
+    if (!cmd_arg(line, &pos, &n) || !cmd_arg(line, &pos, &on) || n > 3) {
+        log_printf("led <0..3> <0|1>\n");
+        return;
+    }
+
+    if (on)
+        GPIOD->BSRRL = 0x1000 << n;
+    else
+        GPIOD->BSRRH = 0x1000 << n;
+}
+
+// stats: Zhler von uart.c und cmd.c ausgeben
+static void cmd_stats_print(const uart_slice_t *line, uint32_t pos)
+{
+    log_printf("rx %u Bytes, %u Zeilen, %u Pausen, %u verworfen, "
+               "%u Fehler\n", uart_stats.received, uart_stats.lines,
+               uart_stats.idles, uart_stats.overruns, uart_stats.errors);
+    log_printf("tx %u Bytes, %u verworfen\n", uart_stats.sent,
+               uart_stats.dropped);
+    log_printf("%u Kommandos, %u unbekannt\n", cmd_stats.executed,
+               cmd_stats.unknown);
+}
+
+static const cmd_t commands[] = {
+    { "led",   cmd_led,         "led <0..3> <0|1> schaltet eine LED" },
+    { "stats", cmd_stats_print, "Zhler fr Empfang und Senden" }
+};
+
+#endif
+
+/* In diesem Beispiel werden ber USART2 (PA2/PA3, 2MBaud) Kommandos
+   empfangen, z.B. "led 0 1", ohne dass fr jedes Byte ein Interrupt
+   anfllt. */
+void uart_commands_example(void)
+{
+#ifdef UART_COMMANDS
+    /* Ein Terminalprogramm am USB-Seriell-Wandler gengt. Die Bytes landen
+       per DMA im Empfangsring von uart.c. Interrupts gibt es nur, wenn
+       die Leitung nach einer Zeile still wird, oder wenn der Ring halb
+       bzw. ganz gefllt ist - bei eingefgtem Text mit vielen Zeilen auf
+       einmal also hchstens zwei pro 256 Bytes. Wie viele Zeilen zu lang
+       waren oder Fehler hatten, zeigt das Kommando "stats". */
+
+    cycles_init();
+    uart_init(2000000);
+    cmd_init(commands, sizeof(commands) / sizeof(commands[0]));
+
+    log_printf("\nuart_commands_example - help listet alle Kommandos\n");
+
+    while (1)
+        __WFI();
+
+#endif
+}
+
+
+
+
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+
+
+
+#ifdef KV_STORE
+
+// wartet ms Millisekunden
+static void kv_delay(uint32_t ms)
+{
+    uint32_t t0 = cycles_now();
+
+    while (cycles_now() - t0 < ms * (F_CPU / 1000));
+}
+
+/* Mittelt 64 Messungen des Sensors (bei 100Hz also gut eine halbe
+   Sekunde). Das board muss dabei flach und ruhig liegen. */
+static void kv_calibrate(int8_t offset[3])
+{
+    int32_t sum[3] = { 0, 0, 0 };
+    int8_t xyz[3];
+    uint32_t i, j;
+
+    for (i = 0; i < 64; ++i) {
+        lis302dl_read_xyz(xyz);
+        for (j = 0; j < 3; ++j)
+            sum[j] += xyz[j];
+        kv_delay(10);
+    }
+
+    for (j = 0; j < 3; ++j)
+        offset[j] = (int8_t)(sum[j] / 64);
+}
+
+#endif
+
+/* In diesem Beispiel werden die Offsets des Beschleunigungssensors im
+   Flash-Speicher abgelegt, so dass sie einen Reset berdauern. */
+void kv_store_example(void)
+{
+#ifdef KV_STORE
+    /* Beim ersten Start - oder wenn beim Reset der Taster gedrckt ist -
+       werden die Offsets neu gemessen und mit kv_set() gespeichert. Danach
+       gibt das Beispiel zweimal pro Sekunde die korrigierten Messwerte
+       ber USART2 aus. Der Zhler KV_BOOTS wird bei jedem Start neu
+       geschrieben, nach einigen tausend Resets wird also auch das Um-
+       kopieren in den anderen Sektor sichtbar (kv_stats.compactions). */
+
+    int8_t offset[3], xyz[3];
+    uint32_t boots = 0;
+
+    cycles_init();
+    uart_init(2000000);
+
+    if (!kv_init() || !lis302dl_init())
+        while (1);
+
+    kv_get(KV_BOOTS, &boots, sizeof(boots));
+    ++boots;
+    kv_set(KV_BOOTS, &boots, sizeof(boots));
+
+    if ((GPIOA->IDR & 0x00000001) ||
+        kv_get(KV_ACC_OFFSET, offset, 3) != 3) {
+        log_printf("Kalibrierung, board flach hinlegen...\n");
+        kv_delay(2000);
+        kv_calibrate(offset);
+        kv_set(KV_ACC_OFFSET, offset, 3);
+    }
+
+    log_printf("Start %u, Generation %u, %u Byte belegt\n", boots,
+               kv_stats.generation, kv_stats.used);
+    log_printf("Offsets x %d y %d z %d\n", offset[0], offset[1], offset[2]);
+
+    /* Bei flachem board misst z die Erdbeschleunigung (ca. 55 bei 18mg
+       pro LSB), die Offsets enthalten sie also mit. Die korrigierten Werte
+       sind daher die Abweichung von der Ruhelage: */
+    while (1) {
+        lis302dl_read_xyz(xyz);
+        log_printf("x %4d y %4d z %4d\n", xyz[0] - offset[0],
+                   xyz[1] - offset[1], xyz[2] - offset[2]);
+        kv_delay(500);
+    }
+
+#endif
+}
+
+
+
+
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+
+/* Dieses Beispiel gibt aus, welchen Slot der Bootloader (boot.c) gestartet
+   hat und wie lange er dafr gebraucht hat. */
+void boot_info_example(void)
+{
+#ifdef BOOT_INFO_LOG
+    /* Das Programm muss dafr mit make SLOT=a image (bzw. SLOT=b) gebaut
+       und zusammen mit dem Bootloader (make boot) auf das board geschrieben
+       werden. Der Bootloader luft mit den 16MHz des HSI, 16 Takte sind
+       also 1us. Die Prfung eines Slots kostet etwa 4 Takte pro Wort des
+       Programms - die CRC-Einheit ist so schnell wie das Lesen aus dem
+       Flash-Speicher. */
+
+    volatile boot_info_t *info = BOOT_INFO;
+
+    uart_init(2000000);
+
+    if (info->magic != BOOT_MAGIC) {
+        log_printf("ohne Bootloader gestartet\n");
+    } else {
+        log_printf("Slot %c, Version %u\n",
+                   info->slot == BOOT_SLOT_A ? 'A' : 'B', info->version);
+        log_printf("Pruefung A %uus, B %uus, gesamt %uus\n",
+                   info->checkA / 16, info->checkB / 16, info->total / 16);
+    }
+
+    while (1)
+        __WFI();
+
+#endif
+}
+
+
+
+
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+
+#ifdef POWER_STOP
+
+static sched_task_t powerTask;
+static swtimer_t    powerTimer;
+
+/* Schaltet die grne LED kurz ein und gibt einmal pro Sekunde die
+   Statistik von power.c aus. Der Rest der Zeit wird verschlafen. */
+static void power_task(sched_task_t *t, uint32_t events)
+{
+    static uint32_t n;
+
+    if (GPIOD->ODR & 0x1000) {
+        GPIOD->BSRRH = 0x1000;
+        swtimer_start(&powerTimer, SWTIMER_MS(950));
+        return;
+    }
+
+    GPIOD->BSRRL = 0x1000;
+    swtimer_start(&powerTimer, SWTIMER_MS(50));
+
+    log_printf("%u: stop %u (%u frueh) sleep %u, %ums, wake %uus (max %uus)\n",
+               ++n, power_stats.stops, power_stats.early, power_stats.sleeps,
+               power_stats.stopUs / 1000, power_stats.wakeCycles / 16,
+               power_stats.wakeMax / 16);
+}
+
+#endif
+
+/* In diesem Beispiel verbringt der Prozessor die Zeit zwischen zwei
+   Aufgaben des Schedulers im Stop mode (s. power.h). */
+void power_stop_example(void)
+{
+#ifdef POWER_STOP
+    /* Nach dem Stop mode luft der Prozessor zunchst mit dem HSI (16MHz),
+       bis rcc_init() wieder auf die PLL umgeschaltet hat. Die angezeigte
+       Dauer des Aufwachens rechnet daher grob mit 16 Takten pro us, der
+       grte Teil davon ist das Warten auf HSE und PLL. */
+
+    cycles_init();
+    uart_init(2000000);
+
+    sched_init();
+    power_init();
+
+    log_printf("LSI %uHz\n", power_stats.lsiHz);
+
+    powerTask.fn   = power_task;
+    powerTask.prio = 0;
+
+    powerTimer.fn  = sched_timer_post;
+    powerTimer.arg = &powerTask;
+
+    sched_post(&powerTask, 1);
+    sched_run();
+
+#endif
+}
+
+
+
+
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+
+#ifdef BUTTON_GESTURES
+
+static sched_task_t gestureTask;
+
+/* Ein Klick schaltet die grne LED um, ein Doppelklick die orange und
+   langes Drcken die rote. Die blaue leuchtet, solange der Taster
+   gedrckt ist. */
+static void gesture_task(sched_task_t *t, uint32_t events)
+{
+    if (events & BUTTON_EV_DOWN)
+        GPIOD->BSRRL = 0x8000;
+    if (events & BUTTON_EV_UP)
+        GPIOD->BSRRH = 0x8000;
+
+    if (events & BUTTON_EV_CLICK)
+        GPIO_TOGGLE(GPIOD, 0x1000);
+    if (events & BUTTON_EV_DOUBLE)
+        GPIO_TOGGLE(GPIOD, 0x2000);
+    if (events & BUTTON_EV_LONG)
+        GPIO_TOGGLE(GPIOD, 0x4000);
+
+    log_printf("Flanken %u, Druecke %u, Prellen %u\n", button_stats.edges,
+               button_stats.presses, button_stats.glitches);
+}
+
+#endif
+
+/* In diesem Beispiel erkennt button.c Klick, Doppelklick und langes
+   Drcken des User-Buttons. */
+void button_gestures_example(void)
+{
+#ifdef BUTTON_GESTURES
+    /* Die Zahl der Flanken pro Tastendruck zeigt, wie stark der Taster
+       ohne C38 prellt. Mit einem zu kurzen Entprellfenster (z.B.
+       SWTIMER_MS(1)) tauchen Tastendrcke auf, die es nicht gab. Zwischen
+       den Ereignissen schlft der Prozessor im Stop mode - die Leitung
+       EXTI0 weckt ihn. */
+
+    uart_init(2000000);
+
+    sched_init();
+    power_init();
+
+    gestureTask.fn   = gesture_task;
+    gestureTask.prio = 0;
+    button_init(&gestureTask, BUTTON_DEBOUNCE_US);
+
+    sched_run();
+
+#endif
+}
+
+
+
+
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+
+#ifdef MEMPOOL_BENCH
+
+/* Zum Vergleich ein Heap, wie ihn malloc() verwaltet - hier als einfache
+   first-fit-Liste, da die libc (und damit malloc() der newlib) beim Linken
+   verworfen wird (s. stm32_sections.ld). Jeder Block beginnt mit einem Kopf
+   samt seiner Gre. Die freien Blcke sind nach Adresse sortiert, beim
+   Freigeben werden benachbarte Blcke zusammengelegt. Der Heap erhlt
+   genauso viel Speicher wie alle Pools zusammen. */
+
+#define BENCH_BYTES_(size, count)  + (size) * (count)
+#define HEAP_BYTES   (0 MEMPOOL_LIST(BENCH_BYTES_))
+
+#define BENCH_SLOTS  48
+#define BENCH_STEPS  20000
+
+typedef struct hblock
+{
+    struct hblock *next;    // nchster freier Block
+    uint32_t       size;    // Gre inkl. Kopf
+} hblock_t;
+
+static uint64_t  heapStore[HEAP_BYTES / 8];
+static hblock_t *heapFree;
+
+static void heap_init(void)
+{
+    heapFree = (hblock_t*)heapStore;
+    heapFree->next = 0;
+    heapFree->size = HEAP_BYTES;
+}
+
+static void *heap_alloc(uint32_t size)
+{
+    hblock_t **pp, *b, *r;
+
+    size = (size + sizeof(hblock_t) + 7) & ~7UL;
+
+    for (pp = &heapFree; (b = *pp) != 0; pp = &b->next) {
+        if (b->size < size)
+            continue;
+        if (b->size - size >= 2 * sizeof(hblock_t)) {
+            // den hinteren Teil abspalten, der Rest bleibt in der Liste
+            b->size -= size;
+            r = (hblock_t*)((uint8_t*)b + b->size);
+            r->size = size;
+        } else {
+            *pp = b->next;
+            r = b;
+        }
+        return r + 1;
+    }
+
+    return 0;
+}
+
+static void heap_release(void *p)
+{
+    hblock_t *b = (hblock_t*)p - 1, *prev = 0, *n = heapFree;
+
+    while (n && n < b) {
+        prev = n;
+        n = n->next;
+    }
+
+    b->next = n;
+    if (n && (uint8_t*)b + b->size == (uint8_t*)n) {
+        b->size += n->size;
+        b->next  = n->next;
+    }
+
+    if (!prev) {
+        heapFree = b;
+    } else {
+        prev->next = b;
+        if ((uint8_t*)prev + prev->size == (uint8_t*)b) {
+            prev->size += b->size;
+            prev->next  = b->next;
+        }
+    }
+}
+
+
+static void *slots[BENCH_SLOTS];
+
+/* Belegt und befreit in zuflliger Folge Blcke von 8 bis 71 Byte, jeder
+   vierte ist 100 bis 483 Byte gro. Dank gleichem Startwert sehen beide
+   Verfahren dieselben Anforderungen. */
+static void bench_run(const char *name, void *(*alloc)(uint32_t),
+                      void (*release)(void*))
+{
+    uint32_t rnd = 1, i, k, size, t, allocs = 0, frees = 0, fails = 0;
+    uint32_t aSum = 0, aMax = 0, fSum = 0, fMax = 0;
+    uint32_t freeBytes = 0, largest = 0;
+    hblock_t *b;
+
+    __disable_irq();
+
+    for (i = 0; i < BENCH_STEPS; ++i) {
+        rnd = rnd * 1103515245 + 12345;
+        k = (rnd >> 16) % BENCH_SLOTS;
+
+        if (slots[k]) {
+            t = cycles_now();
+            release(slots[k]);
+            t = cycles_now() - t;
+            slots[k] = 0;
+            ++frees;
+            fSum += t;
+            if (t > fMax)
+                fMax = t;
+        } else {
+            size = (rnd >> 8) & 0x03 ? 8 + ((rnd >> 10) & 0x3F)
+                                     : 100 + ((rnd >> 10) & 0x17F);
+            t = cycles_now();
+            slots[k] = alloc(size);
+            t = cycles_now() - t;
+            if (!slots[k])
+                ++fails;
+            ++allocs;
+            aSum += t;
+            if (t > aMax)
+                aMax = t;
+        }
+    }
+
+    /* Externe Fragmentierung des Heaps: der grte freie Block im
+       Verhltnis zum gesamten freien Speicher. */
+    for (b = heapFree; alloc == heap_alloc && b; b = b->next) {
+        freeBytes += b->size;
+        if (b->size > largest)
+            largest = b->size;
+    }
+
+    for (k = 0; k < BENCH_SLOTS; ++k) {
+        release(slots[k]);
+        slots[k] = 0;
+    }
+
+    __enable_irq();
+
+    log_printf("%s: alloc %u/%u Takte (Mittel/max), free %u/%u, "
+               "%u von %u fehlgeschlagen\n", name, aSum / allocs, aMax,
+               fSum / frees, fMax, fails, allocs);
+    if (freeBytes)
+        log_printf("%s: %u Byte frei, groesster Block %u Byte\n", name,
+                   freeBytes, largest);
+}
+
+static void heap_release_any(void *p)
+{
+    if (p)
+        heap_release(p);
+}
+
+#endif
+
+/* Dieses Beispiel vergleicht die Pools aus mempool.c mit einem einfachen
+   Heap in Laufzeit und Fragmentierung. */
+void mempool_bench_example(void)
+{
+#ifdef MEMPOOL_BENCH
+    /* Die Pools brauchen fr jede Anforderung nur wenige Dutzend Takte,
+       unabhngig von der Belegung. Der Heap durchsucht dagegen seine Liste
+       freier Blcke - je lnger das Programm luft, desto lnger wird sie
+       und desto kleiner werden die Lcken darin. Dafr verschenken die
+       Pools den Verschnitt bis zur nchsten Blockgre. */
+
+    uint32_t c;
+
+    cycles_init();
+    uart_init(2000000);
+
+    mempool_init();
+    heap_init();
+
+    bench_run("pool", mempool_alloc, mempool_free);
+    bench_run("heap", heap_alloc, heap_release_any);
+
+    for (c = 0; c < MEMPOOL_CLASSES; ++c)
+        log_printf("Klasse %u: %u Bloecke, Spitze %u, ausgewichen %u, "
+                   "erschoepft %u\n", mempool_stats[c].size,
+                   mempool_stats[c].count, mempool_stats[c].peak,
+                   mempool_stats[c].spills, mempool_stats[c].fails);
+
+    while (1)
+        __WFI();
+
+#endif
+}
+
+
+
+
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+
+#ifdef ACC_ARENA
+
+// Messungen pro Block (bei 400Hz also 80ms)
+#define ARENA_BLOCK  32
+
+ARENA_STORAGE(scratchMem, 2048, ARENA_CCM);
+
+static arena_t scratch;
+static volatile uint32_t arenaReady;
+
+static void arena_consumer(uint32_t available)
+{
+    arenaReady = 1;
+}
+
+/* Entfernt den Mittelwert einer Achse und liefert die mittlere quadrati-
+   sche Abweichung (Varianz) in 1/256 LSB^2. Die Werte liegen als int16_t
+   paarweise in 32-Bit Worten, __SMLAD multipliziert und addiert beide
+   Hlften in einem Takt. */
+static uint32_t arena_variance(int8_t (*raw)[3], uint32_t n, uint32_t axis)
+{
+    arena_mark_t m = arena_mark(&scratch);
+    int16_t *x;
+    uint32_t *w, i, acc = 0;
+    int32_t sum = 0, mean;
+
+    // gerade Anzahl, damit auch das letzte Paar vollstndig ist
+    x = arena_alloc(&scratch, (n + 1) / 2 * 2 * sizeof(int16_t));
+    if (!x)
+        return 0;
+
+    for (i = 0; i < n; ++i)
+        sum += raw[i][axis];
+    mean = sum * 16 / (int32_t)n;
+
+    for (i = 0; i < n; ++i)
+        x[i] = (int16_t)(raw[i][axis] * 16 - mean);
+    if (n & 1)
+        x[n] = 0;
+
+    w = (uint32_t*)x;
+    for (i = 0; i < (n + 1) / 2; ++i)
+        acc = __SMLAD(w[i], w[i], acc);
+
+    arena_reset(&scratch, m);
+
+    return acc / n;
+}
+
+#endif
+
+/* In diesem Beispiel wird jeder Block von Messungen des Beschleunigungs-
+   sensors mit Puffern aus einer Arena (s. arena.h) ausgewertet. */
+void acc_arena_example(void)
+{
+#ifdef ACC_ARENA
+    /* Die Puffer eines Blocks leben nur bis zu dessen Ende: Zu Beginn wird
+       der Stand der Arena gemerkt, am Ende wird sie darauf zurckgesetzt.
+       arena_variance() schachtelt darin eine eigene Marke. Der Spitzenwert
+       zeigt, wie gro scratchMem wirklich sein muss. */
+
+    int8_t (*raw)[3];
+    arena_mark_t m;
+    uint32_t n, vx, vy, vz, blocks = 0;
+
+    uart_init(2000000);
+    arena_init(&scratch, scratchMem, sizeof(scratchMem));
+
+    if (!lis302dl_init())
+        while (1);
+
+    lis302dl_batch_start(ARENA_BLOCK, arena_consumer);
+
+    while (1) {
+        while (!arenaReady)
+            __WFI();
+        arenaReady = 0;
+
+        m   = arena_mark(&scratch);
+        raw = arena_alloc(&scratch, ARENA_BLOCK * 3);
+        n   = lis302dl_batch_fetch(raw, ARENA_BLOCK);
+
+        if (n) {
+            vx = arena_variance(raw, n, 0);
+            vy = arena_variance(raw, n, 1);
+            vz = arena_variance(raw, n, 2);
+
+            // etwa alle 2 Sekunden eine Zeile
+            if (++blocks % 25 == 0)
+                log_printf("Varianz x %u y %u z %u, Arena %u von %u Byte "
+                           "(Spitze %u)\n", vx, vy, vz, scratch.used,
+                           scratch.size, scratch.peak);
+        }
+
+        arena_reset(&scratch, m);
+    }
+
+#endif
+}
+
+
+
+
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+
+#ifdef MPU_BENCH
+
+#define MPU_BENCH_BYTES  4096
+#define MPU_BENCH_RUNS   1000
+
+static uint32_t   mpuSrc[MPU_BENCH_BYTES / 4];
+static uint32_t   mpuDst[MPU_BENCH_BYTES / 4];
+static k_thread_t mpuThread;
+
+// zwei eigene Guards fr mpu_switch_cycles(), passend ausgerichtet
+static uint8_t mpuGuards[2][MPU_GUARD_SIZE]
+    __attribute__((aligned(MPU_GUARD_SIZE)));
+
+/* Kopiert im SRAM und summiert den Anfang des Flash-Speichers. Liefert
+   die Takte fr beides. */
+static uint32_t mpu_access_cycles(void)
+{
+    const volatile uint32_t *flash = (const uint32_t*)0x08000000;
+    uint32_t t, i, sum = 0;
+
+    t = cycles_now();
+    dma_copy_cpu(mpuDst, mpuSrc, MPU_BENCH_BYTES);
+    for (i = 0; i < MPU_BENCH_BYTES / 4; ++i)
+        sum += flash[i];
+    t = cycles_now() - t;
+
+    mpuDst[0] = sum;
+    return t;
+}
+
+/* Takte fr das Umstellen von Region 6, wie es PendSV_Handler bei jedem
+   Threadwechsel tut - abzglich der leeren Schleife. */
+static uint32_t mpu_switch_cycles(void)
+{
+    volatile uint32_t *rbar = &MPU->RBAR;
+    uint32_t guard[2][2], t, empty, i;
+
+    mpu_stack_guard(guard[0], mpuGuards[0]);
+    mpu_stack_guard(guard[1], mpuGuards[1]);
+
+    t = cycles_now();
+    for (i = 0; i < MPU_BENCH_RUNS; ++i)
+        __NOP();
+    empty = cycles_now() - t;
+
+    t = cycles_now();
+    for (i = 0; i < MPU_BENCH_RUNS; ++i) {
+        rbar[0] = guard[i & 1][0];
+        rbar[1] = guard[i & 1][1];
+    }
+    t = cycles_now() - t;
+
+    mpu_stack_guard(guard[0], 0);
+    rbar[0] = guard[0][0];
+    rbar[1] = guard[0][1];
+
+    return (t - empty) * 100 / MPU_BENCH_RUNS;
+}
+
+/* Rekursion ohne Ende: Jeder Aufruf belegt gut 64 Byte Stack, bis der
+   Guard am unteren Ende erreicht ist. */
+static uint32_t __attribute__((noinline)) mpu_recurse(uint32_t depth)
+{
+    volatile uint8_t local[64];
+
+    local[0] = (uint8_t)depth;
+    return mpu_recurse(depth + 1) + local[0];
+}
+
+static void mpu_overflow_thread(void *arg)
+{
+    mpu_recurse(0);
+}
+
+// Nach dem Zugriff auf den Guard blinkt die rote LED schnell
+static void mpu_fault_blink(void)
+{
+    uint32_t t;
+
+    while (1) {
+        GPIO_TOGGLE(GPIOD, 0x4000);
+        t = cycles_now();
+        while (cycles_now() - t < F_CPU / 10);
+    }
+}
+
+#endif
+
+/* Dieses Beispiel richtet die MPU ein (s. mpu.h), misst ihre Kosten und
+   fngt dann einen Stackberlauf ab. */
+void mpu_benchmark(void)
+{
+#ifdef MPU_BENCH
+    /* Die MPU prft jeden Zugriff parallel zum Zugriff selbst - mit und
+       ohne MPU sollte das Kopieren also gleich lange dauern. Das Umstellen
+       einer Region kostet zwei Schreibzugriffe auf die Systemregister, die
+       Angabe ist in 1/100 Takt. */
+
+    uint32_t off, on, sw;
+
+    cycles_init();
+    uart_init(2000000);
+
+    // der erste Durchlauf fllt den Cache des Flash-Speichers (ART)
+    mpu_access_cycles();
+    off = mpu_access_cycles();
+    mpu_init();
+    on  = mpu_access_cycles();
+    sw  = mpu_switch_cycles();
+
+    log_printf("Zugriffe ohne MPU %u, mit MPU %u Takte\n", off, on);
+    log_printf("Region umstellen %u/100 Takte\n", sw);
+    log_printf("Stackueberlauf im Thread...\n");
+    uart_flush();
+
+    /* Der Thread erhlt 512 Byte Stack. Der berlauf endet im Guard, nicht
+       im Stack des nchsten Threads - mpu_fault zeigt im Debugger Adresse
+       und Befehl des verbotenen Zugriffs. */
+    mpu_fault_hook = mpu_fault_blink;
+
+    k_init();
+    k_thread_create(&mpuThread, mpu_overflow_thread, 0, 1, 512);
+    k_start();
+
+#endif
+}
@@ -46,4 +46,171 @@ void pwm_led_example(void);
    und ausblenden lassen kann.*/
 void dma_pwm_led_example(void);
 
+
+
+//------------------------------------------------------------------------
+
+/* In diesem Beispiel wird der Beschleunigungssensor des discovery boards
+   ausgelesen und die Neigung des boards ber die 4 LEDs angezeigt. */
+void acc_tilt_example(void);
+
+
+
+//------------------------------------------------------------------------
+
+/* Dieses Beispiel misst, wie viele Interrupts und Aufwachvorgnge die
+   gepufferte Erfassung des Beschleunigungssensors bei verschiedenen
+   watermarks verursacht und wie viel Rechenzeit dabei anfllt. */
+void acc_batch_benchmark(void);
+
+
+
+//------------------------------------------------------------------------
+
+/* Dieses Beispiel vergleicht die Laufzeit verschiedener Arten, ein
+   einzelnes Bit in einem Hardwareregister oder im SRAM zu verndern
+   (Lesen-ndern-Schreiben, BSRR und bit-banding). */
+void bitband_benchmark(void);
+
+
+
+//------------------------------------------------------------------------
+
+/* Dieses Beispiel misst die Kosten der Software-Timer aus swtimer.c und
+   lsst im Anschluss die 4 LEDs mit verschiedenen Perioden blinken, die
+   sich alle einen einzigen Hardware-Timer (Timer 2) teilen. */
+void swtimer_benchmark(void);
+
+
+
+//------------------------------------------------------------------------
+
+/* Dieses Beispiel startet den premptiven Kernel aus kernel.c mit zwei
+   Threads und misst, wie lange ein Threadwechsel dauert. */
+void kernel_benchmark(void);
+
+
+
+//------------------------------------------------------------------------
+
+/* Dieses Beispiel lsst die LEDs wie dma_pwm_led_example() paarweise
+   auf- und abblenden, bentigt dafr aber nur einen einzigen DMA-Stream
+   und keinen zweiten Timer. Zuvor wird die Buslast beider Varianten
+   verglichen. */
+void dma_burst_led_example(void);
+
+
+
+//------------------------------------------------------------------------
+
+/* Dieses Beispiel spielt ber pwm_burst.c zwei Wellenformen verschiedener
+   Lnge mit wechselnder Geschwindigkeit auf den 4 LEDs ab. */
+void wave_player_example(void);
+
+
+
+//------------------------------------------------------------------------
+
+/* Dieses Beispiel blendet die 4 LEDs mit der Helligkeitssteuerung aus
+   led.c (16-Bit PWM, Gamma-Korrektur, dithering) langsam auf und ab. */
+void led_engine_example(void);
+
+
+
+//------------------------------------------------------------------------
+
+/* Dieses Beispiel vergleicht das Kopieren verschieden groer Speicher-
+   bereiche durch den Prozessor und durch den DMA-Controller 2. */
+void dma_copy_benchmark(void);
+
+
+
+//------------------------------------------------------------------------
+
+/* Dieses Beispiel misst, wie stark ein laufender DMA-Stream den Prozessor
+   je nach FIFO- und burst-Einstellung ausbremst. */
+void dma_mode_benchmark(void);
+
+
+
+//------------------------------------------------------------------------
+
+/* Dieses Beispiel gibt ber USART2 (PA2, 2MBaud) Text aus dem Haupt-
+   programm und aus einer Interruptroutine aus und misst den Durchsatz sowie
+   die Kosten eines Aufrufs von log_printf(). */
+void uart_log_benchmark(void);
+
+
+
+//------------------------------------------------------------------------
+
+/* Dieses Beispiel sendet die Messungen des Beschleunigungssensors (400Hz,
+   3 Achsen) im Binrformat aus telemetry.c ber USART2. */
+void telemetry_acc_example(void);
+
+
+
+//------------------------------------------------------------------------
+
+/* In diesem Beispiel werden ber USART2 (PA2/PA3, 2MBaud) Kommandos
+   empfangen, z.B. "led 0 1", ohne dass fr jedes Byte ein Interrupt
+   anfllt. */
+void uart_commands_example(void);
+
+
+
+//------------------------------------------------------------------------
+
+/* In diesem Beispiel werden die Offsets des Beschleunigungssensors im
+   Flash-Speicher abgelegt, so dass sie einen Reset berdauern. */
+void kv_store_example(void);
+
+
+
+//------------------------------------------------------------------------
+
+/* Dieses Beispiel gibt aus, welchen Slot der Bootloader (boot.c) gestartet
+   hat und wie lange er dafr gebraucht hat. */
+void boot_info_example(void);
+
+
+
+//------------------------------------------------------------------------
+
+/* In diesem Beispiel verbringt der Prozessor die Zeit zwischen zwei
+   Aufgaben des Schedulers im Stop mode (s. power.h). */
+void power_stop_example(void);
+
+
+
+//------------------------------------------------------------------------
+
+/* In diesem Beispiel erkennt button.c Klick, Doppelklick und langes
+   Drcken des User-Buttons. */
+void button_gestures_example(void);
+
+
+
+//------------------------------------------------------------------------
+
+/* Dieses Beispiel vergleicht die Pools aus mempool.c mit einem einfachen
+   Heap in Laufzeit und Fragmentierung. */
+void mempool_bench_example(void);
+
+
+
+//------------------------------------------------------------------------
+
+/* In diesem Beispiel wird jeder Block von Messungen des Beschleunigungs-
+   sensors mit Puffern aus einer Arena (s. arena.h) ausgewertet. */
+void acc_arena_example(void);
+
+
+
+//------------------------------------------------------------------------
+
+/* Dieses Beispiel richtet die MPU ein (s. mpu.h), misst ihre Kosten und
+   fngt dann einen Stackberlauf ab. */
+void mpu_benchmark(void);
+
 #endif
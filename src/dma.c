@@ -0,0 +1,312 @@
+/*
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+*/
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "dma.h"
+
+
+/* Die mglichen Streams jeder Anforderung aus den Tabellen 20 (DMA1) und 21
+(DMA2) in [1]. Steht eine Anforderung mehrfach in der Tabelle, so wird der
+erste freie Eintrag genommen. */
+typedef struct
+{
+    uint8_t req;
+    uint8_t ctrl;       // 1 = DMA1, 2 = DMA2
+    uint8_t stream;
+    uint8_t channel;
+} dma_option_t;
+
+static const dma_option_t options[] = {
+    { DMA_REQ_SPI1_RX,   2, 0, 3 }, { DMA_REQ_SPI1_RX,   2, 2, 3 },
+    { DMA_REQ_SPI1_TX,   2, 3, 3 }, { DMA_REQ_SPI1_TX,   2, 5, 3 },
+    { DMA_REQ_SPI2_RX,   1, 3, 0 },
+    { DMA_REQ_SPI2_TX,   1, 4, 0 },
+    { DMA_REQ_SPI3_RX,   1, 0, 0 }, { DMA_REQ_SPI3_RX,   1, 2, 0 },
+    { DMA_REQ_SPI3_TX,   1, 5, 0 }, { DMA_REQ_SPI3_TX,   1, 7, 0 },
+    { DMA_REQ_I2C1_RX,   1, 0, 1 }, { DMA_REQ_I2C1_RX,   1, 5, 1 },
+    { DMA_REQ_I2C1_TX,   1, 6, 1 }, { DMA_REQ_I2C1_TX,   1, 7, 1 },
+    { DMA_REQ_USART1_RX, 2, 2, 4 }, { DMA_REQ_USART1_RX, 2, 5, 4 },
+    { DMA_REQ_USART1_TX, 2, 7, 4 },
+    { DMA_REQ_USART2_RX, 1, 5, 4 },
+    { DMA_REQ_USART2_TX, 1, 6, 4 },
+    { DMA_REQ_USART3_RX, 1, 1, 4 },
+    { DMA_REQ_USART3_TX, 1, 3, 4 }, { DMA_REQ_USART3_TX, 1, 4, 7 },
+    { DMA_REQ_TIM2_UP,   1, 1, 3 }, { DMA_REQ_TIM2_UP,   1, 7, 3 },
+    { DMA_REQ_TIM3_CH1,  1, 4, 5 },
+    { DMA_REQ_TIM3_CH2,  1, 5, 5 },
+    { DMA_REQ_TIM3_CH3,  1, 7, 5 },
+    { DMA_REQ_TIM3_CH4,  1, 2, 5 },
+    { DMA_REQ_TIM3_UP,   1, 2, 5 },
+    { DMA_REQ_TIM4_CH1,  1, 0, 2 },
+    { DMA_REQ_TIM4_CH2,  1, 3, 2 },
+    { DMA_REQ_TIM4_CH3,  1, 7, 2 },
+    { DMA_REQ_TIM4_UP,   1, 6, 2 },
+    { DMA_REQ_DAC1,      1, 5, 7 },
+    { DMA_REQ_DAC2,      1, 6, 7 },
+    { DMA_REQ_ADC1,      2, 0, 0 }, { DMA_REQ_ADC1,      2, 4, 0 },
+
+    /* Speicher-zu-Speicher-Transfers kann nur DMA2 ausfhren, dafr aber
+       auf jedem Stream. Zuerst kommen die Streams, die von keiner der
+       obigen Anforderungen gebraucht werden. */
+    { DMA_REQ_MEM2MEM,   2, 1, 0 }, { DMA_REQ_MEM2MEM,   2, 6, 0 },
+    { DMA_REQ_MEM2MEM,   2, 4, 0 }, { DMA_REQ_MEM2MEM,   2, 7, 0 },
+    { DMA_REQ_MEM2MEM,   2, 3, 0 }, { DMA_REQ_MEM2MEM,   2, 5, 0 },
+    { DMA_REQ_MEM2MEM,   2, 2, 0 }, { DMA_REQ_MEM2MEM,   2, 0, 0 }
+};
+
+#define OPTIONS  (sizeof(options) / sizeof(options[0]))
+
+// Interrupt Nummern der Streams (Tabelle 30 in [1])
+static const uint8_t irqs[16] = {
+    11, 12, 13, 14, 15, 16, 17, 47,     // DMA1 Stream 0 bis 7
+    56, 57, 58, 59, 60, 68, 69, 70      // DMA2 Stream 0 bis 7
+};
+
+static DMA_Stream_TypeDef * const streams[16] = {
+    DMA1_Stream0, DMA1_Stream1, DMA1_Stream2, DMA1_Stream3,
+    DMA1_Stream4, DMA1_Stream5, DMA1_Stream6, DMA1_Stream7,
+    DMA2_Stream0, DMA2_Stream1, DMA2_Stream2, DMA2_Stream3,
+    DMA2_Stream4, DMA2_Stream5, DMA2_Stream6, DMA2_Stream7
+};
+
+// Besitzer der Streams, Index = (Controller - 1) * 8 + Stream
+static dma_stream_t *owner[16];
+
+/* Die Flags der Streams 0 bis 3 liegen im LISR bzw. LIFCR, die der Streams
+4 bis 7 im HISR bzw. HIFCR, jeweils ab Bit 0, 6, 16 und 22 (S.181 in [1]). */
+static const uint8_t flagShift[4] = { 0, 6, 16, 22 };
+
+// Anzahl der beats zu DMA_BURST_...
+static const uint8_t beats[4] = { 1, 4, 8, 16 };
+
+
+
+/* Trgt den Stream der Option o in s ein. */
+static void assign(const dma_option_t *o, dma_stream_t *s)
+{
+    uint32_t i = (o->ctrl - 1) * 8 + o->stream;
+
+    s->dma    = (o->ctrl == 1) ? DMA1 : DMA2;
+    s->stream = streams[i];
+    s->no     = o->stream;
+    s->req    = o->req;
+    s->irq    = irqs[i];
+    s->chsel  = (uint32_t)o->channel << 25;
+
+    owner[i] = s;
+}
+
+static void unassign(dma_stream_t *s)
+{
+    owner[(s->dma == DMA1 ? 0 : 8) + s->no] = 0;
+}
+
+/* Versucht, die Anforderungen ab reqs[k] zu belegen. Schlgt das fr eine
+sptere Anforderung fehl, so wird fr die aktuelle die nchste Option
+probiert ("backtracking"). Bei einer Handvoll Anforderungen mit je hchstens
+zwei Optionen sind das nur wenige Versuche. */
+static int claim_from(const uint8_t *reqs, dma_stream_t *s, uint8_t n,
+                      uint8_t k)
+{
+    const dma_option_t *o;
+    uint32_t i;
+
+    if (k == n)
+        return 1;
+
+    for (o = options; o < options + OPTIONS; ++o) {
+        i = (o->ctrl - 1) * 8 + o->stream;
+        if (o->req != reqs[k] || owner[i])
+            continue;
+
+        assign(o, &s[k]);
+        if (claim_from(reqs, s, n, k + 1))
+            return 1;
+        unassign(&s[k]);
+    }
+
+    return 0;
+}
+
+
+/* Prft, ob ein burst von Datenbreite size zur FIFO-Schwelle fifo passt:
+Die Schwelle (4, 8, 12 oder 16 Byte) muss ein Vielfaches des bursts sein. */
+static int burst_fits(uint8_t size, uint8_t burst, uint8_t fifo)
+{
+    uint32_t bytes = (uint32_t)beats[burst] << size;
+    uint32_t level = (fifo + 1) * 4;
+
+    if (burst == DMA_BURST_1)
+        return 1;
+
+    return bytes <= level && level % bytes == 0;
+}
+
+
+static void dispatch(uint32_t i)
+{
+    dma_stream_t *s = owner[i];
+
+    if (s && s->fn) {
+        s->fn(s);
+    } else {
+        // niemand zustndig: Flags lschen, sonst kommt der Interrupt sofort wieder
+        if ((i & 7) < 4)
+            ((i < 8) ? DMA1 : DMA2)->LIFCR = DMA_FLAG_ALL << flagShift[i & 3];
+        else
+            ((i < 8) ? DMA1 : DMA2)->HIFCR = DMA_FLAG_ALL << flagShift[i & 3];
+    }
+}
+
+
+
+//----------------------------------------------------------------------------
+
+int dma_claim(uint8_t req, dma_stream_t *s)
+{
+    return dma_claim_set(&req, s, 1);
+}
+
+
+
+int dma_claim_set(const uint8_t *reqs, dma_stream_t *s, uint8_t n)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint8_t k;
+    int ok;
+
+    __disable_irq();
+    ok = claim_from(reqs, s, n, 0);
+    __set_PRIMASK(primask);
+
+    if (!ok)
+        return 0;
+
+    for (k = 0; k < n; ++k) {
+        // DMA1 ber Bit 21, DMA2 ber Bit 22 im RCC_AHB1ENR mit Takt versorgen
+        RCC->AHB1ENR |= (s[k].dma == DMA1) ? 0x00200000 : 0x00400000;
+
+        dma_disable(&s[k]);
+        dma_clear(&s[k], DMA_FLAG_ALL);
+
+        NVIC->ISER[s[k].irq >> 5] = 1UL << (s[k].irq & 31);
+    }
+
+    return 1;
+}
+
+
+
+void dma_release(dma_stream_t *s)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    NVIC->ICER[s->irq >> 5] = 1UL << (s->irq & 31);
+    dma_disable(s);
+    dma_clear(s, DMA_FLAG_ALL);
+
+    __disable_irq();
+    unassign(s);
+    __set_PRIMASK(primask);
+}
+
+
+
+void dma_disable(const dma_stream_t *s)
+{
+    s->stream->CR &= 0xFFFFFFFE;
+    while (s->stream->CR & 0x00000001);
+}
+
+
+
+uint32_t dma_flags(const dma_stream_t *s)
+{
+    uint32_t isr = (s->no < 4) ? s->dma->LISR : s->dma->HISR;
+
+    return (isr >> flagShift[s->no & 3]) & DMA_FLAG_ALL;
+}
+
+
+
+void dma_clear(const dma_stream_t *s, uint32_t flags)
+{
+    flags = (flags & DMA_FLAG_ALL) << flagShift[s->no & 3];
+
+    if (s->no < 4)
+        s->dma->LIFCR = flags;
+    else
+        s->dma->HIFCR = flags;
+}
+
+
+
+int dma_mode(const dma_stream_t *s, const dma_mode_t *m, uint32_t *cr)
+{
+    if (m->psize > DMA_SIZE_32 || m->msize > DMA_SIZE_32 ||
+        m->pburst > DMA_BURST_16 || m->mburst > DMA_BURST_16 ||
+        m->fifo > DMA_FIFO_DIRECT)
+        return 0;
+
+    if (m->fifo == DMA_FIFO_DIRECT) {
+        /* Ohne FIFO gibt es weder bursts noch packing, und Speicher-zu-
+           Speicher-Transfers sind nicht erlaubt. */
+        if (m->pburst != DMA_BURST_1 || m->mburst != DMA_BURST_1 ||
+            m->psize != m->msize || s->req == DMA_REQ_MEM2MEM)
+            return 0;
+
+        s->stream->FCR = 0x00000001;    // DMDIS = 0 (Reset-Wert 0x21)
+    } else {
+        /* [1] nennt die Regel im Abschnitt ber den FIFO fr die Speicher-
+           seite. Fr die Peripherieseite gilt dasselbe, da auch sie aus
+           dem FIFO bedient wird. */
+        if (!burst_fits(m->psize, m->pburst, m->fifo) ||
+            !burst_fits(m->msize, m->mburst, m->fifo))
+            return 0;
+
+        s->stream->FCR = 0x00000004 | m->fifo;      // DMDIS, FTH
+    }
+
+    *cr = ((uint32_t)m->psize  << 11) | ((uint32_t)m->msize  << 13) |
+          ((uint32_t)m->pburst << 21) | ((uint32_t)m->mburst << 23);
+
+    return 1;
+}
+
+
+
+uint32_t dma_used(void)
+{
+    uint32_t i, used = 0;
+
+    for (i = 0; i < 16; ++i)
+        if (owner[i])
+            used |= 1UL << i;
+
+    return used;
+}
+
+
+
+//----------------------------------------------------------------------------
+
+void DMA1_Stream0_IRQHandler(void) { dispatch(0); }
+void DMA1_Stream1_IRQHandler(void) { dispatch(1); }
+void DMA1_Stream2_IRQHandler(void) { dispatch(2); }
+void DMA1_Stream3_IRQHandler(void) { dispatch(3); }
+void DMA1_Stream4_IRQHandler(void) { dispatch(4); }
+void DMA1_Stream5_IRQHandler(void) { dispatch(5); }
+void DMA1_Stream6_IRQHandler(void) { dispatch(6); }
+void DMA1_Stream7_IRQHandler(void) { dispatch(7); }
+void DMA2_Stream0_IRQHandler(void) { dispatch(8); }
+void DMA2_Stream1_IRQHandler(void) { dispatch(9); }
+void DMA2_Stream2_IRQHandler(void) { dispatch(10); }
+void DMA2_Stream3_IRQHandler(void) { dispatch(11); }
+void DMA2_Stream4_IRQHandler(void) { dispatch(12); }
+void DMA2_Stream5_IRQHandler(void) { dispatch(13); }
+void DMA2_Stream6_IRQHandler(void) { dispatch(14); }
+void DMA2_Stream7_IRQHandler(void) { dispatch(15); }
@@ -0,0 +1,158 @@
+#ifndef DMA_H
+#define DMA_H
+
+/*
+ * In den Dateien dma.h und dma.c findet sich eine Verwaltung der 16 DMA-
+ * Streams (je 8 in DMA1 und DMA2). Welche Peripherie ber welchen Stream
+ * und Kanal DMA-Transfers anfordern kann, legen die Tabellen 20 und 21 in
+ * [1] fest. Viele Anforderungen ("requests") sind an zwei verschiedenen
+ * Streams zu haben, und viele Streams werden von mehreren Anforderungen
+ * gebraucht. Anstatt Streams und Kanle in jedem Treiber fest einzutragen,
+ * fragt ein Treiber hier nach der Anforderung, die er braucht (z.B.
+ * DMA_REQ_SPI1_RX), und erhlt einen freien, passenden Stream.
+ *
+ * Die Interruptroutinen aller 16 Streams liegen in dma.c und rufen die
+ * Funktion auf, die beim Belegen angegeben wurde.
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+// u.a. Definition der Hardwareregister des STM32F4
+#include "libfoo/stm32f4xx.h"
+
+/* Die Anforderungen (Auswahl aus den Tabellen 20 und 21 in [1]). Die
+Reihenfolge spielt keine Rolle. */
+#define DMA_REQ_MEM2MEM     0       // nur DMA2, beliebiger Stream
+#define DMA_REQ_SPI1_RX     1
+#define DMA_REQ_SPI1_TX     2
+#define DMA_REQ_SPI2_RX     3
+#define DMA_REQ_SPI2_TX     4
+#define DMA_REQ_SPI3_RX     5
+#define DMA_REQ_SPI3_TX     6
+#define DMA_REQ_I2C1_RX     7
+#define DMA_REQ_I2C1_TX     8
+#define DMA_REQ_USART1_RX   9
+#define DMA_REQ_USART1_TX   10
+#define DMA_REQ_USART2_RX   11
+#define DMA_REQ_USART2_TX   12
+#define DMA_REQ_USART3_RX   13
+#define DMA_REQ_USART3_TX   14
+#define DMA_REQ_TIM2_UP     15
+#define DMA_REQ_TIM3_CH1    16
+#define DMA_REQ_TIM3_CH2    17
+#define DMA_REQ_TIM3_CH3    18
+#define DMA_REQ_TIM3_CH4    19
+#define DMA_REQ_TIM4_CH1    20
+#define DMA_REQ_TIM4_CH2    21
+#define DMA_REQ_TIM4_CH3    22
+#define DMA_REQ_TIM4_UP     23
+#define DMA_REQ_DAC1        24
+#define DMA_REQ_DAC2        25
+#define DMA_REQ_ADC1        26
+#define DMA_REQ_TIM3_UP     27
+
+/* Flags eines Streams, wie sie dma_flags() liefert. Die Bits entsprechen
+denen eines Streams im LISR/HISR (ohne Verschiebung). */
+#define DMA_FLAG_FE   0x01      // FIFO error
+#define DMA_FLAG_DME  0x04      // direct mode error
+#define DMA_FLAG_TE   0x08      // transfer error
+#define DMA_FLAG_HT   0x10      // half transfer
+#define DMA_FLAG_TC   0x20      // transfer complete
+#define DMA_FLAG_ALL  0x3D
+
+/* Datenbreite auf Peripherie- bzw. Speicherseite (PSIZE, MSIZE). */
+#define DMA_SIZE_8      0
+#define DMA_SIZE_16     1
+#define DMA_SIZE_32     2
+
+/* Anzahl der beats eines bursts (PBURST, MBURST). */
+#define DMA_BURST_1     0       // einzelne Zugriffe
+#define DMA_BURST_4     1
+#define DMA_BURST_8     2
+#define DMA_BURST_16    3
+
+/* Fllstand des FIFOs (4 Worte), ab dem bertragen wird (FTH), oder direct
+mode ganz ohne FIFO. */
+#define DMA_FIFO_1_4    0
+#define DMA_FIFO_1_2    1
+#define DMA_FIFO_3_4    2
+#define DMA_FIFO_FULL   3
+#define DMA_FIFO_DIRECT 4
+
+/* Art der Zugriffe eines Streams, s. dma_mode(). */
+typedef struct
+{
+    uint8_t psize;      // DMA_SIZE_...
+    uint8_t pburst;     // DMA_BURST_...
+    uint8_t msize;      // DMA_SIZE_...
+    uint8_t mburst;     // DMA_BURST_...
+    uint8_t fifo;       // DMA_FIFO_...
+} dma_mode_t;
+
+struct dma_stream;
+typedef void (*dma_irq_fn)(struct dma_stream *s);
+
+/* Ein belegter Stream. Der Speicher gehrt dem Aufrufer, die Felder ab dma
+werden von dma_claim() gesetzt. */
+typedef struct dma_stream
+{
+    dma_irq_fn          fn;         // Interruptroutine (oder 0)
+    void               *arg;        // zur freien Verwendung durch fn
+
+    DMA_TypeDef        *dma;        // DMA1 oder DMA2
+    DMA_Stream_TypeDef *stream;     // z.B. DMA2_Stream0
+    uint8_t             no;         // Nummer des Streams (0 bis 7)
+    uint8_t             req;        // DMA_REQ_...
+    uint8_t             irq;        // Interrupt Nummer (Tabelle 30 in [1])
+    uint32_t            chsel;      // CHSEL-Bits (25 bis 27) fr DMA_SxCR
+} dma_stream_t;
+
+/* Belegt einen freien Stream fr die Anforderung req, versorgt den DMA-
+Controller mit Takt und schaltet den Interrupt des Streams frei. Die Felder
+fn und arg werden vorher vom Aufrufer gesetzt. Liefert 0, falls alle
+passenden Streams belegt sind. */
+int dma_claim(uint8_t req, dma_stream_t *s);
+
+/* Belegt Streams fr n Anforderungen auf einmal. Kommen fr eine Anforderung
+mehrere Streams in Frage, so werden alle Kombinationen durchprobiert, bis
+eine ohne Konflikt gefunden ist. Entweder werden alle n Streams belegt
+(Ergebnis 1) oder keiner (Ergebnis 0). */
+int dma_claim_set(const uint8_t *reqs, dma_stream_t *s, uint8_t n);
+
+/* Hlt den Stream an und gibt ihn wieder frei. */
+void dma_release(dma_stream_t *s);
+
+/* Schaltet den Stream ab (EN = 0) und wartet, bis ein laufender Transfer
+beendet ist. Danach drfen alle Register des Streams gendert werden. */
+void dma_disable(const dma_stream_t *s);
+
+/* Liefert die Flags des Streams (DMA_FLAG_...). */
+uint32_t dma_flags(const dma_stream_t *s);
+
+/* Lscht die angegebenen Flags des Streams (DMA_FLAG_...). */
+void dma_clear(const dma_stream_t *s, uint32_t flags);
+
+/* Stellt den FIFO des (abgeschalteten) Streams ein und liefert in *cr die
+Bits PSIZE, MSIZE, PBURST und MBURST fr DMA_SxCR. Der Aufrufer ergnzt CR
+um Richtung, Inkremente usw.
+
+Im direct mode wird jede Anforderung sofort mit einem einzelnen Zugriff
+erledigt. Mit FIFO kann die Speicherseite in bursts und mit anderer
+Datenbreite als die Peripherie arbeiten ("packing", z.B. 4 Bytes eines
+8-Bit Peripherieregisters als ein Wort in den Speicher). Ein burst muss
+dabei in die FIFO-Schwelle passen und diese genau aufteilen (s. den
+Abschnitt ber den FIFO in [1]), sonst liefert die Funktion 0. Weitere
+Regeln prft sie nicht: NDTR (in Einheiten von PSIZE) muss bei packing ein
+Vielfaches von MSIZE / PSIZE sein, und ein burst darf keine 1KB-Grenze
+berschreiten. */
+int dma_mode(const dma_stream_t *s, const dma_mode_t *m, uint32_t *cr);
+
+/* Liefert eine Bitmaske der belegten Streams: Bit 0 bis 7 fr DMA1, Bit 8
+bis 15 fr DMA2. */
+uint32_t dma_used(void);
+
+#endif
@@ -0,0 +1,426 @@
+/*
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+*/
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "dma_copy.h"
+#include "dma.h"
+#include "power.h"
+#include "nolibcall.h"
+
+
+/* Der CCM-Speicher (0x10000000, 64KB) hngt nur am D-Bus des Prozessors, der
+DMA-Controller kommt dort nicht hin (Abbildung 1 in [1]). */
+#define IN_CCM(a)   (((uint32_t)(a) & 0xFFFF0000) == 0x10000000)
+
+/* Grter Teil eines Auftrags pro DMA-Transfer: NDTR zhlt in Einheiten von
+PSIZE und hat nur 16 Bit. 0xFFF0 hlt die Teile durch 16 teilbar. */
+#define SEG_MAX_UNITS   0xFFF0
+
+volatile dma_copy_stats_t dma_copy_stats;
+
+uint32_t dma_copy_threshold = DMA_COPY_THRESHOLD;
+
+static dma_stream_t dma;
+
+// Warteschlange wie in spi_bus.c
+static dma_copy_t        *pending;
+static dma_copy_t        *queue;
+static dma_copy_t        *active;
+static volatile uint32_t  busy;
+
+// der noch offene Teil des aktiven Auftrags
+static uint32_t segDst;
+static uint32_t segSrc;
+static uint32_t segLeft;    // in Byte
+static uint32_t segSize;    // PSIZE in Byte
+static uint32_t segCr;
+
+/* Die Schreibseite arbeitet immer in bursts von 4 Worten aus dem vollen FIFO,
+die Leseseite je nach Ausrichtung der Quelle (s. start_job()). */
+static const dma_mode_t modeBurst  = {
+    DMA_SIZE_32, DMA_BURST_4, DMA_SIZE_32, DMA_BURST_4, DMA_FIFO_FULL
+};
+static const dma_mode_t modeWord   = {
+    DMA_SIZE_32, DMA_BURST_1, DMA_SIZE_32, DMA_BURST_4, DMA_FIFO_FULL
+};
+static const dma_mode_t modePacked = {
+    DMA_SIZE_8,  DMA_BURST_1, DMA_SIZE_32, DMA_BURST_4, DMA_FIFO_FULL
+};
+
+
+
+/* Siehe spi_bus.c zu LDREX und STREX. */
+static void push_pending(dma_copy_t *x)
+{
+    volatile uint32_t *p = (volatile uint32_t*)&pending;
+
+    do {
+        x->next = (dma_copy_t*)__LDREXW(p);
+    } while (__STREXW((uint32_t)x, p));
+}
+
+static dma_copy_t *take_pending(void)
+{
+    volatile uint32_t *p = (volatile uint32_t*)&pending;
+    uint32_t list;
+
+    do {
+        list = __LDREXW(p);
+    } while (__STREXW(0, p));
+
+    return (dma_copy_t*)list;
+}
+
+// wie in spi_bus.c: kein Stop mode, solange der Stream arbeitet
+static int claim(void)
+{
+    do {
+        if (__LDREXW(&busy)) {
+            __CLREX();
+            return 0;
+        }
+    } while (__STREXW(1, &busy));
+
+    power_hold();
+
+    return 1;
+}
+
+static void release(void)
+{
+    busy = 0;
+    power_release();
+}
+
+
+/* Erledigt len Byte ab Position off eines Auftrags auf dem Prozessor. */
+static void cpu_part(dma_copy_t *x, uint32_t off, uint32_t len)
+{
+    if (!len)
+        return;
+
+    if (x->op == DMA_COPY_MEMSET)
+        dma_fill_cpu(x->dst + off, (uint8_t)x->fill, len);
+    else
+        dma_copy_cpu(x->dst + off, x->src + off, len);
+}
+
+
+static void finish(dma_copy_t *x, uint8_t state)
+{
+    ++dma_copy_stats.jobs;
+
+    x->state = state;
+    if (x->done)
+        x->done(x);
+}
+
+
+/* Startet den nchsten Teil des aktiven Auftrags. Nach einem abgeschlossenen
+Transfer lscht der DMA-Controller EN selbst, CR darf dann neu gesetzt
+werden. */
+static void start_segment(void)
+{
+    uint32_t n = segLeft;
+
+    if (n > SEG_MAX_UNITS * segSize)
+        n = SEG_MAX_UNITS * segSize;
+
+    dma_clear(&dma, DMA_FLAG_ALL);
+
+    // bei Speicher-zu-Speicher ist PAR die Quelle und M0AR das Ziel
+    dma.stream->PAR  = segSrc;
+    dma.stream->M0AR = segDst;
+    dma.stream->NDTR = n / segSize;
+    dma.stream->CR   = segCr;
+    dma.stream->CR  |= 0x00000001;
+
+    segDst  += n;
+    if (segCr & 0x00000200)
+        segSrc += n;
+    segLeft -= n;
+
+    ++dma_copy_stats.segments;
+    dma_copy_stats.bytes += n;
+}
+
+
+/* Beginnt einen Auftrag. Liefert 0, falls der Prozessor ihn bereits ganz
+erledigt hat, sonst 1.
+
+Der FIFO des Streams (4 Worte) sammelt die gelesenen Daten und schreibt sie
+in bursts von 4 Worten (MBURST = INCR4) ins Ziel. Ein burst darf keine
+1KB-Grenze berschreiten ("single and burst transfers" in [1]), das Ziel
+muss dafr auf 16 Byte ausgerichtet sein. Die Bytes bis dorthin und den Rest
+hinter dem letzten vollen burst kopiert der Prozessor. Auf der Quellseite
+hngt es von der Ausrichtung ab, wie gelesen wird (s. dma_mode()):
+
+    Quelle auf 16 Byte:   Worte in bursts von 4 (PBURST = INCR4)
+    Quelle auf 4 Byte:    einzelne Worte
+    sonst:                einzelne Bytes, der FIFO setzt daraus Worte
+                          zusammen ("packing")
+
+memset liest immer wieder dasselbe Wort x->fill (ohne PINC), der Auftrag
+darf dafr also nicht im CCM-Speicher liegen.
+
+Unabhngig von dma_copy_threshold bleibt ein Auftrag ganz beim Prozessor,
+wenn nach den Bytes bis zur Ausrichtung kein voller burst brig bleibt. */
+static int start_job(dma_copy_t *x)
+{
+    uint32_t d = (uint32_t)x->dst;
+    uint32_t s = (uint32_t)x->src;
+    uint32_t head, body, bits;
+    const dma_mode_t *m;
+
+    head = (0 - d) & 15;
+
+    if (x->len < dma_copy_threshold || x->len < head + 16 || IN_CCM(d) ||
+        (x->op == DMA_COPY_MEMCPY && IN_CCM(s)) ||
+        (x->op == DMA_COPY_MEMSET && IN_CCM(&x->fill))) {
+        cpu_part(x, 0, x->len);
+        ++dma_copy_stats.cpuJobs;
+        return 0;
+    }
+
+    body = (x->len - head) & 0xFFFFFFF0;
+
+    cpu_part(x, 0, head);
+    cpu_part(x, head + body, x->len - head - body);
+
+    if (x->op == DMA_COPY_MEMSET) {
+        m = &modeWord;
+        segSrc = (uint32_t)&x->fill;
+        segCr  = 0;
+    } else {
+        segSrc = s + head;
+        segCr  = 0x00000200;                    // PINC
+        if ((segSrc & 15) == 0)
+            m = &modeBurst;
+        else if ((segSrc & 3) == 0)
+            m = &modeWord;
+        else
+            m = &modePacked;
+    }
+
+    // MINC, Richtung Speicher-zu-Speicher, TCIE und TEIE
+    dma_mode(&dma, m, &bits);
+    segCr  |= dma.chsel | bits | 0x00000494;
+    segSize = 1 << m->psize;
+    segDst  = d + head;
+    segLeft = body;
+
+    start_segment();
+
+    return 1;
+}
+
+
+/* Startet den nchsten Auftrag, der den DMA-Controller braucht. Kleine
+Auftrge werden dabei gleich vom Prozessor erledigt. Darf nur vom Besitzer
+der Warteschlange aufgerufen werden. Liefert 0, falls nichts mehr luft. */
+static int start_next(void)
+{
+    dma_copy_t *x, *rev;
+
+    while (1) {
+        if (!queue) {
+            // den Stapel in die richtige (FIFO-)Reihenfolge bringen
+            rev = 0;
+            x = take_pending();
+            while (x) {
+                dma_copy_t *n = x->next;
+                x->next = rev;
+                rev = x;
+                x = n;
+            }
+            queue = rev;
+        }
+
+        x = queue;
+        if (!x)
+            return 0;
+        queue = x->next;
+
+        active = x;
+        if (start_job(x))
+            return 1;
+
+        active = 0;
+        finish(x, DMA_COPY_DONE);
+    }
+}
+
+static void kick(void)
+{
+    while (pending) {
+        if (!claim())
+            return;
+        if (start_next())
+            return;
+        release();
+    }
+}
+
+
+static void dma_copy_irq(dma_stream_t *s)
+{
+    dma_copy_t *x = active;
+    uint32_t flags = dma_flags(s);
+
+    dma_clear(s, DMA_FLAG_ALL);
+
+    if (flags & DMA_FLAG_TE) {
+        ++dma_copy_stats.errors;
+    } else if (segLeft) {
+        start_segment();
+        return;
+    }
+
+    // wie in spi_bus_irq(): erst weitermachen, dann benachrichtigen
+    active = 0;
+    if (!start_next()) {
+        release();
+        kick();
+    }
+
+    finish(x, (flags & DMA_FLAG_TE) ? DMA_COPY_ERROR : DMA_COPY_DONE);
+}
+
+
+
+//----------------------------------------------------------------------------
+
+void dma_copy_init(void)
+{
+    /* Irgendein Stream des DMA2 - dma.c nimmt zuerst einen, den keine der
+       bekannten Peripherien braucht. */
+    dma.fn = dma_copy_irq;
+    if (!dma_claim(DMA_REQ_MEM2MEM, &dma))
+        while (1);
+
+    pending = 0;
+    queue   = 0;
+    active  = 0;
+    busy    = 0;
+}
+
+
+
+void dma_copy_submit(dma_copy_t *x)
+{
+    x->state = DMA_COPY_QUEUED;
+    push_pending(x);
+    kick();
+}
+
+
+
+void dma_memcpy_async(dma_copy_t *x, void *dst, const void *src, uint32_t len,
+                      dma_copy_fn done)
+{
+    x->dst  = dst;
+    x->src  = src;
+    x->len  = len;
+    x->op   = DMA_COPY_MEMCPY;
+    x->done = done;
+    dma_copy_submit(x);
+}
+
+
+
+void dma_memset_async(dma_copy_t *x, void *dst, uint8_t value, uint32_t len,
+                      dma_copy_fn done)
+{
+    x->dst  = dst;
+    x->fill = value * 0x01010101UL;
+    x->len  = len;
+    x->op   = DMA_COPY_MEMSET;
+    x->done = done;
+    dma_copy_submit(x);
+}
+
+
+
+void dma_copy_wait(dma_copy_t *x)
+{
+    while (x->state == DMA_COPY_QUEUED);
+}
+
+
+
+//----------------------------------------------------------------------------
+
+/* Liegen Quelle und Ziel gleich zu einer Wortgrenze, so wird nach den ersten
+Bytes wortweise kopiert, 4 Worte pro Schleifendurchlauf. Sonst bleibt nur
+das Kopieren einzelner Bytes. */
+NO_LIBCALL void dma_copy_cpu(void *dst, const void *src, uint32_t len)
+{
+    uint8_t *d = dst;
+    const uint8_t *s = src;
+    uint32_t *dw;
+    const uint32_t *sw;
+
+    if ((((uint32_t)d ^ (uint32_t)s) & 3) == 0) {
+        while (((uint32_t)d & 3) && len) {
+            *d++ = *s++;
+            --len;
+        }
+
+        dw = (uint32_t*)d;
+        sw = (const uint32_t*)s;
+        while (len >= 16) {
+            dw[0] = sw[0];
+            dw[1] = sw[1];
+            dw[2] = sw[2];
+            dw[3] = sw[3];
+            dw  += 4;
+            sw  += 4;
+            len -= 16;
+        }
+        while (len >= 4) {
+            *dw++ = *sw++;
+            len  -= 4;
+        }
+        d = (uint8_t*)dw;
+        s = (const uint8_t*)sw;
+    }
+
+    while (len--)
+        *d++ = *s++;
+}
+
+
+
+NO_LIBCALL void dma_fill_cpu(void *dst, uint8_t value, uint32_t len)
+{
+    uint8_t *d = dst;
+    uint32_t *dw;
+    uint32_t w = value * 0x01010101UL;
+
+    while (((uint32_t)d & 3) && len) {
+        *d++ = value;
+        --len;
+    }
+
+    dw = (uint32_t*)d;
+    while (len >= 16) {
+        dw[0] = w;
+        dw[1] = w;
+        dw[2] = w;
+        dw[3] = w;
+        dw  += 4;
+        len -= 16;
+    }
+    while (len >= 4) {
+        *dw++ = w;
+        len  -= 4;
+    }
+    d = (uint8_t*)dw;
+
+    while (len--)
+        *d++ = value;
+}
@@ -0,0 +1,102 @@
+#ifndef DMA_COPY_H
+#define DMA_COPY_H
+
+/*
+ * In den Dateien dma_copy.h und dma_copy.c findet sich ein asynchrones
+ * memcpy/memset ber den DMA-Controller 2 (nur er kann Speicher-zu-Speicher
+ * Transfers). Ein Auftrag wird wie eine SPI-Transaktion (s. spi_bus.h) in
+ * eine Warteschlange gestellt und luft dann im Hintergrund, whrend der
+ * Prozessor weiterarbeitet. Das Ende wird ber das Feld state und/oder eine
+ * Rckruffunktion gemeldet.
+ *
+ * Der DMA-Controller ist nicht schneller als der Prozessor - im Gegenteil:
+ * Das Einrichten eines Transfers und der Interrupt am Ende kosten einige
+ * hundert Takte. Auftrge unter DMA_COPY_THRESHOLD Byte erledigt daher der
+ * Prozessor selbst (s. dma_copy_benchmark() in discovery_ex.c).
+ *
+ * Die Standardbibliothek wird nicht gelinkt (s. /DISCARD/ in stm32_flash.ld),
+ * dma_copy_cpu() und dma_fill_cpu() ersetzen daher memcpy und memset.
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+/* Auftrge unter dieser Gre (in Byte) fhrt der Prozessor aus, weil er
+damit fertig ist, bevor der DMA-Transfer berhaupt eingerichtet ist. Der
+Wert ist nur geschtzt und noch nicht gemessen - er sollte mit
+dma_copy_benchmark() auf dem Board ermittelt werden. Zur Laufzeit gilt
+dma_copy_threshold, das mit diesem Wert beginnt. */
+#define DMA_COPY_THRESHOLD  256
+
+// Art eines Auftrags
+#define DMA_COPY_MEMCPY     0
+#define DMA_COPY_MEMSET     1
+
+// Zustand eines Auftrags
+#define DMA_COPY_IDLE       0
+#define DMA_COPY_QUEUED     1
+#define DMA_COPY_DONE       2
+#define DMA_COPY_ERROR      3
+
+struct dma_copy;
+typedef void (*dma_copy_fn)(struct dma_copy *x);
+
+/* Ein Auftrag. Der Speicher gehrt dem Aufrufer und muss gltig bleiben,
+bis state den Wert DMA_COPY_DONE (oder DMA_COPY_ERROR) annimmt. Quelle und
+Ziel drfen sich nicht berlappen. */
+typedef struct dma_copy
+{
+    struct dma_copy *next;      // Verkettung in der Warteschlange
+
+    uint8_t         *dst;
+    const uint8_t   *src;       // nur DMA_COPY_MEMCPY
+    uint32_t         len;       // in Byte
+    uint32_t         fill;      // nur DMA_COPY_MEMSET: Byte in allen 4 Bytes
+    uint8_t          op;        // DMA_COPY_MEMCPY oder DMA_COPY_MEMSET
+
+    volatile uint8_t state;
+    dma_copy_fn      done;      // wird ggf. im Interrupt aufgerufen (oder 0)
+    void            *arg;       // zur freien Verwendung durch done
+} dma_copy_t;
+
+// Statistik, z.B. zur Betrachtung im Debugger
+typedef struct
+{
+    uint32_t jobs;      // abgeschlossene Auftrge
+    uint32_t cpuJobs;   // davon ganz vom Prozessor erledigt
+    uint32_t segments;  // DMA-Transfers (groe Auftrge werden geteilt)
+    uint32_t bytes;     // davon per DMA bertragene Bytes
+    uint32_t errors;    // Transferfehler
+} dma_copy_stats_t;
+
+extern volatile dma_copy_stats_t dma_copy_stats;
+
+extern uint32_t dma_copy_threshold;
+
+/* Belegt einen Stream des DMA2 (ber dma.c). */
+void dma_copy_init(void);
+
+/* Stellt einen Auftrag in die Warteschlange. Die Felder dst, src bzw. fill,
+len, op, done und arg werden vorher gesetzt. Die Auftrge werden in der
+Reihenfolge ihres Eintreffens bearbeitet. Die Funktion darf auch aus
+Interruptroutinen aufgerufen werden. */
+void dma_copy_submit(dma_copy_t *x);
+
+/* Bequeme Varianten von dma_copy_submit(). */
+void dma_memcpy_async(dma_copy_t *x, void *dst, const void *src, uint32_t len,
+                      dma_copy_fn done);
+void dma_memset_async(dma_copy_t *x, void *dst, uint8_t value, uint32_t len,
+                      dma_copy_fn done);
+
+/* Wartet auf das Ende eines Auftrags (s. spi_bus_transfer() zu den Grenzen
+in Interruptroutinen). */
+void dma_copy_wait(dma_copy_t *x);
+
+/* memcpy und memset auf dem Prozessor, wortweise wo mglich. */
+void dma_copy_cpu(void *dst, const void *src, uint32_t len);
+void dma_fill_cpu(void *dst, uint8_t value, uint32_t len);
+
+#endif
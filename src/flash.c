@@ -0,0 +1,213 @@
+/*
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+*/
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "flash.h"
+#include "swtimer.h"
+#include "sched.h"
+
+// u.a. Definition der Hardwareregister des STM32F4
+#include "libfoo/stm32f4xx.h"
+
+
+/* Fehlerbits in FLASH_SR: PGSERR, PGPERR, PGAERR und WRPERR (Bits 7 bis 4).
+Sie werden durch Schreiben einer 1 gelscht. */
+#define FLASH_ERRORS  0x000000F0
+
+// PSIZE = 10 (Bits 8 und 9): x32 parallelism
+#define FLASH_PSIZE   0x00000200
+
+/* Funktionen mit RAMFUNC landen im Abschnitt .ramfunc, den stm32_flash.ld
+in .data einsortiert. Der Startup-Code kopiert sie also zusammen mit den
+Variablen ins RAM. Der Sprung dorthin ist weiter als ein einfacher Aufruf
+(BL) reicht, daher long_call. */
+#define RAMFUNC  __attribute__((section(".ramfunc"), long_call, noinline))
+
+// fr flash_erase_async()
+static volatile uint32_t state;
+static swtimer_t         poll;
+static sched_task_t     *pollTask;
+static uint32_t          pollEvents;
+
+
+
+/* Nach dem Reset sind die Register FLASH_CR gesperrt (LOCK, Bit 31). Die
+Sperre wird durch zwei feste Schlsselwrter aufgehoben, die nacheinander
+nach FLASH_KEYR geschrieben werden. Jeder andere Wert sperrt FLASH_CR bis
+zum nchsten Reset. */
+static void unlock(void)
+{
+    if (FLASH->CR & 0x80000000) {
+        FLASH->KEYR = 0x45670123;
+        FLASH->KEYR = 0xCDEF89AB;
+    }
+}
+
+static void lock(void)
+{
+    FLASH->CR = 0x80000000;
+}
+
+/* Wartet, bis der Flash-Speicher nicht mehr beschftigt ist (BSY, Bit 16),
+und liefert die Fehlerbits. */
+static uint32_t wait(void)
+{
+    while (FLASH->SR & 0x00010000);
+
+    return FLASH->SR & FLASH_ERRORS;
+}
+
+/* Setzt die Caches des ART-Beschleunigers zurck: ICRST (Bit 11) und DCRST
+(Bit 12) wirken nur bei abgeschaltetem Cache (ICEN Bit 9, DCEN Bit 10).
+Danach wird der vorherige Zustand wiederhergestellt - waren die Caches aus,
+so bleiben sie es. */
+static void cache_reset(void)
+{
+    uint32_t acr = FLASH->ACR & ~0x00001800;
+
+    FLASH->ACR = acr & ~0x00000600;
+    FLASH->ACR = (acr & ~0x00000600) | 0x00001800;
+    FLASH->ACR = acr & ~0x00000600;
+    FLASH->ACR = acr;
+}
+
+
+/* Die eigentliche Schleife beim Programmieren (im RAM, s. flash.h). Solange
+PG gesetzt ist, wird jeder Schreibzugriff auf den Flash-Speicher zu einem
+Programmiervorgang. Die Quelle darf auch im Flash liegen: Gelesen wird erst,
+wenn das vorherige Wort fertig ist. */
+RAMFUNC static uint32_t program_loop(volatile uint32_t *dst,
+                                     const uint32_t *src, uint32_t words)
+{
+    uint32_t err = 0;
+
+    while (words-- && !err) {
+        *dst++ = *src++;
+        while (FLASH->SR & 0x00010000);
+        err = FLASH->SR & FLASH_ERRORS;
+    }
+
+    return err;
+}
+
+
+// Beginnt das Lschen, ohne auf das Ende zu warten
+static void start_erase(uint32_t sector)
+{
+    unlock();
+    wait();
+    FLASH->SR = FLASH_ERRORS;
+
+    // SER (Bit 1), Sektornummer SNB in den Bits 3 bis 6, dann STRT (Bit 16)
+    FLASH->CR = FLASH_PSIZE | (sector << 3) | 0x00000002;
+    FLASH->CR |= 0x00010000;
+}
+
+
+// Software-Timer von flash_erase_async()
+static void poll_expired(swtimer_t *t)
+{
+    if (FLASH->SR & 0x00010000) {
+        swtimer_start(t, FLASH_POLL_US);
+        return;
+    }
+
+    lock();
+    cache_reset();
+    state = (FLASH->SR & FLASH_ERRORS) ? FLASH_ERROR : FLASH_DONE;
+
+    if (pollTask)
+        sched_post(pollTask, pollEvents);
+}
+
+
+
+//----------------------------------------------------------------------------
+
+uint32_t flash_sector_addr(uint32_t sector)
+{
+    if (sector < 4)
+        return 0x08000000 + sector * 0x4000;
+    if (sector == 4)
+        return 0x08010000;
+    return 0x08020000 + (sector - 5) * 0x20000;
+}
+
+
+
+uint32_t flash_sector_size(uint32_t sector)
+{
+    if (sector < 4)
+        return 0x4000;
+    if (sector == 4)
+        return 0x10000;
+    return 0x20000;
+}
+
+
+
+int flash_erase(uint32_t sector)
+{
+    uint32_t err;
+
+    if (sector >= FLASH_SECTORS || state == FLASH_BUSY)
+        return 0;
+
+    start_erase(sector);
+    err = wait();
+    lock();
+    cache_reset();
+
+    return !err;
+}
+
+
+
+int flash_program(uint32_t addr, const uint32_t *data, uint32_t words)
+{
+    uint32_t err;
+
+    if ((addr & 3) || state == FLASH_BUSY)
+        return 0;
+
+    unlock();
+    wait();
+    FLASH->SR = FLASH_ERRORS;
+    FLASH->CR = FLASH_PSIZE | 0x00000001;
+
+    err = program_loop((volatile uint32_t*)addr, data, words);
+
+    lock();
+    cache_reset();
+
+    return !err;
+}
+
+
+
+int flash_erase_async(uint32_t sector, sched_task_t *t, uint32_t events)
+{
+    if (sector >= FLASH_SECTORS || state == FLASH_BUSY)
+        return 0;
+
+    pollTask   = t;
+    pollEvents = events;
+    poll.fn    = poll_expired;
+    state      = FLASH_BUSY;
+
+    start_erase(sector);
+    swtimer_start(&poll, FLASH_POLL_US);
+
+    return 1;
+}
+
+
+
+uint32_t flash_state(void)
+{
+    return state;
+}
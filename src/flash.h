@@ -0,0 +1,84 @@
+#ifndef FLASH_H
+#define FLASH_H
+
+/*
+ * In den Dateien flash.h und flash.c finden sich Funktionen zum Lschen und
+ * Beschreiben des internen Flash-Speichers (ab 0x08000000, 1MB). Der
+ * Speicher ist in 12 Sektoren unterschiedlicher Gre eingeteilt (Tabelle 5
+ * in [1]):
+ *
+ *     Sektor 0 bis 3:    je  16KB ab 0x08000000
+ *     Sektor 4:              64KB ab 0x08010000
+ *     Sektor 5 bis 11:   je 128KB ab 0x08020000
+ *
+ * Gelscht wird immer ein ganzer Sektor, danach sind alle Bits 1. Beim
+ * Programmieren knnen Bits nur von 1 auf 0 gesetzt werden - ein Wort, das
+ * schon einmal beschrieben wurde, lsst sich bis zum nchsten Lschen also
+ * nicht mehr beliebig ndern. Programmiert wird hier immer in ganzen 32-Bit
+ * Worten ("x32 parallelism"), was bei der Versorgungsspannung des discovery
+ * boards (3V) erlaubt ist.
+ *
+ * Whrend des Lschens (je nach Sektor 0,5 bis 2 Sekunden) und Program-
+ * mierens hlt jeder Zugriff auf den Flash-Speicher an, also auch das Holen
+ * von Befehlen. Der STM32F407 hat nur eine Bank, es gibt also keinen
+ * Bereich, aus dem whrenddessen weiter gelesen werden knnte. Die Schleife,
+ * die beim Programmieren Wort fr Wort schreibt und auf das Ende wartet,
+ * liegt daher im RAM (Abschnitt .ramfunc, s. stm32_flash.ld): Sie muss
+ * keine Befehle aus dem Flash holen und schreibt das nchste Wort, sobald
+ * das vorherige fertig ist.
+ *
+ * Fr das lange Lschen gibt es zustzlich flash_erase_async(): Statt zu
+ * warten, kehrt die Funktion sofort zurck, und ein Software-Timer fragt
+ * FLASH_SR in Abstnden ab. Der Prozessor bleibt zwar trotzdem stehen,
+ * sobald er Befehle aus dem Flash braucht - aber er kann z.B. im Scheduler
+ * mit WFI schlafen, statt zu warten, und die DMA-Controller arbeiten mit
+ * Daten aus dem RAM ungestrt weiter (z.B. uart.c).
+ *
+ * Die Caches des ART-Beschleunigers (s. FLASH_ACR) knnen nach dem Lschen
+ * und Programmieren noch alte Inhalte enthalten. Sie werden daher danach
+ * immer zurckgesetzt.
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "sched.h"
+
+#define FLASH_SECTORS  12
+
+// Abstand der Abfragen von FLASH_SR bei flash_erase_async()
+#define FLASH_POLL_US  SWTIMER_MS(10)
+
+// Zustand von flash_erase_async()
+#define FLASH_IDLE     0
+#define FLASH_BUSY     1
+#define FLASH_DONE     2
+#define FLASH_ERROR    3
+
+/* Liefert die Anfangsadresse und die Gre eines Sektors. */
+uint32_t flash_sector_addr(uint32_t sector);
+uint32_t flash_sector_size(uint32_t sector);
+
+/* Lscht einen Sektor. Liefert 0 bei einem Fehler (z.B. Schreibschutz)
+oder solange flash_erase_async() luft. */
+int flash_erase(uint32_t sector);
+
+/* Schreibt words 32-Bit Worte ab der Adresse addr (auf 4 Byte ausge-
+richtet). Liefert 0 bei einem Fehler oder solange flash_erase_async()
+luft. */
+int flash_program(uint32_t addr, const uint32_t *data, uint32_t words);
+
+/* Startet das Lschen eines Sektors und kehrt sofort zurck. Ist es be-
+endet, so erhlt die Aufgabe t (falls nicht 0) das Ereignis events. Der
+Scheduler muss initialisiert sein (sched_init()). Liefert 0, falls das
+Lschen nicht gestartet werden konnte. */
+int flash_erase_async(uint32_t sector, sched_task_t *t, uint32_t events);
+
+/* Liefert den Zustand von flash_erase_async(): FLASH_BUSY, solange gelscht
+wird, danach FLASH_DONE bzw. FLASH_ERROR. */
+uint32_t flash_state(void);
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef GAMMA_LUT_H
+#define GAMMA_LUT_H
+
+/*
+ * Erzeugt von tools/gamma_gen.c (gamma = 2.20) - nicht von Hand ndern!
+ * 1024 Helligkeitsstufen, PWM-Werte im Format 16.4 (0 bis 0xFFFF0).
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+static const uint32_t gammaLut[1024] = {
+    0x00000, 0x00000, 0x00001, 0x00003, 0x00005, 0x00009, 0x0000D, 0x00012,
+    0x00018, 0x0001F, 0x00028, 0x00031, 0x0003B, 0x00047, 0x00053, 0x00061,
+    0x00070, 0x00080, 0x00091, 0x000A3, 0x000B6, 0x000CB, 0x000E1, 0x000F8,
+    0x00110, 0x0012A, 0x00145, 0x00161, 0x0017E, 0x0019D, 0x001BD, 0x001DE,
+    0x00201, 0x00225, 0x0024A, 0x00271, 0x00299, 0x002C2, 0x002ED, 0x00319,
+    0x00346, 0x00375, 0x003A5, 0x003D7, 0x0040A, 0x0043E, 0x00474, 0x004AB,
+    0x004E4, 0x0051E, 0x0055A, 0x00597, 0x005D5, 0x00615, 0x00656, 0x00699,
+    0x006DD, 0x00723, 0x0076A, 0x007B3, 0x007FE, 0x00849, 0x00897, 0x008E5,
+    0x00936, 0x00987, 0x009DB, 0x00A30, 0x00A86, 0x00ADE, 0x00B37, 0x00B92,
+    0x00BEF, 0x00C4D, 0x00CAD, 0x00D0E, 0x00D71, 0x00DD5, 0x00E3B, 0x00EA3,
+    0x00F0C, 0x00F77, 0x00FE3, 0x01051, 0x010C0, 0x01131, 0x011A4, 0x01218,
+    0x0128E, 0x01306, 0x0137F, 0x013FA, 0x01476, 0x014F5, 0x01574, 0x015F6,
+    0x01679, 0x016FD, 0x01784, 0x0180C, 0x01895, 0x01920, 0x019AD, 0x01A3C,
+    0x01ACC, 0x01B5E, 0x01BF2, 0x01C87, 0x01D1E, 0x01DB7, 0x01E51, 0x01EED,
+    0x01F8B, 0x0202B, 0x020CC, 0x0216F, 0x02213, 0x022B9, 0x02361, 0x0240B,
+    0x024B7, 0x02564, 0x02613, 0x026C3, 0x02776, 0x0282A, 0x028E0, 0x02997,
+    0x02A51, 0x02B0C, 0x02BC8, 0x02C87, 0x02D47, 0x02E09, 0x02ECD, 0x02F93,
+    0x0305A, 0x03123, 0x031EE, 0x032BB, 0x03389, 0x03459, 0x0352B, 0x035FF,
+    0x036D5, 0x037AC, 0x03885, 0x03960, 0x03A3D, 0x03B1B, 0x03BFC, 0x03CDE,
+    0x03DC2, 0x03EA7, 0x03F8F, 0x04078, 0x04163, 0x04250, 0x0433F, 0x04430,
+    0x04522, 0x04617, 0x0470D, 0x04805, 0x048FE, 0x049FA, 0x04AF7, 0x04BF7,
+    0x04CF8, 0x04DFB, 0x04EFF, 0x05006, 0x0510F, 0x05219, 0x05325, 0x05433,
+    0x05543, 0x05655, 0x05768, 0x0587E, 0x05995, 0x05AAF, 0x05BCA, 0x05CE7,
+    0x05E05, 0x05F26, 0x06049, 0x0616D, 0x06294, 0x063BC, 0x064E6, 0x06612,
+    0x06740, 0x06870, 0x069A1, 0x06AD5, 0x06C0B, 0x06D42, 0x06E7B, 0x06FB7,
+    0x070F4, 0x07233, 0x07374, 0x074B6, 0x075FB, 0x07742, 0x0788A, 0x079D5,
+    0x07B21, 0x07C70, 0x07DC0, 0x07F12, 0x08066, 0x081BD, 0x08315, 0x0846E,
+    0x085CA, 0x08728, 0x08888, 0x089EA, 0x08B4D, 0x08CB3, 0x08E1A, 0x08F84,
+    0x090EF, 0x0925D, 0x093CC, 0x0953D, 0x096B1, 0x09826, 0x0999D, 0x09B16,
+    0x09C91, 0x09E0E, 0x09F8D, 0x0A10E, 0x0A291, 0x0A416, 0x0A59D, 0x0A726,
+    0x0A8B1, 0x0AA3E, 0x0ABCD, 0x0AD5D, 0x0AEF0, 0x0B085, 0x0B21C, 0x0B3B4,
+    0x0B54F, 0x0B6EC, 0x0B88B, 0x0BA2B, 0x0BBCE, 0x0BD73, 0x0BF1A, 0x0C0C2,
+    0x0C26D, 0x0C41A, 0x0C5C9, 0x0C779, 0x0C92C, 0x0CAE1, 0x0CC98, 0x0CE50,
+    0x0D00B, 0x0D1C8, 0x0D387, 0x0D548, 0x0D70B, 0x0D8D0, 0x0DA97, 0x0DC60,
+    0x0DE2B, 0x0DFF8, 0x0E1C7, 0x0E398, 0x0E56B, 0x0E740, 0x0E917, 0x0EAF1,
+    0x0ECCC, 0x0EEA9, 0x0F088, 0x0F26A, 0x0F44D, 0x0F633, 0x0F81A, 0x0FA04,
+    0x0FBF0, 0x0FDDD, 0x0FFCD, 0x101BF, 0x103B3, 0x105A9, 0x107A1, 0x1099B,
+    0x10B97, 0x10D95, 0x10F95, 0x11198, 0x1139C, 0x115A2, 0x117AB, 0x119B6,
+    0x11BC2, 0x11DD1, 0x11FE2, 0x121F5, 0x1240A, 0x12621, 0x1283A, 0x12A55,
+    0x12C72, 0x12E92, 0x130B3, 0x132D7, 0x134FC, 0x13724, 0x1394E, 0x13B7A,
+    0x13DA8, 0x13FD8, 0x1420A, 0x1443F, 0x14675, 0x148AE, 0x14AE8, 0x14D25,
+    0x14F64, 0x151A5, 0x153E8, 0x1562D, 0x15874, 0x15ABE, 0x15D09, 0x15F57,
+    0x161A6, 0x163F8, 0x1664C, 0x168A2, 0x16AFA, 0x16D55, 0x16FB1, 0x17210,
+    0x17470, 0x176D3, 0x17938, 0x17B9F, 0x17E09, 0x18074, 0x182E1, 0x18551,
+    0x187C3, 0x18A37, 0x18CAD, 0x18F25, 0x1919F, 0x1941C, 0x1969A, 0x1991B,
+    0x19B9E, 0x19E23, 0x1A0AA, 0x1A333, 0x1A5BF, 0x1A84C, 0x1AADC, 0x1AD6E,
+    0x1B002, 0x1B298, 0x1B531, 0x1B7CB, 0x1BA68, 0x1BD07, 0x1BFA8, 0x1C24B,
+    0x1C4F1, 0x1C798, 0x1CA42, 0x1CCEE, 0x1CF9C, 0x1D24C, 0x1D4FE, 0x1D7B3,
+    0x1DA69, 0x1DD22, 0x1DFDD, 0x1E29B, 0x1E55A, 0x1E81C, 0x1EADF, 0x1EDA5,
+    0x1F06E, 0x1F338, 0x1F604, 0x1F8D3, 0x1FBA4, 0x1FE77, 0x2014C, 0x20424,
+    0x206FD, 0x209D9, 0x20CB7, 0x20F97, 0x2127A, 0x2155F, 0x21845, 0x21B2E,
+    0x21E1A, 0x22107, 0x223F7, 0x226E8, 0x229DC, 0x22CD3, 0x22FCB, 0x232C6,
+    0x235C3, 0x238C2, 0x23BC3, 0x23EC6, 0x241CC, 0x244D4, 0x247DE, 0x24AEA,
+    0x24DF9, 0x2510A, 0x2541D, 0x25732, 0x25A49, 0x25D63, 0x2607F, 0x2639D,
+    0x266BD, 0x269E0, 0x26D05, 0x2702C, 0x27355, 0x27680, 0x279AE, 0x27CDE,
+    0x28010, 0x28345, 0x2867B, 0x289B4, 0x28CEF, 0x2902D, 0x2936C, 0x296AE,
+    0x299F2, 0x29D38, 0x2A081, 0x2A3CC, 0x2A719, 0x2AA68, 0x2ADBA, 0x2B10D,
+    0x2B463, 0x2B7BC, 0x2BB16, 0x2BE73, 0x2C1D2, 0x2C533, 0x2C897, 0x2CBFD,
+    0x2CF65, 0x2D2CF, 0x2D63C, 0x2D9AA, 0x2DD1C, 0x2E08F, 0x2E405, 0x2E77C,
+    0x2EAF7, 0x2EE73, 0x2F1F2, 0x2F573, 0x2F8F6, 0x2FC7B, 0x30003, 0x3038D,
+    0x3071A, 0x30AA8, 0x30E39, 0x311CC, 0x31562, 0x318F9, 0x31C93, 0x3202F,
+    0x323CE, 0x3276F, 0x32B12, 0x32EB7, 0x3325F, 0x33609, 0x339B5, 0x33D64,
+    0x34114, 0x344C8, 0x3487D, 0x34C35, 0x34FEF, 0x353AB, 0x35769, 0x35B2A,
+    0x35EED, 0x362B3, 0x3667B, 0x36A45, 0x36E11, 0x371DF, 0x375B0, 0x37984,
+    0x37D59, 0x38131, 0x3850B, 0x388E8, 0x38CC6, 0x390A7, 0x3948B, 0x39870,
+    0x39C58, 0x3A043, 0x3A42F, 0x3A81E, 0x3AC0F, 0x3B003, 0x3B3F9, 0x3B7F1,
+    0x3BBEC, 0x3BFE8, 0x3C3E7, 0x3C7E9, 0x3CBED, 0x3CFF3, 0x3D3FB, 0x3D806,
+    0x3DC13, 0x3E022, 0x3E434, 0x3E848, 0x3EC5E, 0x3F077, 0x3F492, 0x3F8AF,
+    0x3FCCF, 0x400F1, 0x40515, 0x4093C, 0x40D65, 0x41190, 0x415BE, 0x419EE,
+    0x41E20, 0x42255, 0x4268C, 0x42AC6, 0x42F01, 0x4333F, 0x43780, 0x43BC2,
+    0x44007, 0x4444F, 0x44899, 0x44CE5, 0x45133, 0x45584, 0x459D7, 0x45E2D,
+    0x46285, 0x466DF, 0x46B3B, 0x46F9A, 0x473FC, 0x4785F, 0x47CC5, 0x4812D,
+    0x48598, 0x48A05, 0x48E75, 0x492E6, 0x4975B, 0x49BD1, 0x4A04A, 0x4A4C5,
+    0x4A943, 0x4ADC3, 0x4B245, 0x4B6CA, 0x4BB51, 0x4BFDA, 0x4C466, 0x4C8F4,
+    0x4CD84, 0x4D217, 0x4D6AD, 0x4DB44, 0x4DFDE, 0x4E47B, 0x4E919, 0x4EDBB,
+    0x4F25E, 0x4F704, 0x4FBAC, 0x50057, 0x50504, 0x509B3, 0x50E65, 0x51319,
+    0x517D0, 0x51C89, 0x52144, 0x52602, 0x52AC2, 0x52F84, 0x53449, 0x53910,
+    0x53DDA, 0x542A6, 0x54774, 0x54C45, 0x55118, 0x555EE, 0x55AC6, 0x55FA0,
+    0x5647D, 0x5695C, 0x56E3E, 0x57322, 0x57808, 0x57CF1, 0x581DC, 0x586CA,
+    0x58BBA, 0x590AC, 0x595A1, 0x59A98, 0x59F92, 0x5A48E, 0x5A98C, 0x5AE8D,
+    0x5B390, 0x5B896, 0x5BD9E, 0x5C2A8, 0x5C7B5, 0x5CCC4, 0x5D1D6, 0x5D6EA,
+    0x5DC01, 0x5E11A, 0x5E635, 0x5EB53, 0x5F073, 0x5F595, 0x5FABA, 0x5FFE2,
+    0x6050C, 0x60A38, 0x60F66, 0x61498, 0x619CB, 0x61F01, 0x62439, 0x62974,
+    0x62EB1, 0x633F1, 0x63933, 0x63E78, 0x643BF, 0x64908, 0x64E54, 0x653A2,
+    0x658F3, 0x65E46, 0x6639B, 0x668F3, 0x66E4D, 0x673AA, 0x6790A, 0x67E6B,
+    0x683CF, 0x68936, 0x68E9F, 0x6940A, 0x69978, 0x69EE9, 0x6A45B, 0x6A9D0,
+    0x6AF48, 0x6B4C2, 0x6BA3F, 0x6BFBE, 0x6C53F, 0x6CAC3, 0x6D049, 0x6D5D2,
+    0x6DB5D, 0x6E0EB, 0x6E67B, 0x6EC0E, 0x6F1A3, 0x6F73A, 0x6FCD4, 0x70270,
+    0x7080F, 0x70DB0, 0x71354, 0x718FA, 0x71EA3, 0x7244E, 0x729FC, 0x72FAC,
+    0x7355E, 0x73B13, 0x740CA, 0x74684, 0x74C41, 0x751FF, 0x757C1, 0x75D84,
+    0x7634B, 0x76913, 0x76EDE, 0x774AC, 0x77A7C, 0x7804E, 0x78623, 0x78BFB,
+    0x791D5, 0x797B1, 0x79D90, 0x7A371, 0x7A955, 0x7AF3B, 0x7B524, 0x7BB0F,
+    0x7C0FD, 0x7C6ED, 0x7CCE0, 0x7D2D5, 0x7D8CD, 0x7DEC7, 0x7E4C3, 0x7EAC3,
+    0x7F0C4, 0x7F6C8, 0x7FCCF, 0x802D8, 0x808E3, 0x80EF1, 0x81501, 0x81B14,
+    0x8212A, 0x82742, 0x82D5C, 0x83379, 0x83998, 0x83FBA, 0x845DF, 0x84C05,
+    0x8522F, 0x8585B, 0x85E89, 0x864BA, 0x86AED, 0x87123, 0x8775B, 0x87D96,
+    0x883D3, 0x88A13, 0x89055, 0x8969A, 0x89CE1, 0x8A32B, 0x8A977, 0x8AFC6,
+    0x8B617, 0x8BC6B, 0x8C2C2, 0x8C91A, 0x8CF76, 0x8D5D3, 0x8DC34, 0x8E297,
+    0x8E8FC, 0x8EF64, 0x8F5CE, 0x8FC3B, 0x902AA, 0x9091C, 0x90F91, 0x91608,
+    0x91C81, 0x922FD, 0x9297B, 0x92FFC, 0x93680, 0x93D06, 0x9438E, 0x94A19,
+    0x950A7, 0x95737, 0x95DC9, 0x9645E, 0x96AF6, 0x97190, 0x9782D, 0x97ECC,
+    0x9856E, 0x98C12, 0x992B9, 0x99962, 0x9A00E, 0x9A6BC, 0x9AD6D, 0x9B420,
+    0x9BAD6, 0x9C18F, 0x9C84A, 0x9CF07, 0x9D5C7, 0x9DC8A, 0x9E34F, 0x9EA16,
+    0x9F0E1, 0x9F7AD, 0x9FE7C, 0xA054E, 0xA0C22, 0xA12F9, 0xA19D3, 0xA20AE,
+    0xA278D, 0xA2E6E, 0xA3551, 0xA3C37, 0xA4320, 0xA4A0B, 0xA50F9, 0xA57E9,
+    0xA5EDC, 0xA65D1, 0xA6CC9, 0xA73C3, 0xA7AC0, 0xA81C0, 0xA88C2, 0xA8FC6,
+    0xA96CD, 0xA9DD7, 0xAA4E3, 0xAABF2, 0xAB303, 0xABA17, 0xAC12D, 0xAC846,
+    0xACF62, 0xAD680, 0xADDA1, 0xAE4C4, 0xAEBEA, 0xAF312, 0xAFA3D, 0xB016A,
+    0xB089A, 0xB0FCC, 0xB1702, 0xB1E39, 0xB2573, 0xB2CB0, 0xB33EF, 0xB3B31,
+    0xB4276, 0xB49BD, 0xB5106, 0xB5852, 0xB5FA1, 0xB66F2, 0xB6E46, 0xB759C,
+    0xB7CF5, 0xB8451, 0xB8BAF, 0xB930F, 0xB9A73, 0xBA1D8, 0xBA941, 0xBB0AC,
+    0xBB819, 0xBBF89, 0xBC6FC, 0xBCE71, 0xBD5E9, 0xBDD63, 0xBE4E0, 0xBEC5F,
+    0xBF3E2, 0xBFB66, 0xC02ED, 0xC0A77, 0xC1204, 0xC1993, 0xC2124, 0xC28B8,
+    0xC304F, 0xC37E8, 0xC3F84, 0xC4722, 0xC4EC3, 0xC5667, 0xC5E0D, 0xC65B6,
+    0xC6D61, 0xC750F, 0xC7CC0, 0xC8473, 0xC8C29, 0xC93E1, 0xC9B9C, 0xCA359,
+    0xCAB19, 0xCB2DC, 0xCBAA1, 0xCC269, 0xCCA33, 0xCD200, 0xCD9D0, 0xCE1A2,
+    0xCE977, 0xCF14E, 0xCF928, 0xD0105, 0xD08E4, 0xD10C6, 0xD18AA, 0xD2091,
+    0xD287B, 0xD3067, 0xD3855, 0xD4047, 0xD483B, 0xD5031, 0xD582A, 0xD6026,
+    0xD6824, 0xD7025, 0xD7829, 0xD802F, 0xD8838, 0xD9043, 0xD9851, 0xDA062,
+    0xDA875, 0xDB08B, 0xDB8A3, 0xDC0BE, 0xDC8DC, 0xDD0FC, 0xDD91F, 0xDE144,
+    0xDE96C, 0xDF197, 0xDF9C4, 0xE01F4, 0xE0A27, 0xE125C, 0xE1A94, 0xE22CE,
+    0xE2B0B, 0xE334B, 0xE3B8D, 0xE43D2, 0xE4C19, 0xE5463, 0xE5CB0, 0xE64FF,
+    0xE6D51, 0xE75A6, 0xE7DFD, 0xE8656, 0xE8EB3, 0xE9712, 0xE9F74, 0xEA7D8,
+    0xEB03F, 0xEB8A8, 0xEC114, 0xEC983, 0xED1F5, 0xEDA69, 0xEE2DF, 0xEEB58,
+    0xEF3D4, 0xEFC53, 0xF04D4, 0xF0D58, 0xF15DE, 0xF1E67, 0xF26F3, 0xF2F81,
+    0xF3812, 0xF40A6, 0xF493C, 0xF51D5, 0xF5A70, 0xF630F, 0xF6BAF, 0xF7453,
+    0xF7CF9, 0xF85A1, 0xF8E4D, 0xF96FB, 0xF9FAB, 0xFA85E, 0xFB114, 0xFB9CD,
+    0xFC288, 0xFCB46, 0xFD406, 0xFDCC9, 0xFE58F, 0xFEE57, 0xFF722, 0xFFFF0
+};
+
+#endif
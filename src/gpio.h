@@ -0,0 +1,168 @@
+#ifndef GPIO_H
+#define GPIO_H
+
+/*
+ * In der Datei gpio.h finden sich Makros, mit denen die Konfiguration der
+ * GPIO-Pins beschrieben werden kann, ohne die Bitmasken fr die einzelnen
+ * Register (s. [1] ab S.148) von Hand auszurechnen. Alle Masken und Werte
+ * werden vom Compiler zur bersetzungszeit berechnet. Zur Laufzeit bleibt
+ * pro Register hchstens ein einziges Lesen-ndern-Schreiben brig - auch
+ * dann, wenn mehrere Pins eines Ports unterschiedlich konfiguriert werden.
+ * Am Ende der Datei finden sich zustzlich Makros, mit denen Ausgnge ber
+ * das BSRR-Register mit einem einzigen Schreibzugriff geschaltet werden.
+ *
+ * Die Makros greifen nur ber die Registernamen (MODER, OTYPER, ...) auf
+ * den Port zu. Sie funktionieren daher mit GPIO_TypeDef aus stm32f4xx.h
+ * genauso wie mit dem selbstgebauten GPIO_TDef aus discovery.c.
+ *
+ * Beispiel (PA5 und PA7 als AF5 Push-Pull, PA6 als AF5 Open-Drain):
+ *
+ *   GPIO_CONFIGURE2(GPIOA,
+ *       GPIO_PIN(5) | GPIO_PIN(7),
+ *           GPIO_MODE_AF | GPIO_PP | GPIO_2MHZ | GPIO_NOPULL | GPIO_AF(5),
+ *       GPIO_PIN(6),
+ *           GPIO_MODE_AF | GPIO_OD | GPIO_2MHZ | GPIO_NOPULL | GPIO_AF(5));
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+// Bitmaske eines Pins, z.B. GPIO_PIN(12) = 0x1000
+#define GPIO_PIN(n)  (1UL << (n))
+
+
+/* Eine Pin-Konfiguration ist ein einzelner 16-Bit Wert, der aus den folgen-
+den Konstanten per "|" zusammengesetzt wird. Jedes Feld hat ein eigenes
+"gltig"-Bit. Fehlt ein Feld (z.B. die Geschwindigkeit bei einem Eingang,
+s. die "x"-Eintrge in Tabelle 14 in [1]), so wird das zugehrige Register
+nicht angefasst. */
+
+// MODER (Bits 0 und 1, gltig: Bit 2)
+#define GPIO_MODE_IN      0x0004
+#define GPIO_MODE_OUT     0x0005
+#define GPIO_MODE_AF      0x0006
+#define GPIO_MODE_ANALOG  0x0007
+
+// OTYPER (Bit 3, gltig: Bit 4)
+#define GPIO_PP           0x0010
+#define GPIO_OD           0x0018
+
+// OSPEEDR (Bits 5 und 6, gltig: Bit 7)
+#define GPIO_2MHZ         0x0080
+#define GPIO_25MHZ        0x00A0
+#define GPIO_50MHZ        0x00C0
+#define GPIO_100MHZ       0x00E0
+
+// PUPDR (Bits 8 und 9, gltig: Bit 10)
+#define GPIO_NOPULL       0x0400
+#define GPIO_PULLUP       0x0500
+#define GPIO_PULLDOWN     0x0600
+
+// AFR (Bits 11 bis 14, gltig: Bit 15)
+#define GPIO_AF(n)        (0x8000 | ((n) << 11))
+
+
+//------------------------------------------------------------------------
+// Hilfsmakros - werden normalerweise nicht direkt bentigt
+
+// Pins, fr die das Feld mit dem gltig-Bit v in cfg gesetzt ist
+#define GPIO__SEL(pins, cfg, v)  (((cfg) & (v)) ? (uint32_t)(pins) : 0UL)
+
+// Wert v (2 Bit) an die Stelle jedes Pins in pins schreiben
+#define GPIO__B2(p, i, v) (((p) & (1UL << (i))) ? ((uint32_t)(v) << (2 * (i))) : 0UL)
+#define GPIO__F2(p, v) ( \
+    GPIO__B2(p, 0, v)  | GPIO__B2(p, 1, v)  | GPIO__B2(p, 2, v)  | \
+    GPIO__B2(p, 3, v)  | GPIO__B2(p, 4, v)  | GPIO__B2(p, 5, v)  | \
+    GPIO__B2(p, 6, v)  | GPIO__B2(p, 7, v)  | GPIO__B2(p, 8, v)  | \
+    GPIO__B2(p, 9, v)  | GPIO__B2(p, 10, v) | GPIO__B2(p, 11, v) | \
+    GPIO__B2(p, 12, v) | GPIO__B2(p, 13, v) | GPIO__B2(p, 14, v) | \
+    GPIO__B2(p, 15, v))
+
+// Wert v (4 Bit) an die Stelle jedes Pins in pins schreiben, getrennt
+// nach AFR[0] (Pins 0 bis 7) und AFR[1] (Pins 8 bis 15)
+#define GPIO__B4(p, i, v) (((p) & (1UL << (i))) ? ((uint32_t)(v) << (4 * ((i) & 7))) : 0UL)
+#define GPIO__F4L(p, v) ( \
+    GPIO__B4(p, 0, v)  | GPIO__B4(p, 1, v)  | GPIO__B4(p, 2, v)  | \
+    GPIO__B4(p, 3, v)  | GPIO__B4(p, 4, v)  | GPIO__B4(p, 5, v)  | \
+    GPIO__B4(p, 6, v)  | GPIO__B4(p, 7, v))
+#define GPIO__F4H(p, v) ( \
+    GPIO__B4(p, 8, v)  | GPIO__B4(p, 9, v)  | GPIO__B4(p, 10, v) | \
+    GPIO__B4(p, 11, v) | GPIO__B4(p, 12, v) | GPIO__B4(p, 13, v) | \
+    GPIO__B4(p, 14, v) | GPIO__B4(p, 15, v))
+
+// Maske und Wert fr die einzelnen Register
+#define GPIO_MODER_MASK(p, c)    GPIO__F2(GPIO__SEL(p, c, 0x0004), 3)
+#define GPIO_MODER_VAL(p, c)     GPIO__F2(GPIO__SEL(p, c, 0x0004), (c) & 3)
+#define GPIO_OTYPER_MASK(p, c)   GPIO__SEL(p, c, 0x0010)
+#define GPIO_OTYPER_VAL(p, c)    (((c) & 0x0008) ? GPIO_OTYPER_MASK(p, c) : 0UL)
+#define GPIO_OSPEEDR_MASK(p, c)  GPIO__F2(GPIO__SEL(p, c, 0x0080), 3)
+#define GPIO_OSPEEDR_VAL(p, c)   GPIO__F2(GPIO__SEL(p, c, 0x0080), ((c) >> 5) & 3)
+#define GPIO_PUPDR_MASK(p, c)    GPIO__F2(GPIO__SEL(p, c, 0x0400), 3)
+#define GPIO_PUPDR_VAL(p, c)     GPIO__F2(GPIO__SEL(p, c, 0x0400), ((c) >> 8) & 3)
+#define GPIO_AFRL_MASK(p, c)     GPIO__F4L(GPIO__SEL(p, c, 0x8000), 15)
+#define GPIO_AFRL_VAL(p, c)      GPIO__F4L(GPIO__SEL(p, c, 0x8000), ((c) >> 11) & 15)
+#define GPIO_AFRH_MASK(p, c)     GPIO__F4H(GPIO__SEL(p, c, 0x8000), 15)
+#define GPIO_AFRH_VAL(p, c)      GPIO__F4H(GPIO__SEL(p, c, 0x8000), ((c) >> 11) & 15)
+
+/* Ein einzelnes Lesen-ndern-Schreiben eines Registers. Ist die Maske 0,
+so entfllt der Zugriff vollstndig (der Compiler entfernt den Zweig, da
+die Bedingung konstant ist). */
+#define GPIO_UPDATE(reg, mask, val) \
+    do { \
+        if (mask) \
+            (reg) = ((reg) & ~(uint32_t)(mask)) | (uint32_t)(val); \
+    } while (0)
+
+#define GPIO__REG(port, R, p1, c1, p2, c2, p3, c3, reg) \
+    GPIO_UPDATE((port)->reg, \
+        GPIO_##R##_MASK(p1, c1) | GPIO_##R##_MASK(p2, c2) | GPIO_##R##_MASK(p3, c3), \
+        GPIO_##R##_VAL(p1, c1)  | GPIO_##R##_VAL(p2, c2)  | GPIO_##R##_VAL(p3, c3))
+
+
+//------------------------------------------------------------------------
+
+/* Konfiguriert bis zu drei Gruppen von Pins eines Ports mit jeweils
+eigener Konfiguration. Pro Register wird hchstens einmal gelesen und
+einmal geschrieben. */
+#define GPIO_CONFIGURE3(port, p1, c1, p2, c2, p3, c3) \
+    do { \
+        GPIO__REG(port, MODER,   p1, c1, p2, c2, p3, c3, MODER);   \
+        GPIO__REG(port, OTYPER,  p1, c1, p2, c2, p3, c3, OTYPER);  \
+        GPIO__REG(port, OSPEEDR, p1, c1, p2, c2, p3, c3, OSPEEDR); \
+        GPIO__REG(port, PUPDR,   p1, c1, p2, c2, p3, c3, PUPDR);   \
+        GPIO__REG(port, AFRL,    p1, c1, p2, c2, p3, c3, AFR[0]);  \
+        GPIO__REG(port, AFRH,    p1, c1, p2, c2, p3, c3, AFR[1]);  \
+    } while (0)
+
+#define GPIO_CONFIGURE2(port, p1, c1, p2, c2) \
+    GPIO_CONFIGURE3(port, p1, c1, p2, c2, 0, 0)
+
+#define GPIO_CONFIGURE(port, pins, cfg) \
+    GPIO_CONFIGURE3(port, pins, cfg, 0, 0, 0, 0)
+
+
+//------------------------------------------------------------------------
+
+/* Das 32-Bit Register BSRR, das in den Structs als BSRRL (Bits 0 bis 15,
+setzen) und BSRRH (Bits 16 bis 31, lschen) aufgeteilt ist. Mit einem
+einzigen Schreibzugriff knnen damit Pins gleichzeitig ein- und ausgeschal-
+tet werden, ohne die brigen Pins des Ports zu beeinflussen. */
+#define GPIO_BSRR(port)  (*(volatile uint32_t*)&(port)->BSRRL)
+
+// Pins "set" einschalten und Pins "reset" ausschalten
+#define GPIO_WRITE(port, set, reset) \
+    (GPIO_BSRR(port) = ((uint32_t)(reset) << 16) | (uint32_t)(set))
+
+/* Pins umschalten. Im Gegensatz zu "ODR ^= pins" wird nur gelesen und
+einmal geschrieben. ndert eine Interruptroutine zwischendurch andere Pins
+des Ports, so geht deren nderung nicht verloren. */
+#define GPIO_TOGGLE(port, pins) \
+    do { \
+        uint32_t odr_ = (port)->ODR; \
+        GPIO_WRITE(port, ~odr_ & (pins), odr_ & (pins)); \
+    } while (0)
+
+#endif
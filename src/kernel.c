@@ -0,0 +1,380 @@
+/*
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+*/
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "kernel.h"
+#include "mpu.h"
+
+// u.a. Definition der Hardwareregister des STM32F4
+#include "libfoo/stm32f4xx.h"
+
+
+/* Floating-Point Context Control Register (Abschnitt 4.6.2 im "Cortex-M4
+Devices Generic User Guide"). Wie die Register der DWT (s. cycles.h) fehlt
+es in der lteren CMSIS-Datei core_cm4.h. Bit 31 = ASPEN, Bit 30 = LSPEN. */
+#define K_FPCCR  (*(volatile uint32_t*)0xE000EF34)
+
+// Interrupt Control and State Register, Bit 28 = PENDSVSET
+#define K_PENDSVSET  0x10000000
+
+
+/* Fr jede Prioritt gibt es eine Liste der bereiten Threads. Ist die Liste
+der Prioritt p nicht leer, so ist in readyMap Bit (31 - p) gesetzt. Wie im
+timing wheel aus swtimer.c liefert der Befehl CLZ damit in einem Schritt
+die hchste Prioritt mit einem bereiten Thread - unabhngig davon, wie
+viele Threads es gibt.
+
+Der laufende Thread ist immer der erste Eintrag in der Liste der hchsten
+Prioritt. Blockiert er, gengt es daher, diesen ersten Eintrag zu
+entfernen. */
+
+static k_thread_t *readyHead[K_PRIOS];
+static k_thread_t *readyTail[K_PRIOS];
+static uint32_t    readyMap;
+
+/* Der laufende und der als nchstes auszufhrende Thread. Beide werden in
+PendSV_Handler (s.u.) verwendet und drfen daher nicht static sein. */
+k_thread_t *k_current;
+k_thread_t *k_next;
+
+volatile k_stats_t k_stats;
+
+static k_thread_t idleThread;
+
+/* Der Stack-Vorrat liegt im CCM-RAM (s. Abschnitt .ccmram in
+stm32_flash.ld). Dort liegt auch der Stack fr die Interruptroutinen, der
+beim Start des Kernels vom Stack der Threads getrennt wird. */
+static uint64_t stackPool[K_STACK_POOL_SIZE / 8]
+    __attribute__((section(".ccmram"), aligned(MPU_GUARD_SIZE)));
+static uint64_t handlerStack[1024 / 8]
+    __attribute__((section(".ccmram")));
+
+
+
+static void ready_push(k_thread_t *t)
+{
+    t->next = 0;
+    if (readyHead[t->prio])
+        readyTail[t->prio]->next = t;
+    else
+        readyHead[t->prio] = t;
+    readyTail[t->prio] = t;
+    readyMap |= 0x80000000UL >> t->prio;
+}
+
+static void ready_pop(uint32_t prio)
+{
+    k_thread_t *t = readyHead[prio];
+
+    readyHead[prio] = t->next;
+    if (!readyHead[prio])
+        readyMap &= ~(0x80000000UL >> prio);
+}
+
+
+/* Bestimmt den bereiten Thread hchster Prioritt und lst ggf. einen
+Threadwechsel aus. Wird mit gesperrten Interrupts aufgerufen. Da PendSV die
+niedrigste Prioritt aller Interrupts hat, findet der Wechsel erst statt,
+wenn alle Interruptroutinen beendet sind und die Interrupts wieder frei-
+gegeben werden. */
+static void reschedule(void)
+{
+    k_thread_t *next = readyHead[__CLZ(readyMap)];
+
+    if (next != k_current) {
+        k_next = next;
+        SCB->ICSR = K_PENDSVSET;
+    }
+}
+
+
+/* Blockiert den laufenden Thread. Wird mit gesperrten Interrupts auf-
+gerufen, der Wechsel findet beim Freigeben statt. */
+static void block_self(void)
+{
+    k_current->state = K_BLOCKED;
+    ready_pop(k_current->prio);
+    reschedule();
+}
+
+static void wake(k_thread_t *t)
+{
+    t->state = K_READY;
+    ready_push(t);
+    reschedule();
+}
+
+
+// Hierhin kehrt ein Thread zurck, dessen Funktion endet
+static void thread_exit(void)
+{
+    __disable_irq();
+    k_current->state = K_DEAD;
+    ready_pop(k_current->prio);
+    reschedule();
+    __enable_irq();
+
+    while (1);
+}
+
+
+static void sleep_expired(swtimer_t *tm)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    wake((k_thread_t*)tm->arg);
+    __set_PRIMASK(primask);
+}
+
+
+
+//----------------------------------------------------------------------------
+
+/* Der Threadwechsel. Beim Eintritt in einen Interrupt sichert der Prozessor
+selbst r0-r3, r12, lr, pc und xPSR auf dem Stack des unterbrochenen Threads
+(PSP) und ldt in lr einen besonderen Rcksprungwert ("EXC_RETURN"). Es
+bleibt, r4-r11 und EXC_RETURN auf denselben Stack zu legen, den Stack-
+pointer im Thread zu speichern und das Ganze fr den nchsten Thread in
+umgekehrter Reihenfolge auszufhren. Der Rcksprung mit dem EXC_RETURN des
+neuen Threads stellt dann den Rest wieder her.
+
+Hat der unterbrochene Thread die FPU benutzt, so ist Bit 4 von EXC_RETURN
+gelscht, und der Prozessor hat auch Platz fr s0-s15 und FPSCR reserviert.
+Dank "lazy stacking" (ASPEN und LSPEN in FPCCR, s. k_start()) werden diese
+Register aber erst dann tatschlich geschrieben, wenn sie zum ersten Mal
+angefasst werden - also hier durch das Sichern von s16-s31. Threads ohne
+FPU-Nutzung kostet der Wechsel damit keinen einzigen zustzlichen Takt.
+
+Vor dem Laden des neuen Threads wird Region 6 der MPU auf den Guard am
+unteren Ende seines Stacks gestellt (s. mpu.h). Die beiden Werte fr RBAR
+und RASR liegen fertig im Thread und werden mit einem einzigen STM
+geschrieben. Die Register der MPU sind "strongly ordered", die nderung
+gilt daher ohne Barriere ab dem Rcksprung in den Thread. Mit abge-
+schalteter MPU bleiben die Werte wirkungslos.
+
+Die Funktion ist "naked": Der Compiler erzeugt weder Prolog noch Epilog,
+die Register gehren allein dem Assemblercode. */
+__attribute__((naked)) void PendSV_Handler(void)
+{
+    __asm volatile (
+        "   cpsid   i                   \n"
+        "   mrs     r0, psp             \n"
+        "   ldr     r3, =k_stats        \n"
+        "   ldr     r2, [r3, #0]        \n"     // k_stats.switches++
+        "   adds    r2, r2, #1          \n"
+        "   str     r2, [r3, #0]        \n"
+        "   tst     lr, #0x10           \n"     // FPU benutzt?
+        "   bne     1f                  \n"
+        "   vstmdb  r0!, {s16-s31}      \n"
+        "   ldr     r2, [r3, #4]        \n"     // k_stats.fpSwitches++
+        "   adds    r2, r2, #1          \n"
+        "   str     r2, [r3, #4]        \n"
+        "1: stmdb   r0!, {r4-r11, lr}   \n"
+        "   ldr     r1, =k_current      \n"
+        "   ldr     r2, [r1]            \n"
+        "   str     r0, [r2]            \n"     // k_current->sp = r0
+        "   ldr     r2, =k_next         \n"
+        "   ldr     r2, [r2]            \n"
+        "   str     r2, [r1]            \n"     // k_current = k_next
+        "   ldr     r3, =0xE000ED9C     \n"     // MPU->RBAR, dahinter RASR
+        "   ldrd    r0, r1, [r2, #4]    \n"     // k_next->guard
+        "   stmia   r3, {r0, r1}        \n"
+        "   ldr     r0, [r2]            \n"     // r0 = k_next->sp
+        "   ldmia   r0!, {r4-r11, lr}   \n"
+        "   tst     lr, #0x10           \n"
+        "   it      eq                  \n"
+        "   vldmiaeq r0!, {s16-s31}     \n"
+        "   msr     psp, r0             \n"
+        "   cpsie   i                   \n"
+        "   bx      lr                  \n"
+        "   .ltorg                      \n"     // Konstanten fr ldr r, =x
+    );
+}
+
+
+
+void k_init(void)
+{
+    uint32_t p;
+
+    for (p = 0; p < K_PRIOS; ++p) {
+        readyHead[p] = 0;
+        readyTail[p] = 0;
+    }
+    readyMap  = 0;
+    k_current = 0;
+    k_next    = 0;
+    k_stats.stackUsed = 0;
+
+    swtimer_init();
+}
+
+
+
+int k_thread_create(k_thread_t *t, k_entry_fn entry, void *arg,
+                    uint8_t prio, uint32_t stackSize)
+{
+    uint32_t *sp, primask;
+
+    if (prio >= K_PRIOS - 1)
+        prio = K_PRIOS - 2;
+
+    /* Der Stack muss auf 8 Byte ausgerichtet sein (AAPCS), sein Guard am
+       unteren Ende auf MPU_GUARD_SIZE. */
+    stackSize = (stackSize + MPU_GUARD_SIZE - 1) & ~(MPU_GUARD_SIZE - 1);
+    if (k_stats.stackUsed + stackSize > K_STACK_POOL_SIZE)
+        return 0;
+
+    t->stack     = (uint32_t*)((uint8_t*)stackPool + k_stats.stackUsed);
+    t->stackSize = stackSize;
+    k_stats.stackUsed += stackSize;
+    mpu_stack_guard(t->guard, t->stack);
+
+    /* Der neue Stack wird so vorbereitet, als wre der Thread gerade von
+       PendSV_Handler unterbrochen worden: oben der Teil, den der Prozessor
+       beim Interrupt selbst sichert, darunter r4-r11 und EXC_RETURN. */
+    sp = t->stack + stackSize / 4;
+    *--sp = 0x01000000;                 // xPSR: Thumb-Bit
+    *--sp = (uint32_t)entry;            // pc
+    *--sp = (uint32_t)thread_exit;      // lr
+    *--sp = 0;                          // r12
+    *--sp = 0;                          // r3
+    *--sp = 0;                          // r2
+    *--sp = 0;                          // r1
+    *--sp = (uint32_t)arg;              // r0
+    *--sp = 0xFFFFFFFD;                 // EXC_RETURN: Thread, PSP, ohne FPU
+    sp -= 8;                            // r4-r11 (beliebig)
+
+    t->sp    = sp;
+    t->prio  = prio;
+    t->state = K_READY;
+
+    t->timer.fn     = sleep_expired;
+    t->timer.arg    = t;
+    t->timer.period = 0;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    ready_push(t);
+    if (k_current)
+        reschedule();
+    __set_PRIMASK(primask);
+
+    return 1;
+}
+
+
+
+void k_start(void)
+{
+    /* PendSV erhlt die niedrigste Prioritt (SHP[10] gehrt zu Exception
+       14, s. Abschnitt 4.3.9 im "Cortex-M4 Devices Generic User Guide"). */
+    SCB->SHP[10] = 0xF0;
+
+    /* ASPEN und LSPEN sind nach einem Reset zwar schon gesetzt, wir ver-
+       lassen uns aber nicht darauf. */
+    K_FPCCR |= 0xC0000000;
+
+    __disable_irq();
+
+    /* Der Leerlauf-Thread luft auf dem bisherigen Hauptstack, dessen
+       Guard in Region 5 liegt (s. mpu_init()). */
+    idleThread.prio  = K_PRIOS - 1;
+    idleThread.state = K_READY;
+    mpu_stack_guard(idleThread.guard, 0);
+    ready_push(&idleThread);
+    k_current = &idleThread;
+
+    /* Bisher benutzen Programm und Interruptroutinen denselben Stack (MSP).
+       Ab jetzt luft der Aufrufer als Leerlauf-Thread auf dem Process Stack
+       Pointer (PSP, Bit 1 in CONTROL), der zunchst auf denselben Stack
+       zeigt. Die Interruptroutinen erhalten einen eigenen Stack. */
+    __set_PSP(__get_MSP());
+    __set_CONTROL(0x02);
+    __ISB();
+    __set_MSP((uint32_t)&handlerStack[sizeof(handlerStack) / 8]);
+
+    reschedule();
+    __enable_irq();
+
+    while (1)
+        __WFI();
+}
+
+
+
+k_thread_t *k_self(void)
+{
+    return k_current;
+}
+
+
+
+void k_sleep(uint32_t us)
+{
+    __disable_irq();
+    block_self();
+    swtimer_start(&k_current->timer, us);
+    __enable_irq();
+}
+
+
+
+void k_sem_init(k_sem_t *s, int32_t count)
+{
+    s->count   = count;
+    s->waiting = 0;
+}
+
+
+
+void k_sem_wait(k_sem_t *s)
+{
+    k_thread_t **pp;
+
+    __disable_irq();
+
+    if (s->count > 0) {
+        s->count--;
+        __enable_irq();
+        return;
+    }
+
+    // hinter allen wartenden Threads gleicher oder hherer Prioritt
+    pp = &s->waiting;
+    while (*pp && (*pp)->prio <= k_current->prio)
+        pp = &(*pp)->next;
+
+    block_self();
+    k_current->next = *pp;
+    *pp = k_current;
+
+    __enable_irq();
+}
+
+
+
+void k_sem_post(k_sem_t *s)
+{
+    uint32_t primask = __get_PRIMASK();
+    k_thread_t *t;
+
+    __disable_irq();
+
+    /* Wartet ein Thread, so erhlt er den Zhler direkt - count bleibt
+       unverndert. */
+    t = s->waiting;
+    if (t) {
+        s->waiting = t->next;
+        wake(t);
+    } else {
+        s->count++;
+    }
+
+    __set_PRIMASK(primask);
+}
@@ -0,0 +1,108 @@
+#ifndef KERNEL_H
+#define KERNEL_H
+
+/*
+ * In den Dateien kernel.h und kernel.c findet sich ein minimaler, premp-
+ * tiver Kernel: Mehrere Threads mit festen Prioritten teilen sich den
+ * Prozessor. Es luft immer der bereite Thread mit der hchsten Prioritt.
+ * Wird ein Thread hherer Prioritt bereit (z.B. weil eine Interruptroutine
+ * eine Semaphore freigibt), so wird der laufende Thread sofort unterbrochen.
+ *
+ * Im Gegensatz zum Scheduler aus sched.h hat jeder Thread einen eigenen
+ * Stack. Die Stacks werden aus einem Vorrat im CCM-RAM (64KB ab 0x10000000)
+ * vergeben, den nur der Prozessor selbst erreicht. Dadurch kommen sich
+ * Stackzugriffe und DMA-Transfers im SRAM nicht in die Quere. Umgekehrt
+ * bedeutet das: Puffer, die per DMA (z.B. mit spi_bus_transfer())
+ * bertragen werden, drfen keine lokalen Variablen eines Threads sein!
+ *
+ * Der eigentliche Threadwechsel findet in der Interruptroutine PendSV_Handler
+ * statt, deren Eintrag in der Vektortabelle aus startup_stm32f4xx.s bereits
+ * vorhanden ist.
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "swtimer.h"
+
+// Anzahl der Prioritten (0 = hchste, K_PRIOS - 1 = Leerlauf)
+#define K_PRIOS            32
+
+// Gre des Stack-Vorrats im CCM-RAM in Byte
+#define K_STACK_POOL_SIZE  (32 * 1024)
+
+// Zustnde eines Threads
+#define K_READY            0
+#define K_BLOCKED          1
+#define K_DEAD             2
+
+typedef void (*k_entry_fn)(void *arg);
+
+/* Ein Thread. Der Speicher gehrt dem Aufrufer, alle Felder werden von
+kernel.c verwaltet. Die Felder sp und guard mssen an erster Stelle
+stehen, da PendSV_Handler darauf zugreift. */
+typedef struct k_thread
+{
+    uint32_t         *sp;       // gesicherter Stackpointer
+    uint32_t          guard[2]; // Region 6 der MPU (s. mpu_stack_guard())
+    struct k_thread  *next;     // Verkettung (bereit oder wartend)
+    uint8_t           prio;
+    volatile uint8_t  state;
+    uint32_t         *stack;    // unteres Ende des Stacks
+    uint32_t          stackSize;
+    swtimer_t         timer;    // fr k_sleep()
+} k_thread_t;
+
+/* Eine zhlende Semaphore. */
+typedef struct
+{
+    volatile int32_t count;
+    k_thread_t      *waiting;   // nach Prioritt sortiert
+} k_sem_t;
+
+// Statistik, z.B. zur Betrachtung im Debugger
+typedef struct
+{
+    uint32_t switches;      // Threadwechsel
+    uint32_t fpSwitches;    // davon mit gesicherten FPU-Registern
+    uint32_t stackUsed;     // vergebene Bytes des Stack-Vorrats
+} k_stats_t;
+
+extern volatile k_stats_t k_stats;
+
+/* Initialisiert den Kernel und die Software-Timer (fr k_sleep()). */
+void k_init(void);
+
+/* Legt einen Thread an, der mit der Prioritt prio (0 bis K_PRIOS - 2)
+die Funktion entry(arg) ausfhrt. Der Stack (stackSize Byte) wird aus dem
+Vorrat im CCM-RAM genommen. Liefert 0, falls der Vorrat erschpft ist.
+Kehrt entry zurck, so endet der Thread. Die untersten MPU_GUARD_SIZE Byte
+des Stacks dienen als Guard (s. mpu.h) und sind nicht nutzbar. */
+int k_thread_create(k_thread_t *t, k_entry_fn entry, void *arg,
+                    uint8_t prio, uint32_t stackSize);
+
+/* Startet den Kernel. Der Aufrufer wird selbst zum Leerlauf-Thread mit der
+niedrigsten Prioritt und legt den Prozessor mit WFI schlafen, solange
+kein anderer Thread bereit ist. Kehrt nicht zurck. */
+void k_start(void);
+
+/* Liefert den laufenden Thread. */
+k_thread_t *k_self(void);
+
+/* Legt den laufenden Thread fr us Mikrosekunden schlafen. */
+void k_sleep(uint32_t us);
+
+void k_sem_init(k_sem_t *s, int32_t count);
+
+/* Wartet, bis die Semaphore grer als 0 ist, und zhlt sie herunter. Darf
+nur aus Threads aufgerufen werden. */
+void k_sem_wait(k_sem_t *s);
+
+/* Zhlt die Semaphore hoch bzw. weckt den wartenden Thread mit der
+hchsten Prioritt. Darf auch aus Interruptroutinen aufgerufen werden. */
+void k_sem_post(k_sem_t *s);
+
+#endif
@@ -0,0 +1,298 @@
+/*
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+*/
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "kvstore.h"
+#include "flash.h"
+#include "telemetry.h"
+#include "nolibcall.h"
+
+
+// Kennung am Anfang eines gltigen Sektors ("KVS1")
+#define KV_MAGIC    0x3153564B
+
+// Kennung und Generationsnummer
+#define KV_HEADER   8
+
+// ein gelschtes Flash-Wort
+#define KV_BLANK    0xFFFFFFFF
+
+volatile kv_stats_t kv_stats;
+
+static uint32_t active;         // Nummer des aktiven Sektors
+static uint32_t base;           // dessen Anfangsadresse
+static uint32_t size;           // und Gre
+static uint32_t writePos;       // Offset des nchsten freien Worts
+
+/* Offset des jngsten Datensatzes je Schlssel im aktiven Sektor, 0 falls
+es den Schlssel nicht gibt (dort steht die Kennung, also nie ein
+Datensatz). */
+static uint32_t slot[KV_KEYS];
+
+
+
+static uint32_t word_at(uint32_t addr)
+{
+    return *(const volatile uint32_t*)addr;
+}
+
+// Lnge eines Datensatzes mit len Byte Wert in Byte
+static uint32_t record_size(uint32_t len)
+{
+    return 4 + ((len + 3) & ~3UL) + 4;
+}
+
+/* Das letzte Wort eines Datensatzes: CRC-16 ber alle Bytes davor und deren
+Komplement. Es kann daher nie gleich einem gelschten Wort sein. */
+static uint32_t commit_word(const void *record, uint32_t n)
+{
+    uint16_t crc = telemetry_crc16(0xFFFF, record, n - 4);
+
+    return crc | ((uint32_t)(uint16_t)~crc << 16);
+}
+
+static void update_stats(void)
+{
+    uint32_t key, live = 0;
+
+    for (key = 1; key < KV_KEYS; ++key)
+        if (slot[key])
+            live += record_size(word_at(base + slot[key]) >> 16);
+
+    kv_stats.used = writePos;
+    kv_stats.live = live;
+}
+
+
+static void use_sector(uint32_t sector, uint32_t generation)
+{
+    active = sector;
+    base   = flash_sector_addr(sector);
+    size   = flash_sector_size(sector);
+    kv_stats.generation = generation;
+}
+
+/* Schreibt Generationsnummer und Kennung eines neuen Sektors - die Kennung
+zuletzt, erst dann gilt der Sektor als vollstndig. */
+static int write_header(uint32_t addr, uint32_t generation)
+{
+    uint32_t magic = KV_MAGIC;
+
+    return flash_program(addr + 4, &generation, 1) &&
+           flash_program(addr, &magic, 1);
+}
+
+
+/* Liest das Protokoll des aktiven Sektors und trgt den jngsten gltigen
+Datensatz jedes Schlssels in slot[] ein. */
+static void scan(void)
+{
+    uint32_t off = KV_HEADER;
+    uint32_t hdr, key, len, n;
+
+    for (key = 0; key < KV_KEYS; ++key)
+        slot[key] = 0;
+    kv_stats.corrupt = 0;
+
+    while (off + 8 <= size) {
+        hdr = word_at(base + off);
+        if (hdr == KV_BLANK)
+            break;
+
+        key = hdr & 0xFFFF;
+        len = hdr >> 16;
+        n   = record_size(len);
+
+        if (!key || key >= KV_KEYS || len > KV_VALUE_MAX || off + n > size) {
+            /* Der Kopf ist beschdigt, wo der nchste Datensatz beginnt, ist
+               also unbekannt. Der Rest des Sektors gilt als belegt, beim
+               nchsten kv_set() wird umkopiert. */
+            ++kv_stats.corrupt;
+            off = size;
+            break;
+        }
+
+        if (word_at(base + off + n - 4) == commit_word((void*)(base + off), n))
+            slot[key] = len ? off : 0;
+        else
+            ++kv_stats.corrupt;
+
+        off += n;
+    }
+
+    writePos = off;
+}
+
+
+/* Kopiert die gltigen Datenstze in den anderen Sektor, der danach der
+aktive ist. Liefert 0 bei einem Fehler - der bisherige Sektor bleibt dann
+aktiv. */
+static int compact(void)
+{
+    uint32_t target = active == KV_SECTOR_A ? KV_SECTOR_B : KV_SECTOR_A;
+    uint32_t addr   = flash_sector_addr(target);
+    uint32_t old    = active;
+    uint32_t zero   = 0;
+    uint32_t off, key, n;
+
+    if (!flash_erase(target))
+        return 0;
+
+    off = KV_HEADER;
+    for (key = 1; key < KV_KEYS; ++key) {
+        if (!slot[key])
+            continue;
+        n = record_size(word_at(base + slot[key]) >> 16);
+        if (!flash_program(addr + off, (const uint32_t*)(base + slot[key]),
+                           n / 4))
+            return 0;
+        off += n;
+    }
+
+    if (!write_header(addr, kv_stats.generation + 1))
+        return 0;
+
+    // die neuen Positionen ergeben sich aus derselben Reihenfolge
+    off = KV_HEADER;
+    for (key = 1; key < KV_KEYS; ++key) {
+        if (!slot[key])
+            continue;
+        n = record_size(word_at(base + slot[key]) >> 16);
+        slot[key] = off;
+        off += n;
+    }
+
+    use_sector(target, kv_stats.generation + 1);
+    writePos = off;
+    ++kv_stats.compactions;
+
+    /* Ein halb gelschter Sektor kann wieder KV_MAGIC und eine beliebige
+       Generation zeigen. Daher wird die Kennung vorher auf 0 gesetzt (Bits
+       lassen sich ohne Lschen von 1 auf 0 programmieren). Schlgt das
+       fehl (oder fllt vorher die Versorgung aus), so gilt beim nchsten
+       Start trotzdem der neue Sektor mit der hheren Generation. */
+    flash_program(flash_sector_addr(old), &zero, 1);
+    flash_erase(old);
+
+    return 1;
+}
+
+
+NO_LIBCALL static int append(uint32_t key, const void *value, uint32_t len)
+{
+    uint32_t buf[2 + KV_VALUE_MAX / 4];
+    uint8_t *b = (uint8_t*)buf;
+    const uint8_t *v = value;
+    uint32_t n = record_size(len);
+    uint32_t i, off;
+    int ok;
+
+    if (writePos + n > size && (!compact() || writePos + n > size))
+        return 0;
+
+    buf[0] = key | (len << 16);
+    for (i = 0; i < n - 8; ++i)
+        b[4 + i] = i < len ? v[i] : 0;
+    buf[n / 4 - 1] = commit_word(buf, n);
+
+    /* flash_program() schreibt die Worte der Reihe nach, die CRC also
+       zuletzt. Auch bei einem Fehler ist der Platz verbraucht. */
+    off = writePos;
+    writePos += n;
+    ok = flash_program(base + off, buf, n / 4);
+
+    ++kv_stats.writes;
+    if (ok)
+        slot[key] = len ? off : 0;
+    update_stats();
+
+    return ok;
+}
+
+
+
+//----------------------------------------------------------------------------
+
+int kv_init(void)
+{
+    uint32_t a  = flash_sector_addr(KV_SECTOR_A);
+    uint32_t b  = flash_sector_addr(KV_SECTOR_B);
+    uint32_t ga = word_at(a + 4);
+    uint32_t gb = word_at(b + 4);
+    int va = word_at(a) == KV_MAGIC;
+    int vb = word_at(b) == KV_MAGIC;
+
+    // bei zwei gltigen Sektoren gilt die hhere (jngere) Generation
+    if (va && (!vb || (int32_t)(ga - gb) > 0)) {
+        use_sector(KV_SECTOR_A, ga);
+    } else if (vb) {
+        use_sector(KV_SECTOR_B, gb);
+    } else {
+        if (!flash_erase(KV_SECTOR_A) || !write_header(a, 1))
+            return 0;
+        use_sector(KV_SECTOR_A, 1);
+    }
+
+    scan();
+    update_stats();
+
+    return 1;
+}
+
+
+
+NO_LIBCALL uint32_t kv_get(uint32_t key, void *value, uint32_t max)
+{
+    const uint8_t *p;
+    uint8_t *d = value;
+    uint32_t len, i;
+
+    if (!key || key >= KV_KEYS || !slot[key])
+        return 0;
+
+    p   = (const uint8_t*)(base + slot[key]);
+    len = word_at(base + slot[key]) >> 16;
+    for (i = 0; i < len && i < max; ++i)
+        d[i] = p[4 + i];
+
+    return len;
+}
+
+
+
+int kv_set(uint32_t key, const void *value, uint32_t len)
+{
+    const uint8_t *p, *v = value;
+    uint32_t i;
+
+    if (!key || key >= KV_KEYS || !len || len > KV_VALUE_MAX)
+        return 0;
+
+    // Flash schonen: Ein unvernderter Wert wird nicht erneut geschrieben
+    if (slot[key] && (word_at(base + slot[key]) >> 16) == len) {
+        p = (const uint8_t*)(base + slot[key]) + 4;
+        for (i = 0; i < len && p[i] == v[i]; ++i);
+        if (i == len) {
+            ++kv_stats.unchanged;
+            return 1;
+        }
+    }
+
+    return append(key, value, len);
+}
+
+
+
+int kv_delete(uint32_t key)
+{
+    if (!key || key >= KV_KEYS)
+        return 0;
+    if (!slot[key])
+        return 1;
+
+    return append(key, 0, 0);
+}
@@ -0,0 +1,94 @@
+#ifndef KVSTORE_H
+#define KVSTORE_H
+
+/*
+ * In den Dateien kvstore.h und kvstore.c findet sich ein kleiner Speicher
+ * fr Einstellungen, die einen Reset berdauern sollen, z.B. die Offsets
+ * des Beschleunigungssensors. Jeder Wert (1 bis KV_VALUE_MAX Byte) gehrt
+ * zu einem Schlssel, einer kleinen Zahl von 1 bis KV_KEYS - 1.
+ *
+ * Gespeichert wird in den beiden letzten Sektoren des Flash-Speichers (10
+ * und 11, je 128KB), die dafr in stm32_flash.ld vom Programm ausgenommen
+ * sind. Da ein Flash-Wort nur nach dem Lschen des ganzen Sektors neu
+ * beschrieben werden kann, wird nie etwas berschrieben: Jeder neue Wert
+ * wird als Datensatz hinten an ein Protokoll ("log") im aktiven Sektor
+ * angehngt, der jngste Datensatz eines Schlssels gilt. Erst wenn der
+ * Sektor voll ist, werden die gltigen Datenstze in den anderen Sektor
+ * kopiert ("compaction") und der alte gelscht. Beide Sektoren werden so
+ * abwechselnd und gleich oft gelscht.
+ *
+ * Ein Datensatz besteht aus ganzen Worten:
+ *
+ *     Schlssel (2) | Lnge (2) | Wert (auf 4 Byte aufgefllt) | CRC (4)
+ *
+ * Das letzte Wort enthlt die CRC-16 ber alles davor (s. telemetry.h) und
+ * deren Komplement, es wird als letztes geschrieben. Fllt die Versorgung
+ * mitten im Schreiben aus, so passt die CRC nicht und der Datensatz wird
+ * beim nchsten Start bergangen - es gilt dann der vorherige Wert. Ein
+ * Datensatz der Lnge 0 lscht einen Schlssel.
+ *
+ * Am Anfang eines Sektors steht eine Kennung und eine Generationsnummer,
+ * die bei jedem Umkopieren um eins steigt. Die Kennung wird erst ge-
+ * schrieben, wenn alle Datenstze kopiert sind, und der alte Sektor erst
+ * danach gelscht. Zu jedem Zeitpunkt gibt es daher einen vollstndigen
+ * Sektor mit Kennung; gibt es zwei, so gilt der mit der hheren Nummer.
+ *
+ * Beim Start (kv_init) wird das Protokoll einmal gelesen. Danach steht fr
+ * jeden Schlssel die Position seines jngsten Datensatzes in einer
+ * Tabelle im RAM, kv_get() muss also nicht suchen.
+ *
+ * Beim Schreiben und vor allem beim Lschen eines Sektors (1 bis 2
+ * Sekunden) steht der Prozessor still, s. flash.h. Die Funktionen drfen
+ * nur aus einem einzigen Programmteil aufgerufen werden, nicht aus Inter-
+ * ruptroutinen.
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+// die beiden Sektoren (s. flash.h)
+#define KV_SECTOR_A   10
+#define KV_SECTOR_B   11
+
+// Anzahl der Schlssel (inkl. der ungltigen 0) und lngster Wert
+#define KV_KEYS       32
+#define KV_VALUE_MAX  64
+
+// vergebene Schlssel
+#define KV_ACC_OFFSET 1     // int8_t x, y, z: Messwerte bei flachem board
+#define KV_BOOTS      2     // uint32_t: Anzahl der Starts (kv_store_example)
+
+// Statistik, z.B. zur Betrachtung im Debugger
+typedef struct
+{
+    uint32_t writes;        // geschriebene Datenstze
+    uint32_t unchanged;     // nicht geschrieben, da Wert unverndert
+    uint32_t compactions;   // Umkopieren in den anderen Sektor
+    uint32_t corrupt;       // beim Start bergangene Datenstze
+    uint32_t generation;    // Generationsnummer des aktiven Sektors
+    uint32_t used;          // belegte Bytes im aktiven Sektor
+    uint32_t live;          // Bytes der gltigen Datenstze davon
+} kv_stats_t;
+
+extern volatile kv_stats_t kv_stats;
+
+/* Sucht den aktiven Sektor und liest das Protokoll. Gibt es keinen, so
+wird Sektor KV_SECTOR_A gelscht und neu angelegt. Liefert 0, falls das
+nicht gelingt. */
+int kv_init(void);
+
+/* Kopiert den Wert eines Schlssels (hchstens max Byte) nach value und
+liefert seine Lnge, bzw. 0 falls es den Schlssel nicht gibt. */
+uint32_t kv_get(uint32_t key, void *value, uint32_t max);
+
+/* Speichert len Byte (1 bis KV_VALUE_MAX) unter einem Schlssel. Ist der
+Wert unverndert, so wird nichts geschrieben. Liefert 0 bei einem Fehler. */
+int kv_set(uint32_t key, const void *value, uint32_t len);
+
+/* Lscht einen Schlssel. Liefert 0 bei einem Fehler. */
+int kv_delete(uint32_t key);
+
+#endif
@@ -0,0 +1,166 @@
+/*
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+*/
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "led.h"
+#include "pwm_burst.h"
+#include "gamma_lut.h"
+
+// u.a. Definition der Hardwareregister des STM32F4
+#include "libfoo/stm32f4xx.h"
+
+
+// frames pro Puffer: 32 frames entsprechen 25ms
+#define LED_BLOCK  32
+
+/* Die beiden Puffer fr pwm_burst_stream(). Sie drfen nicht im CCM-RAM
+liegen, da der DMA-Controller sie lesen muss. */
+static uint16_t frames[2][LED_BLOCK * LED_COUNT];
+
+/* Die Helligkeit jeder LED wird mit 16 Nachkommabits gefhrt (Stufe << 16),
+damit auch lange berblendungen pro frame einen kleinen, aber von 0 ver-
+schiedenen Schritt machen. */
+typedef struct
+{
+    int32_t pos;        // aktuelle Helligkeit
+    int32_t target;     // Ziel der berblendung
+    int32_t step;       // nderung pro frame, 0 = keine berblendung
+} led_state_t;
+
+static led_state_t leds[LED_COUNT];
+static uint32_t    frameCount;
+
+/* Die 16 Perioden eines dither-Zyklus in der Reihenfolge, in der sie den
+hheren PWM-Wert erhalten. Die Bitumkehr der Periodennummer (0, 8, 4, 12,
+...) verteilt die hheren Werte mglichst gleichmig, so dass kein Flackern
+mit 1/16 der PWM-Frequenz (80Hz) entsteht. */
+static const uint8_t ditherRank[16] = {
+    0, 8, 4, 12, 2, 10, 6, 14, 1, 9, 5, 13, 3, 11, 7, 15
+};
+
+
+
+/* Bildet eine Helligkeit (Stufe << 16) auf einen PWM-Wert im Format 16.4
+ab. Zwischen zwei Eintrgen der Gamma-Tabelle wird linear interpoliert. */
+static uint32_t gamma16(int32_t pos)
+{
+    uint32_t i = (uint32_t)pos >> 16;
+    uint32_t f = ((uint32_t)pos >> 8) & 0xFF;
+    uint32_t a = gammaLut[i];
+
+    if (i >= LED_LEVELS - 1)
+        return a;
+
+    return a + (((gammaLut[i + 1] - a) * f) >> 8);
+}
+
+
+/* Berechnet count frames. Wird von pwm_burst.c im DMA-Interrupt aufgerufen,
+sobald ein Puffer abgespielt ist. */
+static void fill(uint16_t *buf, uint16_t count)
+{
+    led_state_t *l;
+    uint32_t i, k, v, rank;
+
+    for (i = 0; i < count; ++i) {
+        rank = ditherRank[frameCount++ & 15];
+
+        for (k = 0; k < LED_COUNT; ++k) {
+            l = &leds[k];
+
+            if (l->step) {
+                l->pos += l->step;
+                if ((l->step > 0) ? (l->pos >= l->target)
+                                  : (l->pos <= l->target)) {
+                    l->pos  = l->target;
+                    l->step = 0;
+                }
+            }
+
+            /* Ganzzahliger Anteil plus 1 in so vielen der 16 Perioden, wie
+               die 4 Nachkommabits angeben. */
+            v = gamma16(l->pos);
+            v = (v >> 4) + (rank < (v & 15));
+            if (v > 0xFFFF)
+                v = 0xFFFF;
+
+            *buf++ = (uint16_t)v;
+        }
+    }
+}
+
+
+
+//----------------------------------------------------------------------------
+
+void led_init(void)
+{
+    uint32_t k;
+
+    for (k = 0; k < LED_COUNT; ++k) {
+        leds[k].pos    = 0;
+        leds[k].target = 0;
+        leds[k].step   = 0;
+    }
+    frameCount = 0;
+
+    /* Prescaler 0 und ARR = 65535: Timer 4 zhlt mit vollen 84MHz und
+       erreicht damit trotz 16 Bit Auflsung noch 84MHz / 65536 = 1282Hz. */
+    pwm_burst_init(0, 0xFFFF, LED_COUNT);
+    pwm_burst_stream(frames[0], frames[1], LED_BLOCK, fill);
+}
+
+
+
+void led_set(uint8_t led, uint16_t level)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    if (led >= LED_COUNT)
+        return;
+    if (level >= LED_LEVELS)
+        level = LED_LEVELS - 1;
+
+    __disable_irq();
+    leds[led].pos    = (int32_t)level << 16;
+    leds[led].target = leds[led].pos;
+    leds[led].step   = 0;
+    __set_PRIMASK(primask);
+}
+
+
+
+void led_fade(uint8_t led, uint16_t level, uint32_t ms)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t n = ms * LED_FPS / 1000;
+    led_state_t *l;
+    int32_t step;
+
+    if (led >= LED_COUNT)
+        return;
+    l = &leds[led];
+    if (level >= LED_LEVELS)
+        level = LED_LEVELS - 1;
+    if (n == 0)
+        n = 1;
+
+    __disable_irq();
+    l->target = (int32_t)level << 16;
+    step = (l->target - l->pos) / (int32_t)n;
+    if (step == 0)
+        step = (l->target > l->pos) ? 1 : -1;
+    l->step = (l->target != l->pos) ? step : 0;
+    __set_PRIMASK(primask);
+}
+
+
+
+int led_fading(uint8_t led)
+{
+    return leds[led].step != 0;
+}
@@ -0,0 +1,56 @@
+#ifndef LED_H
+#define LED_H
+
+/*
+ * In den Dateien led.h und led.c findet sich eine Helligkeitssteuerung fr
+ * die 4 LEDs des discovery boards. Gegenber pwm_led_example() (ARR = 1000,
+ * lineare Tabelle mit 16 Stufen) gibt es drei Verbesserungen:
+ *
+ * - Timer 4 zhlt bis 65535 (16-Bit PWM bei 1.28kHz),
+ * - die Helligkeit wird ber eine Gamma-Tabelle (gamma_lut.h, erzeugt von
+ *   tools/gamma_gen.c) an die Wahrnehmung des Auges angepasst, und
+ * - 4 weitere Bits Auflsung entstehen durch "dithering": Der PWM-Wert
+ *   wechselt ber 16 Perioden so zwischen zwei benachbarten Werten, dass im
+ *   Mittel der Zwischenwert herauskommt.
+ *
+ * Gerade bei geringer Helligkeit, wo zwischen zwei Stufen der Gamma-Kurve
+ * weniger als ein PWM-Schritt liegt, blenden die LEDs dadurch ohne sicht-
+ * bare Stufen. Jede PWM-Periode erhlt per DMA neue Werte (pwm_burst.c),
+ * berblendungen laufen also mit 1280 Schritten pro Sekunde. Der Prozessor
+ * berechnet die Werte blockweise 40 mal pro Sekunde im DMA-Interrupt.
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+// Anzahl der LEDs (PD12 bis PD15)
+#define LED_COUNT   4
+
+// Anzahl der Helligkeitsstufen (0 = aus, LED_LEVELS - 1 = volle Helligkeit)
+#define LED_LEVELS  1024
+
+// frames pro Sekunde (PWM-Frequenz: 84MHz / 65536)
+#define LED_FPS     1282
+
+/* Richtet Timer 4 und den DMA-Stream ber pwm_burst_init() ein und startet
+die Ausgabe. Alle LEDs sind aus. */
+void led_init(void);
+
+/* Setzt die Helligkeit einer LED (0 bis LED_COUNT - 1). Da die Werte
+blockweise im Voraus berechnet werden, wird sie nach sptestens 50ms
+sichtbar. */
+void led_set(uint8_t led, uint16_t level);
+
+/* Blendet eine LED innerhalb von ms Millisekunden von ihrer aktuellen
+Helligkeit auf level ber. Die berblendung verluft gleichmig in der
+wahrgenommenen Helligkeit. Die Funktion darf auch aus Interruptroutinen
+aufgerufen werden. */
+void led_fade(uint8_t led, uint16_t level, uint32_t ms);
+
+/* Liefert 1, solange die LED noch berblendet. */
+int led_fading(uint8_t led);
+
+#endif
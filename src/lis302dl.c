@@ -0,0 +1,333 @@
+/*
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+*/
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "lis302dl.h"
+#include "spi_bus.h"
+#include "cycles.h"
+
+// u.a. Definition der Hardwareregister des STM32F4
+#include "libfoo/stm32f4xx.h"
+
+
+/* Der Chip-Select des LIS302DL hngt an PE3 (s. Abbildung 13 in [3]).
+Liegt der Pin auf 0, so ist der Sensor im SPI-Modus ausgewhlt. Das Setzen
+und Lschen des Pins bernimmt die Busverwaltung in spi_bus.c fr uns. Der
+Sensor vertrgt bis zu 10MHz Takt und arbeitet im SPI-Modus 3: */
+
+#define LIS302DL_CS_PORT  GPIOE
+#define LIS302DL_CS_PIN   0x0008
+#define LIS302DL_CR1      (SPI_BUS_DIV16 | SPI_BUS_MODE3)
+
+/* Im SPI-Protokoll des LIS302DL (Abschnitt 5.2.1 im Datenblatt) kennzeichnet
+Bit 7 des ersten Bytes einen Lesezugriff und Bit 6 das automatische Inkre-
+mentieren der Registeradresse bei Zugriffen auf mehrere Register: */
+
+#define LIS302DL_READ   0x80
+#define LIS302DL_MULTI  0x40
+
+
+/* Bereitet eine Transaktion fr den Sensor vor. */
+static void prepare(spi_xfer_t *x, const uint8_t *tx, uint8_t *rx,
+                    uint16_t len)
+{
+    x->csPort = LIS302DL_CS_PORT;
+    x->csPin  = LIS302DL_CS_PIN;
+    x->cr1    = LIS302DL_CR1;
+    x->tx     = tx;
+    x->rx     = rx;
+    x->len    = len;
+    x->done   = 0;
+}
+
+
+
+int lis302dl_init(void)
+{
+    /* SPI1 samt der Pins PA5 bis PA7 richtet die Busverwaltung ein: */
+    spi_bus1_init();
+
+    /* PE3 als Output-Push-Pull konfigurieren und auf 1 setzen. Damit ist
+       der Sensor zunchst nicht ausgewhlt: */
+    GPIOE->BSRRL    = LIS302DL_CS_PIN;
+    GPIOE->MODER   &= 0xFFFFFF3F;
+    GPIOE->MODER   |= 0x00000040;
+    GPIOE->OTYPER  &= 0xFFFFFFF7;
+    GPIOE->OSPEEDR &= 0xFFFFFF3F;
+    GPIOE->OSPEEDR |= 0x00000040; // 25MHz
+    GPIOE->PUPDR   &= 0xFFFFFF3F;
+
+    if (lis302dl_read_reg(LIS302DL_WHO_AM_I) != LIS302DL_ID)
+        return 0;
+
+    /* CTRL_REG1: DR = 0 (100Hz), PD = 1 (aktiv), FS = 0 (+-2g),
+       Zen = Yen = Xen = 1: */
+    lis302dl_write_reg(LIS302DL_CTRL_REG1, 0x47);
+
+    return 1;
+}
+
+
+
+uint8_t lis302dl_read_reg(uint8_t reg)
+{
+    spi_xfer_t x;
+    uint8_t tx[2] = { reg | LIS302DL_READ, 0x00 };
+    uint8_t rx[2];
+
+    prepare(&x, tx, rx, 2);
+    spi_bus_transfer(&spi_bus1, &x);
+
+    return rx[1];
+}
+
+
+
+void lis302dl_write_reg(uint8_t reg, uint8_t value)
+{
+    spi_xfer_t x;
+    uint8_t tx[2] = { reg, value };
+
+    prepare(&x, tx, 0, 2);
+    spi_bus_transfer(&spi_bus1, &x);
+}
+
+
+
+/* Die Ausgaberegister liegen bei 0x29, 0x2B und 0x2D. Mit einem Mehrfach-
+zugriff ab 0x29 lesen wir 6 Bytes am Stck: ein Dummy-Byte (whrend das
+Kommando gesendet wird), X, ein unbenutztes Register, Y, ein unbenutztes
+Register und Z. Die Messwerte liegen also an den Stellen 1, 3 und 5. */
+
+#define FRAME_SIZE 6
+
+static const uint8_t readCmd[FRAME_SIZE] = {
+    LIS302DL_OUT_X | LIS302DL_READ | LIS302DL_MULTI, 0, 0, 0, 0, 0
+};
+
+void lis302dl_read_xyz(int8_t xyz[3])
+{
+    spi_xfer_t x;
+    uint8_t rx[FRAME_SIZE];
+
+    prepare(&x, readCmd, rx, FRAME_SIZE);
+    spi_bus_transfer(&spi_bus1, &x);
+
+    xyz[0] = (int8_t)rx[1];
+    xyz[1] = (int8_t)rx[3];
+    xyz[2] = (int8_t)rx[5];
+}
+
+
+
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+
+/* Gepufferte Erfassung: Bei 400Hz Datenrate wrde ein Verbraucher, der jede
+Messung einzeln per Interrupt abholt und verarbeitet, 400 mal pro Sekunde
+geweckt. Der LIS302DL besitzt leider (anders als sein Nachfolger LIS3DSH)
+keinen eigenen FIFO, in dem sich die Messungen sammeln lieen. Wir bilden
+diesen FIFO daher im RAM nach: Jede Messung wird als SPI-Transaktion per DMA
+direkt in einen Ringpuffer geschrieben. Die CPU muss pro Messung nur noch
+die Transaktion in die Warteschlange des Busses stellen. Geweckt wird der
+Verbraucher erst, wenn "watermark" Messungen vorliegen.
+
+Jeder Eintrag des Ringpuffers enthlt die 6 Bytes eines Mehrfachzugriffs
+ab OUT_X (s. lis302dl_read_xyz()). */
+
+static uint8_t ring[LIS302DL_RING_SIZE][FRAME_SIZE];
+static uint8_t scratch[FRAME_SIZE];
+
+// Transaktion der gepufferten Erfassung
+static spi_xfer_t batchXfer;
+
+// Schreibposition (DMA) und Leseposition (Verbraucher), laufen frei
+static volatile uint32_t head = 0;
+static volatile uint32_t tail = 0;
+// Stand von head bei der letzten Benachrichtigung
+static uint32_t notified = 0;
+
+static volatile uint32_t watermark = 1;
+static lis302dl_ready_fn readyFn = 0;
+
+volatile lis302dl_stats_t lis302dl_stats;
+
+static void batch_done(spi_xfer_t *x);
+
+
+
+void lis302dl_batch_start(uint32_t wm, lis302dl_ready_fn ready)
+{
+    cycles_init();
+
+    head     = 0;
+    tail     = 0;
+    notified = 0;
+    readyFn  = ready;
+    lis302dl_set_watermark(wm);
+
+    lis302dl_stats.samples  = 0;
+    lis302dl_stats.irqs     = 0;
+    lis302dl_stats.wakeups  = 0;
+    lis302dl_stats.overruns = 0;
+    lis302dl_stats.cycles   = 0;
+
+    prepare(&batchXfer, readCmd, 0, FRAME_SIZE);
+    batchXfer.done  = batch_done;
+    batchXfer.state = SPI_XFER_IDLE;
+
+    /* CTRL_REG3: "Data ready" auf INT2 legen (I2CFG = 100), INT1 bleibt
+       ungenutzt. CTRL_REG1: DR = 1 (400Hz), PD = 1, Zen = Yen = Xen = 1: */
+    lis302dl_write_reg(LIS302DL_CTRL_REG3, 0x20);
+    lis302dl_write_reg(LIS302DL_CTRL_REG1, 0xC7);
+
+    /* INT2 hngt an PE1. ber den SYSCFG-Block (Takt ber Bit 14 im
+       RCC_APB2ENR) verbinden wir EXTI-Leitung 1 mit Port E (EXTICR1,
+       Bits 4 bis 7 = 0100) und lsen bei steigender Flanke einen Interrupt
+       aus. Die Leitung EXTI1 ist Interrupt Nummer 7 (Tabelle 30 in [1]): */
+    RCC->APB2ENR      |= 0x00004000;
+    SYSCFG->EXTICR[0]  = (SYSCFG->EXTICR[0] & 0xFFFFFF0F) | 0x00000040;
+    EXTI->RTSR        |= 0x00000002;
+    EXTI->IMR         |= 0x00000002;
+
+    NVIC->ISER[0] |= 0x00000080;
+
+    /* Lag INT2 bereits vor dem Einschalten des Interrupts auf 1, so kme
+       nie eine steigende Flanke. Wir stoen die erste bertragung daher per
+       Software-Interrupt (SWIER) an: */
+    EXTI->SWIER = 0x00000002;
+}
+
+
+
+void lis302dl_batch_stop(void)
+{
+    EXTI->IMR  &= 0xFFFFFFFD;
+    NVIC->ICER[0] = 0x00000080;
+
+    // eine eventuell noch laufende Messung abwarten
+    while (batchXfer.state == SPI_XFER_QUEUED);
+
+    lis302dl_write_reg(LIS302DL_CTRL_REG3, 0x00);
+}
+
+
+
+void lis302dl_set_watermark(uint32_t wm)
+{
+    if (wm < 1)
+        wm = 1;
+    if (wm > LIS302DL_MAX_WATERMARK)
+        wm = LIS302DL_MAX_WATERMARK;
+    watermark = wm;
+}
+
+
+
+uint32_t lis302dl_get_watermark(void)
+{
+    return watermark;
+}
+
+
+
+uint32_t lis302dl_batch_fetch(int8_t (*dst)[3], uint32_t max)
+{
+    uint32_t h = head;
+    uint32_t n = 0;
+    uint8_t *f;
+
+    while (tail + n != h && n < max) {
+        f = ring[(tail + n) & (LIS302DL_RING_SIZE - 1)];
+        dst[n][0] = (int8_t)f[1];
+        dst[n][1] = (int8_t)f[3];
+        dst[n][2] = (int8_t)f[5];
+        ++n;
+    }
+    tail += n;
+
+#if LIS302DL_ADAPTIVE
+    /* Der Verbraucher mchte max Messungen auf einmal verarbeiten. Wir
+       nhern die watermark schrittweise an diesen Wert an, damit einzelne
+       Ausreier sie nicht hin und her springen lassen: */
+    if (max > LIS302DL_MAX_WATERMARK)
+        max = LIS302DL_MAX_WATERMARK;
+    lis302dl_set_watermark((watermark + max + 1) / 2);
+#endif
+
+    return n;
+}
+
+
+
+/* Interrupt von EXTI1: Der Sensor hat eine neue Messung. */
+void EXTI1_IRQHandler(void)
+{
+    uint32_t t0 = cycles_now();
+
+    // Pending-Bit durch Schreiben einer 1 lschen
+    EXTI->PR = 0x00000002;
+
+    ++lis302dl_stats.irqs;
+
+    /* Luft die vorherige Messung noch (weil z.B. ein anderes Gert den
+       Bus belegt), so wird die Transaktion nicht erneut eingestellt. INT2
+       bleibt dann auf 1, bis die Messung gelesen ist - eine weitere Flanke
+       kommt also nicht. batch_done() holt den Interrupt deshalb nach. */
+    if (batchXfer.state == SPI_XFER_QUEUED) {
+        ++lis302dl_stats.overruns;
+    } else {
+        /* Ist der Ringpuffer voll, mssen wir die Messung trotzdem lesen,
+           da der Sensor sonst kein neues "Data ready" meldet. Sie landet
+           dann im Zwischenspeicher scratch und wird verworfen: */
+        if (head - tail >= LIS302DL_RING_SIZE)
+            batchXfer.rx = scratch;
+        else
+            batchXfer.rx = ring[head & (LIS302DL_RING_SIZE - 1)];
+
+        spi_bus_submit(&spi_bus1, &batchXfer);
+    }
+
+    lis302dl_stats.cycles += cycles_now() - t0;
+}
+
+
+
+/* Wird von der Busverwaltung im Interrupt des RX-Streams aufgerufen,
+   sobald eine Messung vollstndig empfangen ist. */
+static void batch_done(spi_xfer_t *x)
+{
+    uint32_t t0 = cycles_now();
+    uint32_t h;
+
+    ++lis302dl_stats.irqs;
+
+    if (x->rx == scratch) {
+        ++lis302dl_stats.overruns;
+    } else {
+        h = head + 1;
+        head = h;
+        ++lis302dl_stats.samples;
+
+        if (h - notified >= watermark) {
+            notified = h;
+            ++lis302dl_stats.wakeups;
+            if (readyFn)
+                readyFn(h - tail);
+        }
+    }
+
+    /* Liegt INT2 (PE1) noch auf 1, so ist whrend der bertragung bereits
+       die nchste Messung fertig geworden und ihre Flanke im IRQHandler
+       verworfen worden. Ohne neue Flanke kme kein Interrupt mehr, wir
+       lsen ihn daher wie in lis302dl_batch_start() per SWIER aus: */
+    if (GPIOE->IDR & 0x00000002)
+        EXTI->SWIER = 0x00000002;
+
+    lis302dl_stats.cycles += cycles_now() - t0;
+}
@@ -0,0 +1,99 @@
+#ifndef LIS302DL_H
+#define LIS302DL_H
+
+/*
+ * In den Dateien lis302dl.h und lis302dl.c findet sich ein einfacher
+ * Treiber fr den Beschleunigungssensor LIS302DL des discovery boards.
+ * Der Sensor wird ber SPI1 angesprochen (s. discovery_acc_init() in
+ * discovery.c sowie Kapitel 5 im Datenblatt des LIS302DL).
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+// Registeradressen des LIS302DL (s. Tabelle 16 im Datenblatt)
+#define LIS302DL_WHO_AM_I    0x0F
+#define LIS302DL_CTRL_REG1   0x20
+#define LIS302DL_CTRL_REG2   0x21
+#define LIS302DL_CTRL_REG3   0x22
+#define LIS302DL_STATUS_REG  0x27
+#define LIS302DL_OUT_X       0x29
+#define LIS302DL_OUT_Y       0x2B
+#define LIS302DL_OUT_Z       0x2D
+
+// Inhalt des WHO_AM_I-Registers
+#define LIS302DL_ID          0x3B
+
+/* Die Methode lis302dl_init() konfiguriert SPI1 und den Chip-Select PE3
+und schaltet den Sensor mit 100Hz Datenrate und allen 3 Achsen ein. Der
+Rckgabewert ist 1, falls der Sensor sich mit der passenden ID meldet,
+sonst 0. */
+int lis302dl_init(void);
+
+/* Liest ein einzelnes Register des Sensors. */
+uint8_t lis302dl_read_reg(uint8_t reg);
+
+/* Schreibt ein einzelnes Register des Sensors. */
+void lis302dl_write_reg(uint8_t reg, uint8_t value);
+
+/* Liest die drei Achsen (x, y, z) in einem einzigen SPI-Transfer. Ein
+LSB entspricht im +-2g Messbereich etwa 18mg. */
+void lis302dl_read_xyz(int8_t xyz[3]);
+
+
+
+//------------------------------------------------------------------------
+
+/* Gepufferte Erfassung ("batch mode"): Der LIS302DL meldet jede neue
+Messung ber seine Leitung INT2 (PE1). Daraufhin wird die Messung ohne
+Zutun der CPU per DMA ber SPI1 in einen Ringpuffer bertragen. Der
+Verbraucher wird erst dann benachrichtigt, wenn mindestens "watermark"
+Messungen vorliegen, und holt diese dann gesammelt ab. Da der LIS302DL
+keinen eigenen FIFO besitzt, wird der FIFO also im RAM nachgebildet. */
+
+// Gre des Ringpuffers (Zweierpotenz) und grte mgliche watermark
+#define LIS302DL_RING_SIZE     64
+#define LIS302DL_MAX_WATERMARK 32
+
+// Funktion des Verbrauchers; wird im Interrupt mit der Anzahl der
+// vorliegenden Messungen aufgerufen
+typedef void (*lis302dl_ready_fn)(uint32_t available);
+
+// Statistik der gepufferten Erfassung
+typedef struct
+{
+    uint32_t samples;   // bertragene Messungen
+    uint32_t irqs;      // Interrupts (EXTI1 und DMA RX-Stream)
+    uint32_t wakeups;   // Aufrufe des Verbrauchers
+    uint32_t overruns;  // wegen vollem Ringpuffer verworfene Messungen
+    uint32_t cycles;    // in den Interruptroutinen verbrachte Takte
+} lis302dl_stats_t;
+
+extern volatile lis302dl_stats_t lis302dl_stats;
+
+/* Startet die gepufferte Erfassung mit 400Hz. lis302dl_init() muss zuvor
+aufgerufen worden sein. Danach darf lis302dl_read_xyz() nicht mehr
+verwendet werden. */
+void lis302dl_batch_start(uint32_t watermark, lis302dl_ready_fn ready);
+
+/* Hlt die gepufferte Erfassung an. */
+void lis302dl_batch_stop(void);
+
+/* Legt fest, nach wie vielen Messungen der Verbraucher benachrichtigt
+wird (1 bis LIS302DL_MAX_WATERMARK). */
+void lis302dl_set_watermark(uint32_t watermark);
+uint32_t lis302dl_get_watermark(void);
+
+/* Kopiert bis zu max Messungen (je x, y, z) nach dst und gibt die Anzahl
+der kopierten Messungen zurck. Mit max teilt der Verbraucher zugleich
+mit, wie viele Messungen er pro Durchgang verarbeiten mchte. Ist
+LIS302DL_ADAPTIVE gesetzt, wird die watermark daran angepasst. */
+uint32_t lis302dl_batch_fetch(int8_t (*dst)[3], uint32_t max);
+
+// watermark automatisch an den Bedarf des Verbrauchers anpassen
+#define LIS302DL_ADAPTIVE 1
+
+#endif
@@ -0,0 +1,145 @@
+/*
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+*/
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+// va_list usw. (kommt vom Compiler, nicht aus der Standardbibliothek)
+#include <stdarg.h>
+
+#include "log.h"
+#include "uart.h"
+
+
+// Ziel der Formatierung: ein reservierter Bereich im Ring
+typedef struct
+{
+    uart_slot_t slot;
+    uint32_t    n;
+} log_out_t;
+
+static void put(log_out_t *o, char c)
+{
+    if (o->n < o->slot.len)
+        uart_ring[(o->slot.pos + o->n++) & (UART_RING - 1)] = c;
+}
+
+
+/* Schreibt v zur Basis base mit mindestens width Stellen. Die Ziffern
+entstehen von hinten nach vorn, daher der kleine Zwischenspeicher. */
+static void put_num(log_out_t *o, uint32_t v, uint32_t base, int neg,
+                    uint32_t width, char pad, const char *digits)
+{
+    char buf[10];
+    uint32_t k = 0;
+
+    do {
+        buf[k++] = digits[v % base];
+        v /= base;
+    } while (v);
+
+    if (neg) {
+        if (pad == '0')
+            put(o, '-');
+        if (width)
+            --width;
+    }
+    while (width > k) {
+        put(o, pad);
+        --width;
+    }
+    if (neg && pad != '0')
+        put(o, '-');
+
+    while (k)
+        put(o, buf[--k]);
+}
+
+
+
+//----------------------------------------------------------------------------
+
+uint32_t log_printf(const char *fmt, ...)
+{
+    static const char lower[] = "0123456789abcdef";
+    static const char upper[] = "0123456789ABCDEF";
+
+    log_out_t o;
+    va_list ap;
+    const char *s;
+    uint32_t width;
+    char pad;
+    int32_t d;
+
+    if (!uart_reserve(&o.slot, LOG_LINE_MAX))
+        return 0;
+    o.n = 0;
+
+    va_start(ap, fmt);
+
+    for (; *fmt; ++fmt) {
+        if (*fmt != '%') {
+            if (*fmt == '\n')
+                put(&o, '\r');
+            put(&o, *fmt);
+            continue;
+        }
+
+        ++fmt;
+        pad = ' ';
+        if (*fmt == '0') {
+            pad = '0';
+            ++fmt;
+        }
+        width = 0;
+        while (*fmt >= '0' && *fmt <= '9')
+            width = width * 10 + (*fmt++ - '0');
+        if (*fmt == 'l')
+            ++fmt;
+
+        switch (*fmt) {
+        case 'd':
+        case 'i':
+            d = va_arg(ap, int32_t);
+            put_num(&o, d < 0 ? -(uint32_t)d : (uint32_t)d, 10, d < 0,
+                    width, pad, lower);
+            break;
+        case 'u':
+            put_num(&o, va_arg(ap, uint32_t), 10, 0, width, pad, lower);
+            break;
+        case 'x':
+            put_num(&o, va_arg(ap, uint32_t), 16, 0, width, pad, lower);
+            break;
+        case 'X':
+            put_num(&o, va_arg(ap, uint32_t), 16, 0, width, pad, upper);
+            break;
+        case 'c':
+            put(&o, (char)va_arg(ap, int));
+            break;
+        case 's':
+            s = va_arg(ap, const char*);
+            for (d = 0; s[d]; ++d);
+            while (width > (uint32_t)d) {
+                put(&o, ' ');
+                --width;
+            }
+            while (*s)
+                put(&o, *s++);
+            break;
+        case '\0':
+            --fmt;
+            break;
+        default:
+            put(&o, *fmt);
+            break;
+        }
+    }
+
+    va_end(ap);
+
+    uart_commit(&o.slot, o.n);
+
+    return o.n;
+}
@@ -0,0 +1,34 @@
+#ifndef LOG_H
+#define LOG_H
+
+/*
+ * In den Dateien log.h und log.c findet sich eine schlanke Variante von
+ * printf fr die Ausgabe ber uart.c. Der Text wird direkt in einen im
+ * Ringpuffer reservierten Bereich formatiert und von dort per DMA gesendet
+ * - ohne Zwischenpuffer und ohne Warten auf den USART. log_printf() darf
+ * daher auch in Interruptroutinen verwendet werden und kostet dort nur die
+ * Zeit fr das Formatieren selbst (s. uart_log_benchmark() in
+ * discovery_ex.c).
+ *
+ * Untersttzt werden %d, %i, %u, %x, %X, %c, %s und %% mit optionaler
+ * Feldbreite und fhrenden Nullen (z.B. %08x). Ein "l" (z.B. %lu) wird
+ * berlesen, da int und long hier gleich gro sind. Jedes '\n' wird als
+ * "\r\n" gesendet.
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+/* Grte Lnge einer Ausgabe in Byte. So viel wird im Ring reserviert, was
+nicht gebraucht wird, gibt uart_commit() zurck. Lngere Ausgaben werden
+abgeschnitten. */
+#define LOG_LINE_MAX  128
+
+/* Formatiert wie printf und reicht das Ergebnis an uart.c weiter. Liefert
+die Anzahl der Bytes oder 0, falls der Ring voll war. */
+uint32_t log_printf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+#endif
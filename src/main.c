@@ -77,6 +77,108 @@ int main(void)
     // ein- und ausblenden lassen kann.
     dma_pwm_led_example();
 
+    //----------------------------------------------------------------------
+
+    // In diesem Beispiel wird der Beschleunigungssensor ausgelesen und die
+    // Neigung des boards ber die 4 LEDs angezeigt.
+    acc_tilt_example();
+
+    //----------------------------------------------------------------------
+
+    // Messung der gepufferten Erfassung des Beschleunigungssensors bei
+    // verschiedenen watermarks (1 bis 32).
+    acc_batch_benchmark();
+
+    //----------------------------------------------------------------------
+
+    // Laufzeitvergleich: Lesen-ndern-Schreiben, BSRR und bit-banding
+    bitband_benchmark();
+
+    //----------------------------------------------------------------------
+
+    // Software-Timer: Laufzeitmessung und blinkende LEDs
+    swtimer_benchmark();
+
+    //----------------------------------------------------------------------
+
+    // Premptiver Kernel: Dauer eines Threadwechsels
+    kernel_benchmark();
+
+    //----------------------------------------------------------------------
+
+    // LEDs per PWM mit nur einem DMA-Stream (Timer 4 DMA burst)
+    dma_burst_led_example();
+
+    //----------------------------------------------------------------------
+
+    // Wellenformen beliebiger Lnge und Rate per DMA double buffer
+    wave_player_example();
+
+    //----------------------------------------------------------------------
+
+    // 16-Bit PWM mit Gamma-Korrektur und dithering
+    led_engine_example();
+
+    //----------------------------------------------------------------------
+
+    // memcpy per DMA: Prozessor und DMA-Controller im Vergleich
+    dma_copy_benchmark();
+
+    //----------------------------------------------------------------------
+
+    // Buslast eines DMA-Streams mit und ohne FIFO und bursts
+    dma_mode_benchmark();
+
+    //----------------------------------------------------------------------
+
+    // Textausgabe per DMA ber USART2
+    uart_log_benchmark();
+
+    //----------------------------------------------------------------------
+
+    // Messdaten im Binrformat (COBS, CRC-16) ber USART2
+    telemetry_acc_example();
+
+    //----------------------------------------------------------------------
+
+    // Kommandos ber USART2 per DMA und idle line empfangen
+    uart_commands_example();
+
+    //----------------------------------------------------------------------
+
+    // Einstellungen im Flash-Speicher ablegen
+    kv_store_example();
+
+    //----------------------------------------------------------------------
+
+    // Informationen des Bootloaders ausgeben
+    boot_info_example();
+
+    //----------------------------------------------------------------------
+
+    // zwischen den Aufgaben im Stop mode schlafen
+    power_stop_example();
+
+    //----------------------------------------------------------------------
+
+    // Klick, Doppelklick und langes Drcken erkennen
+    button_gestures_example();
+
+    //----------------------------------------------------------------------
+
+    // Speicherverwaltung mit Blcken fester Gre
+    mempool_bench_example();
+
+    //----------------------------------------------------------------------
+
+    // Zwischenergebnisse pro Messblock in einer Arena
+    acc_arena_example();
+
+    //----------------------------------------------------------------------
+
+    // Speicherschutz mit der MPU
+    mpu_benchmark();
+
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,176 @@
+/*
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+*/
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "mempool.h"
+
+// u.a. Definition der Hardwareregister des STM32F4
+#include "libfoo/stm32f4xx.h"
+
+#ifdef MEMPOOL_CCM
+#define POOL_SECTION  __attribute__((section(".ccmram")))
+#else
+#define POOL_SECTION
+#endif
+
+
+typedef struct block
+{
+    struct block *next;
+} block_t;
+
+typedef struct
+{
+    block_t * volatile free;    // Liste der freien Blcke
+    uint8_t  *start;            // erster Block
+    uint8_t  *end;              // hinter dem letzten Block
+} pool_t;
+
+#define MEMPOOL_BYTES_(size, count)  + (size) * (count)
+#define MEMPOOL_CLASS_(size, count)  { size, count },
+
+static const struct
+{
+    uint16_t size;
+    uint16_t count;
+} classes[MEMPOOL_CLASSES] = { MEMPOOL_LIST(MEMPOOL_CLASS_) };
+
+// Speicher aller Klassen hintereinander (uint64_t fr die Ausrichtung)
+static uint64_t store[(0 MEMPOOL_LIST(MEMPOOL_BYTES_)) / 8] POOL_SECTION;
+
+static pool_t pools[MEMPOOL_CLASSES];
+
+volatile mempool_stats_t mempool_stats[MEMPOOL_CLASSES];
+
+
+
+/* Nimmt den ersten Block von der Liste. Zwischen LDREX und STREX wird
+b->next gelesen - hat in der Zwischenzeit eine Interruptroutine Blcke
+genommen und zurckgegeben, knnte b zwar wieder vorne liegen, b->next aber
+veraltet sein (das "ABA-Problem"). Beim Cortex-M4 lscht jedoch jeder
+Eintritt in eine Interruptroutine und jede Rckkehr die Markierung von
+LDREX, das STREX schlgt dann fehl und der Versuch wird wiederholt. */
+static block_t *pop(pool_t *p)
+{
+    block_t *b;
+
+    do {
+        b = (block_t*)__LDREXW((volatile uint32_t*)&p->free);
+        if (!b) {
+            __CLREX();
+            return 0;
+        }
+    } while (__STREXW((uint32_t)b->next, (volatile uint32_t*)&p->free));
+
+    return b;
+}
+
+static void push(pool_t *p, block_t *b)
+{
+    do {
+        b->next = (block_t*)__LDREXW((volatile uint32_t*)&p->free);
+    } while (__STREXW((uint32_t)b, (volatile uint32_t*)&p->free));
+}
+
+static void atomic_add(volatile uint32_t *p, int32_t v)
+{
+    do {
+    } while (__STREXW(__LDREXW(p) + v, p));
+}
+
+// *p = max(*p, v)
+static void atomic_max(volatile uint32_t *p, uint32_t v)
+{
+    do {
+        if (__LDREXW(p) >= v) {
+            __CLREX();
+            return;
+        }
+    } while (__STREXW(v, p));
+}
+
+
+
+//----------------------------------------------------------------------------
+
+void mempool_init(void)
+{
+    uint8_t *a = (uint8_t*)store;
+    uint32_t c, i;
+
+    for (c = 0; c < MEMPOOL_CLASSES; ++c) {
+        pools[c].start = a;
+        pools[c].free  = 0;
+
+        // von hinten verketten, damit die Blcke aufsteigend vergeben werden
+        a += classes[c].size * classes[c].count;
+        pools[c].end = a;
+        for (i = classes[c].count; i > 0; --i) {
+            block_t *b = (block_t*)(pools[c].start + (i - 1) * classes[c].size);
+            b->next = pools[c].free;
+            pools[c].free = b;
+        }
+
+        mempool_stats[c].size   = classes[c].size;
+        mempool_stats[c].count  = classes[c].count;
+        mempool_stats[c].used   = 0;
+        mempool_stats[c].peak   = 0;
+        mempool_stats[c].allocs = 0;
+        mempool_stats[c].spills = 0;
+        mempool_stats[c].fails  = 0;
+    }
+}
+
+
+
+void *mempool_alloc(uint32_t size)
+{
+    volatile mempool_stats_t *s;
+    uint32_t c, first;
+    block_t *b;
+
+    for (first = 0; first < MEMPOOL_CLASSES; ++first)
+        if (classes[first].size >= size)
+            break;
+
+    if (first == MEMPOOL_CLASSES)
+        return 0;
+
+    for (c = first; c < MEMPOOL_CLASSES; ++c) {
+        b = pop(&pools[c]);
+        if (b) {
+            s = &mempool_stats[c];
+            atomic_add(&s->used, 1);
+            atomic_add(&s->allocs, 1);
+            atomic_max(&s->peak, s->used);
+            if (c != first)
+                atomic_add(&mempool_stats[first].spills, 1);
+            return b;
+        }
+    }
+
+    atomic_add(&mempool_stats[first].fails, 1);
+    return 0;
+}
+
+
+
+void mempool_free(void *p)
+{
+    uint8_t *a = (uint8_t*)p;
+    uint32_t c;
+
+    for (c = 0; c < MEMPOOL_CLASSES; ++c) {
+        if (a >= pools[c].start && a < pools[c].end) {
+            if ((uint32_t)(a - pools[c].start) % classes[c].size)
+                return;
+            push(&pools[c], (block_t*)a);
+            atomic_add(&mempool_stats[c].used, -1);
+            return;
+        }
+    }
+}
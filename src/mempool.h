@@ -0,0 +1,74 @@
+#ifndef MEMPOOL_H
+#define MEMPOOL_H
+
+/*
+ * In den Dateien mempool.h und mempool.c findet sich eine Speicherver-
+ * waltung aus Blcken fester Gre ("fixed-block pools"). Bisher ist jeder
+ * Puffer statisch und fr den schlimmsten Fall bemessen; ein Heap fehlt
+ * (_Min_Heap_Size ist 0, die libc wird beim Linken verworfen).
+ *
+ * Es gibt einige Grenklassen, die unten zur bersetzungszeit festgelegt
+ * werden. Jede Klasse hat eine feste Anzahl Blcke gleicher Gre, die
+ * freien Blcke sind einfach verkettet. mempool_alloc() nimmt den ersten
+ * Block der kleinsten passenden Klasse, mempool_free() legt ihn wieder
+ * vorne an - beides in konstanter Zeit, unabhngig davon, wie viele Blcke
+ * belegt sind. Da alle Blcke einer Klasse gleich gro sind, zerfllt der
+ * Speicher auch nach langer Laufzeit nicht in unbrauchbar kleine Lcken
+ * (externe Fragmentierung). Der Preis ist der Verschnitt innerhalb der
+ * Blcke: Wer 40 Byte anfordert, erhlt einen Block der Klasse 64.
+ *
+ * Die Listen werden wie in sched.c mit LDREX und STREX (s. spi_bus.c)
+ * ohne Sperren von Interrupts bearbeitet. Beide Funktionen drfen daher
+ * auch aus Interruptroutinen aufgerufen werden.
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+/* Die Grenklassen als Liste von C(Blockgre in Byte, Anzahl Blcke),
+aufsteigend nach Gre. Die Gren mssen Vielfache von 8 sein. */
+#define MEMPOOL_LIST(C) \
+    C(  32, 64)         \
+    C(  64, 32)         \
+    C( 128, 16)         \
+    C( 512,  8)
+
+/* Mit MEMPOOL_CCM liegen die Blcke im CCM-RAM (s. kernel.c). Dort stren
+sie den DMA nicht, sind fr ihn aber auch nicht erreichbar - die Blcke
+taugen dann nicht als Puffer fr uart.c oder spi_bus.c. */
+//#define MEMPOOL_CCM
+
+#define MEMPOOL_COUNT_(size, count)  + 1
+#define MEMPOOL_CLASSES  (0 MEMPOOL_LIST(MEMPOOL_COUNT_))
+
+// Statistik je Klasse, z.B. zur Betrachtung im Debugger
+typedef struct
+{
+    uint32_t size;      // Blockgre
+    uint32_t count;     // Anzahl Blcke
+    uint32_t used;      // belegte Blcke
+    uint32_t peak;      // hchste Zahl belegter Blcke seit mempool_init()
+    uint32_t allocs;    // vergebene Blcke
+    uint32_t spills;    // Anforderungen, die in eine grere Klasse auswichen
+    uint32_t fails;     // Anforderungen, fr die kein Block frei war
+} mempool_stats_t;
+
+extern volatile mempool_stats_t mempool_stats[MEMPOOL_CLASSES];
+
+/* Verkettet alle Blcke und setzt die Statistik zurck. Alle zuvor ver-
+gebenen Blcke werden dabei ungltig. */
+void mempool_init(void);
+
+/* Liefert einen Block mit mindestens size Byte (auf 8 Byte ausgerichtet)
+oder 0. Ist die kleinste passende Klasse erschpft, so wird die nchst-
+grere versucht. */
+void *mempool_alloc(uint32_t size);
+
+/* Gibt einen Block zurck. Zeiger, die nicht von mempool_alloc() stammen
+(auch 0), werden ignoriert. */
+void mempool_free(void *p);
+
+#endif
@@ -0,0 +1,172 @@
+/*
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+*/
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "mpu.h"
+
+// u.a. Definition der Hardwareregister des STM32F4
+#include "libfoo/stm32f4xx.h"
+
+
+/* Die Attribute einer Region stehen in MPU_RASR:
+     Bit  28      XN    1 = nicht ausfhrbar
+     Bits 26..24  AP    011 = lesen und schreiben, 110 = nur lesen,
+                        000 = kein Zugriff
+     Bits 21..16  TEX, S, C, B  Art des Speichers (Tabelle 4-40 im
+                        Generic User Guide): 000 0 1 0 = normal (write-
+                        through), 000 1 1 1 = normal (shareable, write-
+                        back), 000 0 0 1 = device (shareable)
+     Bits 5..1    SIZE  Gre 2^(SIZE + 1) Byte
+     Bit  0       ENABLE
+   MPU_RBAR enthlt die Adresse, mit VALID (Bit 4) zugleich die Nummer der
+   Region (Bits 0 bis 3). */
+#define RASR_FLASH   0x06020027     // 1MB, nur lesen, ausfhrbar
+#define RASR_KV      0x13020023     // 256KB, lesen/schreiben, XN
+#define RASR_SRAM    0x13070021     // 128KB, lesen/schreiben, XN
+#define RASR_PERIPH  0x13010039     // 512MB, device, XN
+#define RASR_CODE    0x03070001     // + SIZE: lesen/schreiben, ausfhrbar
+#define RASR_GUARD   0x10000009     // 32 Byte, kein Zugriff, XN
+
+#define RBAR_VALID   0x00000010
+
+// Grenzen aus dem Linker-Skript (stm32_sections.ld)
+extern uint8_t _sramfunc, _eramfunc, _end;
+
+volatile mpu_fault_t mpu_fault;
+mpu_fault_fn mpu_fault_hook;
+
+
+
+/* RBAR setzt mit VALID auch RNR, und RASR gilt der Region in RNR. Da
+PendSV zwischen beiden Zugriffen RNR auf 6 setzen kann, werden dabei die
+Interrupts gesperrt. */
+static void region(uint32_t n, uint32_t base, uint32_t rasr)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    MPU->RBAR = base | RBAR_VALID | n;
+    MPU->RASR = rasr;
+    __set_PRIMASK(primask);
+}
+
+
+/* Die kleinste Region, die den Code in .ramfunc abdeckt. Da .ramfunc am
+Anfang von .data liegt, wird dabei hchstens ein kleiner Teil der Daten
+ausfhrbar. */
+static void ramfunc_region(void)
+{
+    uint32_t s = (uint32_t)&_sramfunc;
+    uint32_t e = (uint32_t)&_eramfunc;
+    uint32_t size = 32, base;
+
+    if (e == s) {
+        region(4, 0, 0);
+        return;
+    }
+
+    while (1) {
+        base = s & ~(size - 1);
+        if (base + size >= e)
+            break;
+        size <<= 1;
+    }
+
+    // SIZE = log2(size) - 1
+    region(4, base, RASR_CODE | ((30 - __CLZ(size)) << 1));
+}
+
+
+
+//----------------------------------------------------------------------------
+
+void mpu_init(void)
+{
+    uint32_t n;
+
+    MPU->CTRL = 0;
+
+    region(0, 0x08000000, RASR_FLASH);
+    region(1, 0x080C0000, RASR_KV);
+    region(2, 0x20000000, RASR_SRAM);
+    region(3, 0x40000000, RASR_PERIPH);
+    ramfunc_region();
+
+    /* Der Hauptstack wchst von _estack nach unten, bis er auf .bss trifft.
+       Sein Guard liegt daher direkt hinter dem Ende von .bss (_end). */
+    region(5, ((uint32_t)&_end + MPU_GUARD_SIZE - 1) & ~(MPU_GUARD_SIZE - 1),
+           RASR_GUARD);
+
+    for (n = 6; n < 8; ++n)
+        region(n, 0, 0);
+
+    /* MEMFAULTENA (Bit 16 in SHCSR): verbotene Zugriffe lsen MemManage
+       aus statt HardFault. Im CTRL-Register schaltet ENABLE (Bit 0) die MPU
+       ein, PRIVDEFENA (Bit 2) erlaubt privilegierten Code auerhalb aller
+       Regionen die Voreinstellung. */
+    SCB->SHCSR |= 0x00010000;
+    MPU->CTRL   = 0x00000005;
+    __DSB();
+    __ISB();
+}
+
+
+
+void mpu_stack_guard(uint32_t guard[2], const void *bottom)
+{
+    guard[0] = (uint32_t)bottom | RBAR_VALID | 6;
+    guard[1] = bottom ? RASR_GUARD : 0;
+}
+
+
+
+int mpu_guard(const void *addr)
+{
+    if ((uint32_t)addr & (MPU_GUARD_SIZE - 1))
+        return 0;
+
+    region(7, (uint32_t)addr, addr ? RASR_GUARD : 0);
+    __DSB();
+    __ISB();
+
+    return 1;
+}
+
+
+
+/* Hlt den verbotenen Zugriff in mpu_fault fest. frame ist der beim
+Eintritt gesicherte Stackrahmen (r0-r3, r12, lr, pc, xPSR). */
+static void __attribute__((used, noreturn)) mpu_fault_handler(uint32_t *frame)
+{
+    uint32_t cfsr = SCB->CFSR & 0xFF;
+
+    mpu_fault.cfsr = cfsr;
+    mpu_fault.addr = (cfsr & 0x80) ? SCB->MMFAR : 0;
+
+    // MSTKERR/MUNSTKERR (Bits 4 und 3): der Stackrahmen selbst ist ungltig
+    mpu_fault.pc = (cfsr & 0x18) ? 0 : frame[6];
+
+    SCB->CFSR = cfsr;
+
+    if (mpu_fault_hook)
+        mpu_fault_hook();
+
+    while (1);
+}
+
+/* Sucht den gesicherten Stackrahmen (je nach Bit 2 von EXC_RETURN auf MSP
+oder PSP) und bergibt ihn mpu_fault_handler(). */
+__attribute__((naked)) void MemManage_Handler(void)
+{
+    __asm volatile (
+        "   tst     lr, #4              \n"
+        "   ite     eq                  \n"
+        "   mrseq   r0, msp             \n"
+        "   mrsne   r0, psp             \n"
+        "   b       mpu_fault_handler   \n"
+    );
+}
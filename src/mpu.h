@@ -0,0 +1,81 @@
+#ifndef MPU_H
+#define MPU_H
+
+/*
+ * In den Dateien mpu.h und mpu.c wird die Memory Protection Unit (MPU) des
+ * Cortex-M4 eingerichtet (s. Abschnitt 4.5 im "Cortex-M4 Devices Generic
+ * User Guide"). Die MPU prft jeden Zugriff des Prozessors anhand von bis
+ * zu 8 Regionen. Eine Region beginnt auf einer durch ihre Gre teilbaren
+ * Adresse, ist 2^n Byte gro (mindestens 32) und legt fest, ob gelesen,
+ * geschrieben oder Code ausgefhrt werden darf. berlappen sich Regionen,
+ * so gilt die mit der hheren Nummer. Ein verbotener Zugriff lst sofort
+ * die Exception MemManage aus - statt irgendwann spter seltsames
+ * Verhalten zu zeigen.
+ *
+ * Die Regionen:
+ *
+ *   0  Flash-Speicher (1MB)        nur lesen, ausfhrbar
+ *   1  Sektoren 10 und 11          lesen und schreiben (kvstore.c)
+ *   2  SRAM (128KB)                lesen und schreiben, nicht ausfhrbar
+ *   3  Peripherie (0x40000000)     "device memory", nicht ausfhrbar
+ *   4  Abschnitt .ramfunc          ausfhrbar (flash.c)
+ *   5  Guard des Hauptstacks       kein Zugriff
+ *   6  Guard des laufenden Threads kein Zugriff (s. kernel.c)
+ *   7  Guard nach Wahl             kein Zugriff (s. mpu_guard())
+ *
+ * Region 3 umfasst 512MB ab 0x40000000 und damit auch den Bit-Band-Alias
+ * der Peripherie (0x42000000). Alles andere (z.B. CCM-RAM, der Bit-Band-
+ * Alias des SRAM ab 0x22000000, Systemregister) behlt die Voreinstellung
+ * ("default memory map"), das Programm luft ja privilegiert.
+ *
+ * Ein "Guard" ist ein 32 Byte groer Bereich, auf den niemand zugreifen
+ * darf. Am unteren Ende eines Stacks fngt er einen Stackberlauf ab,
+ * bevor darunter liegende Daten zerstrt werden. Beim Threadwechsel stellt
+ * PendSV_Handler Region 6 auf den Stack des neuen Threads um - das sind
+ * nur zwei Speicherzugriffe.
+ *
+ * Achtung: Die MPU prft nur Zugriffe des Prozessors, nicht die der DMA-
+ * Controller. Ein Guard hinter einem DMA-Puffer fngt also Schleifen des
+ * Programms ab, die ber das Ende hinaus schreiben, nicht aber einen zu
+ * lang eingestellten DMA-Transfer.
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+// Gre eines Guards (kleinste Region der MPU)
+#define MPU_GUARD_SIZE  32
+
+// Informationen ber den letzten verbotenen Zugriff
+typedef struct
+{
+    uint32_t cfsr;      // SCB->CFSR, MemManage-Bits 0 bis 7
+    uint32_t addr;      // Adresse des Zugriffs (0 falls unbekannt)
+    uint32_t pc;        // Befehl, der ihn ausgelst hat (0 falls unbekannt)
+} mpu_fault_t;
+
+extern volatile mpu_fault_t mpu_fault;
+
+/* Wird nach einem verbotenen Zugriff in MemManage_Handler aufgerufen, falls
+gesetzt. Die Funktion sollte nicht zurckkehren - danach bleibt das
+Programm ohnehin stehen. */
+typedef void (*mpu_fault_fn)(void);
+extern mpu_fault_fn mpu_fault_hook;
+
+/* Richtet die Regionen 0 bis 5 ein und schaltet die MPU ein. */
+void mpu_init(void);
+
+/* Berechnet die Werte fr Region 6 (RBAR, RASR), die PendSV_Handler beim
+Wechsel zu einem Thread mit dem Stack ab bottom schreibt. bottom muss auf
+MPU_GUARD_SIZE ausgerichtet sein, 0 ergibt eine abgeschaltete Region. */
+void mpu_stack_guard(uint32_t guard[2], const void *bottom);
+
+/* Legt Region 7 auf die 32 Byte ab addr, z.B. direkt hinter einen Puffer.
+addr muss auf MPU_GUARD_SIZE ausgerichtet sein. Liefert sonst 0, mit 0 wird
+der Guard entfernt. */
+int mpu_guard(const void *addr);
+
+#endif
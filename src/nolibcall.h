@@ -0,0 +1,19 @@
+#ifndef NOLIBCALL_H
+#define NOLIBCALL_H
+
+/*
+ * gcc erkennt Kopier- und Fllschleifen und ersetzt sie ggf. durch einen
+ * Aufruf von memcpy bzw. memset. Die Standardbibliothek wird aber nicht
+ * gelinkt (s. /DISCARD/ in stm32_sections.ld), der Aufruf ginge also ins
+ * Leere. Funktionen mit solchen Schleifen werden daher mit NO_LIBCALL
+ * markiert, das diese Optimierung fr sie abschaltet:
+ *
+ *     NO_LIBCALL void dma_fill_cpu(void *dst, uint8_t value, uint32_t len)
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+#define NO_LIBCALL  __attribute__((optimize("no-tree-loop-distribute-patterns")))
+
+#endif
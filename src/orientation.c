@@ -0,0 +1,199 @@
+/*
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+*/
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "orientation.h"
+
+// u.a. Definition der Hardwareregister des STM32F4
+#include "libfoo/stm32f4xx.h"
+
+
+/* Das CORDIC-Verfahren (COordinate Rotation DIgital Computer) dreht einen
+Vektor in mehreren Schritten so lange, bis er auf der x-Achse liegt. In
+Schritt i wird hierbei immer um den Winkel atan(2^-i) gedreht - entweder
+im oder gegen den Uhrzeigersinn, je nach Vorzeichen von y. Die Drehung um
+genau diese Winkel kommt ohne Multiplikation aus, da sich die Multiplikation
+mit 2^-i als einfache Schiebeoperation schreiben lsst. Die Summe der
+Drehwinkel ergibt am Ende den gesuchten Winkel atan2(y, x), und die
+x-Koordinate enthlt den Betrag des Vektors - allerdings gestreckt um den
+konstanten Faktor K = 1.6468. Die Winkel atan(2^-i) legen wir in einer
+kleinen Tabelle ab (in 1/256 Grad): */
+
+#define CORDIC_STEPS 15
+
+static const int32_t cordicAngles[CORDIC_STEPS] = {
+    11520, 6801, 3593, 1824, 916, 458, 229, 115, 57, 29, 14, 7, 4, 2, 1
+};
+
+/* 1/K als Festkommazahl mit 16 Nachkommastellen (0.60725 * 65536): */
+#define CORDIC_INV_GAIN 39797
+
+
+volatile uint32_t orientation_samples = 0;
+volatile uint32_t orientation_updates = 0;
+
+// gefilterter Vektor (8 Nachkommastellen)
+static int32_t filt[3];
+// Vektor, mit dem zuletzt die Winkel berechnet wurden
+static int32_t last[3];
+
+static int32_t roll  = 0;
+static int32_t pitch = 0;
+
+
+
+int32_t orientation_atan2(int32_t y, int32_t x, int32_t *mag)
+{
+    int32_t z = 0;
+    int32_t i, xn;
+
+    /* CORDIC konvergiert nur fr Winkel zwischen -99 und +99 Grad. Liegt
+       der Vektor in der linken Halbebene, drehen wir ihn vorab um 180 Grad
+       (durch einfache Negation) und merken uns diese Drehung in z: */
+    if (x < 0) {
+        z = (y >= 0) ? ORIENTATION_DEG(180) : -ORIENTATION_DEG(180);
+        x = -x;
+        y = -y;
+    }
+
+    for (i = 0; i < CORDIC_STEPS; ++i) {
+        if (y > 0) {
+            xn = x + (y >> i);
+            y  = y - (x >> i);
+            z += cordicAngles[i];
+        } else {
+            xn = x - (y >> i);
+            y  = y + (x >> i);
+            z -= cordicAngles[i];
+        }
+        x = xn;
+    }
+
+    if (mag)
+        *mag = (int32_t)(((int64_t)x * CORDIC_INV_GAIN) >> 16);
+
+    return z;
+}
+
+
+
+/* Helligkeit einer LED aus dem Betrag eines Winkels: 0 Grad = aus,
+   90 Grad (oder mehr) = volle Helligkeit (ARR = 1000). Die Division durch
+   23040 (90 Grad) wird durch Multiplikation mit 711/16384 ersetzt: */
+static uint32_t angle_to_ccr(int32_t angle)
+{
+    uint32_t v;
+
+    if (angle < 0)
+        angle = -angle;
+    v = ((uint32_t)angle * 711) >> 14;
+
+    return (v > 1000) ? 1000 : v;
+}
+
+
+
+void orientation_init(void)
+{
+    int i;
+
+    /* Die Konfiguration von PD12 bis PD15 und Timer 4 entspricht genau der
+       aus pwm_led_example() in discovery_ex.c. Details siehe dort: */
+
+    GPIOD->MODER   &= 0x00FFFFFF;
+    GPIOD->MODER   |= 0xAA000000;
+    GPIOD->OTYPER  &= 0xFFFF0FFF;
+    GPIOD->OSPEEDR &= 0x00FFFFFF;
+    GPIOD->OSPEEDR |= 0xAA000000;
+    GPIOD->PUPDR   &= 0x00FFFFFF;
+    GPIOD->AFR[1]  &= 0x0000FFFF;
+    GPIOD->AFR[1]  |= 0x22220000;
+
+    RCC->APB1ENR |= 0x00000004;
+
+    TIM4->CR1    &= 0xFC00;
+    TIM4->PSC     = 42;
+    TIM4->ARR     = 1000;
+    TIM4->CCMR1   = 0x6868;
+    TIM4->CCMR2   = 0x6868;
+    TIM4->CCER   &= 0x4444;
+    TIM4->CCER   |= 0x1111;
+    TIM4->CCR1    = 0;
+    TIM4->CCR2    = 0;
+    TIM4->CCR3    = 0;
+    TIM4->CCR4    = 0;
+    TIM4->EGR    |= 1;
+    TIM4->CR1    |= 1;
+
+    for (i = 0; i < 3; ++i) {
+        filt[i] = 0;
+        last[i] = 0;
+    }
+    roll  = 0;
+    pitch = 0;
+}
+
+
+
+int orientation_update(const int8_t xyz[3])
+{
+    int32_t diff = 0;
+    int32_t d, r;
+    int i;
+
+    ++orientation_samples;
+
+    /* Einfacher Tiefpass erster Ordnung: filt += (neu - filt) / 2^n. Die
+       Rohwerte werden dafr um 8 Bit nach links geschoben, damit beim
+       Filtern keine Nachkommastellen verloren gehen. Nebenbei summieren wir
+       die Abweichung zum Vektor der letzten Berechnung auf: */
+    for (i = 0; i < 3; ++i) {
+        filt[i] += (((int32_t)xyz[i] << 8) - filt[i]) >> ORIENTATION_FILTER_SHIFT;
+        d = filt[i] - last[i];
+        diff += (d < 0) ? -d : d;
+    }
+
+    /* Hat sich der Vektor kaum verndert, bleibt alles beim Alten. Dies ist
+       bei einem ruhig liegenden board fast immer der Fall: */
+    if (diff <= ORIENTATION_THRESHOLD)
+        return 0;
+
+    for (i = 0; i < 3; ++i)
+        last[i] = filt[i];
+
+    /* roll = atan2(y, z). Der gleiche CORDIC-Durchlauf liefert uns als
+       "Abfallprodukt" den Betrag r = sqrt(y^2 + z^2), den wir direkt fr
+       pitch = atan2(-x, r) weiterverwenden knnen: */
+    roll  = orientation_atan2(filt[1], filt[2], &r);
+    pitch = orientation_atan2(-filt[0], r, 0);
+
+    /* Anzeige ber die LEDs: roll steuert das Paar orange (PD13) / blau
+       (PD15), pitch das Paar grn (PD12) / rot (PD14). Es leuchtet jeweils
+       die LED auf der Seite, zu der das board geneigt ist: */
+    TIM4->CCR2 = (roll  > 0) ? angle_to_ccr(roll)  : 0;
+    TIM4->CCR4 = (roll  < 0) ? angle_to_ccr(roll)  : 0;
+    TIM4->CCR3 = (pitch > 0) ? angle_to_ccr(pitch) : 0;
+    TIM4->CCR1 = (pitch < 0) ? angle_to_ccr(pitch) : 0;
+
+    ++orientation_updates;
+
+    return 1;
+}
+
+
+
+int32_t orientation_roll(void)
+{
+    return roll;
+}
+
+
+
+int32_t orientation_pitch(void)
+{
+    return pitch;
+}
@@ -0,0 +1,53 @@
+#ifndef ORIENTATION_H
+#define ORIENTATION_H
+
+/*
+ * In den Dateien orientation.h und orientation.c wird aus den Rohdaten
+ * des Beschleunigungssensors die Neigung (roll und pitch) des boards
+ * bestimmt und ber die 4 LEDs angezeigt. Die Winkel werden hierbei ohne
+ * atan2() und sqrt() mit dem CORDIC-Verfahren in Festkommaarithmetik
+ * berechnet.
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+// Alle Winkel werden in 1/256 Grad angegeben, d.h. 90 Grad = 23040
+#define ORIENTATION_DEG(d)       ((int32_t)(d) * 256)
+
+// Strke des Tiefpassfilters auf den Rohdaten (Glttung um 1/2^n)
+#define ORIENTATION_FILTER_SHIFT 3
+
+// Mindestnderung des gefilterten Vektors (Summe der Betrge, 8 Bit
+// Nachkommastellen), ab der die Winkel neu berechnet werden
+#define ORIENTATION_THRESHOLD    (2 * 256)
+
+/* Die Methode orientation_init() konfiguriert Timer 4 als PWM-Generator fr
+die LEDs an PD12 bis PD15 (wie in pwm_led_example()) und setzt den Filter
+zurck. */
+void orientation_init(void);
+
+/* Die Methode orientation_update() bernimmt eine neue Messung (x, y, z)
+des LIS302DL. Die Winkel und die LEDs werden nur dann neu berechnet, wenn
+sich der gefilterte Vektor seit der letzten Berechnung um mehr als
+ORIENTATION_THRESHOLD verndert hat. Rckgabewert ist 1, falls neu
+berechnet wurde, sonst 0. */
+int orientation_update(const int8_t xyz[3]);
+
+/* Liefert die zuletzt berechneten Winkel (in 1/256 Grad). */
+int32_t orientation_roll(void);
+int32_t orientation_pitch(void);
+
+/* CORDIC im "vectoring mode": liefert atan2(y, x) in 1/256 Grad im Bereich
+-180 bis +180 Grad. Falls mag nicht 0 ist, wird dort zustzlich der Betrag
+sqrt(x^2 + y^2) abgelegt. */
+int32_t orientation_atan2(int32_t y, int32_t x, int32_t *mag);
+
+// Anzahl der bergebenen Messungen und der tatschlichen Neuberechnungen
+extern volatile uint32_t orientation_samples;
+extern volatile uint32_t orientation_updates;
+
+#endif
@@ -0,0 +1,230 @@
+/*
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+*/
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "power.h"
+#include "swtimer.h"
+#include "cycles.h"
+#include "rcc.h"
+
+// u.a. Definition der Hardwareregister des STM32F4
+#include "libfoo/stm32f4xx.h"
+
+
+/* Die RTC teilt den Takt des LSI zunchst durch PREDIV_A + 1 und zhlt
+damit das Register SSR von PREDIV_S bis 0 herunter, dann folgt die nchste
+Sekunde in TR. Mit 4 und 8000 ergeben sich Schritte von 125us, die fr die
+Messung der Schlafzeit dienen. */
+#define PREDIV_A    3
+#define PREDIV_S    7999
+#define RTC_STEPS   (3600UL * (PREDIV_S + 1))   // eine Stunde
+
+volatile power_stats_t power_stats;
+
+static uint8_t           ready;     // power_init() ist gelaufen
+static volatile uint32_t holds;
+static uint32_t          stepHz;    // Takt des Zhlers SSR
+
+
+
+/* Stand der RTC in Schritten seit Beginn der Stunde. BYPSHAD ist gesetzt,
+die Register werden also direkt gelesen - und zweimal, falls SSR gerade in
+die nchste Sekunde bergeht. */
+static uint32_t rtc_steps(void)
+{
+    uint32_t ss, tr;
+
+    do {
+        ss = RTC->SSR;
+        tr = RTC->TR;
+    } while (ss != RTC->SSR);
+
+    // Sekunden und Minuten sind BCD-kodiert
+    tr = (tr & 0x0F) + ((tr >> 4) & 0x07) * 10 +
+         (((tr >> 8) & 0x0F) + ((tr >> 12) & 0x07) * 10) * 60;
+
+    return tr * (PREDIV_S + 1) + (PREDIV_S - ss);
+}
+
+static uint32_t steps_since(uint32_t s0)
+{
+    return (rtc_steps() + RTC_STEPS - s0) % RTC_STEPS;
+}
+
+
+static void sleep(void)
+{
+    ++power_stats.sleeps;
+    __WFI();
+}
+
+
+/* Schlft hchstens us Mikrosekunden im Stop mode. */
+static void stop(uint32_t us)
+{
+    uint32_t wut, s0, t0, c0, ran, slept;
+
+    /* Der Wakeup-Timer zhlt mit LSI / 16 (WUCKSEL = 000), also mit einem
+       Viertel von stepHz. Er lst nach WUTR + 1 Schritten aus. */
+    wut = (uint32_t)(((uint64_t)us * stepHz) / 4000000);
+    if (wut > 0x10000)
+        wut = 0x10000;
+
+    // WUTR darf nur bei abgeschaltetem Timer geschrieben werden (WUTWF)
+    RTC->CR &= ~0x00000400;
+    while (!(RTC->ISR & 0x00000004));
+    RTC->WUTR = wut - 1;
+    RTC->ISR &= ~0x00000400;            // WUTF lschen
+    EXTI->PR  = 0x00400000;
+    RTC->CR  |= 0x00004400;             // WUTIE, WUTE
+
+    s0 = rtc_steps();
+    t0 = swtimer_now();
+
+    /* LPDS (Bit 0): Spannungsregler im Stromsparbetrieb, FPDS (Bit 9):
+       Flash-Speicher abschalten. Beides verlngert das Aufwachen etwas. */
+    PWR->CR   |= 0x00000201;
+    SCB->SCR  |= 0x00000004;            // SLEEPDEEP
+    __DSB();
+    __WFI();
+    c0 = cycles_now();
+    SCB->SCR  &= ~0x00000004;
+
+    // Stand vor dem WFI schon ein Interrupt an, luft noch die PLL
+    if ((RCC->CFGR & 0x0000000C) != 0x00000008) {
+        rcc_init();
+        power_stats.wakeCycles = cycles_now() - c0;
+        if (power_stats.wakeCycles > power_stats.wakeMax)
+            power_stats.wakeMax = power_stats.wakeCycles;
+    }
+
+    RTC->CR &= ~0x00004400;
+    if (!(RTC->ISR & 0x00000400))
+        ++power_stats.early;
+
+    /* Timer 2 ist nur gelaufen, solange der Prozessor wach war. Den Rest
+       der mit der RTC gemessenen Zeit holt er jetzt nach. */
+    slept = (uint32_t)(((uint64_t)steps_since(s0) * 1000000) / stepHz);
+    ran   = swtimer_now() - t0;
+    if (slept > ran) {
+        swtimer_skip(slept - ran);
+        power_stats.stopUs += slept - ran;
+    }
+
+    ++power_stats.stops;
+}
+
+
+
+//----------------------------------------------------------------------------
+
+void power_init(void)
+{
+    uint32_t s0, t0, t1;
+
+    RCC->APB1ENR |= 0x10000000;         // PWR mit Takt versorgen
+    PWR->CR      |= 0x00000100;         // DBP: Zugriff auf die Backup-Domain
+
+    // LSI einschalten (Bit 0 in RCC_CSR) und warten, bis er luft (Bit 1)
+    RCC->CSR |= 0x00000001;
+    while (!(RCC->CSR & 0x00000002));
+
+    /* RTCSEL (Bits 8 und 9) lsst sich nur nach einem Reset der Backup-
+       Domain (BDRST, Bit 16) ndern. 10 whlt den LSI, RTCEN (Bit 15)
+       schaltet die RTC ein. */
+    if ((RCC->BDCR & 0x00008300) != 0x00008200) {
+        RCC->BDCR = 0x00010000;
+        RCC->BDCR = 0x00000000;
+        RCC->BDCR = 0x00008200;
+    }
+
+    // Schreibschutz der RTC aufheben
+    RTC->WPR = 0xCA;
+    RTC->WPR = 0x53;
+
+    // INIT (Bit 7) hlt die Uhr an, INITF (Bit 6) besttigt das
+    RTC->ISR = 0x00000080;
+    while (!(RTC->ISR & 0x00000040));
+    RTC->PRER = PREDIV_S;
+    RTC->PRER = (PREDIV_A << 16) | PREDIV_S;
+    RTC->TR   = 0;
+    RTC->CR   = 0x00000020;             // BYPSHAD, WUCKSEL = RTC / 16
+    RTC->ISR  = 0x00000000;
+
+    // Wakeup-Timer: EXTI 22, steigende Flanke, Interrupt Nummer 3
+    EXTI->IMR  |= 0x00400000;
+    EXTI->RTSR |= 0x00400000;
+    NVIC->ISER[0] = 0x00000008;
+
+    /* Frequenz des LSI messen: 800 Schritte (etwa 100ms) mit Timer 2
+       (1MHz) vergleichen, beginnend direkt nach einem Schritt. */
+    s0 = rtc_steps();
+    while (rtc_steps() == s0);
+    s0 = rtc_steps();
+    t0 = swtimer_now();
+    while (steps_since(s0) < 800);
+    t1 = swtimer_now();
+
+    stepHz = (uint32_t)(800ULL * 1000000 / (t1 - t0));
+    power_stats.lsiHz = stepHz * (PREDIV_A + 1);
+
+    // holds bleibt: die Treiber drfen schon vorher power_hold() aufrufen
+    ready = 1;
+}
+
+
+
+void power_hold(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    ++holds;
+    __set_PRIMASK(primask);
+}
+
+
+
+void power_release(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    --holds;
+    __set_PRIMASK(primask);
+}
+
+
+
+void power_idle(void)
+{
+    uint32_t delay;
+
+    if (!ready || holds) {
+        sleep();
+        return;
+    }
+
+    // ohne laufenden Timer weckt nur ein anderer Interrupt
+    if (!swtimer_next(&delay) || delay > POWER_STOP_MAX)
+        delay = POWER_STOP_MAX;
+
+    if (delay < POWER_STOP_MIN) {
+        sleep();
+        return;
+    }
+
+    stop(delay - POWER_WAKE_US);
+}
+
+
+
+void RTC_WKUP_IRQHandler(void)
+{
+    RTC->ISR &= ~0x00000400;
+    EXTI->PR  = 0x00400000;
+}
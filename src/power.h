@@ -0,0 +1,79 @@
+#ifndef POWER_H
+#define POWER_H
+
+/*
+ * In den Dateien power.h und power.c findet sich die Auswahl des Strom-
+ * sparmodus, wenn der Scheduler (sched.c) nichts zu tun hat. Der STM32F4
+ * kennt u.a. zwei Arten zu schlafen (s. "Power control" in [1]):
+ *
+ *  - Sleep mode (WFI): Nur der Takt des Prozessors steht, alle Peripherien
+ *    laufen weiter. Jeder Interrupt weckt ihn im nchsten Takt wieder.
+ *  - Stop mode (WFI mit SLEEPDEEP): Alle Takte im 1.2V-Bereich stehen, auch
+ *    HSE und PLL. Der Inhalt von RAM und Registern bleibt erhalten, der
+ *    Stromverbrauch sinkt aber von einigen mA auf einige 100uA. Wecken
+ *    knnen ihn nur Interrupts ber die EXTI-Leitungen, z.B. der Taster an
+ *    PA0 oder der Wakeup-Timer der RTC (EXTI 22). Danach luft der
+ *    Prozessor mit dem HSI (16MHz), rcc_init() muss also erneut laufen.
+ *
+ * Da auch Timer 2 im Stop mode steht, laufen die Software-Timer (swtimer.c)
+ * nicht ab. Vor dem Stop mode wird daher der Wakeup-Timer der RTC auf den
+ * nchsten Zeitpunkt gestellt, zu dem ein Software-Timer abluft, und
+ * danach Timer 2 um die verschlafene Zeit vorgestellt. Die RTC luft mit
+ * dem internen 32kHz-Oszillator LSI (das discovery board hat keinen Uhren-
+ * quarz), dessen Frequenz bei power_init() mit Timer 2 gemessen wird.
+ *
+ * Der Stop mode lohnt sich nur, wenn bis zum nchsten Timer mehr Zeit
+ * bleibt, als das Aufwachen kostet - sonst wird nur WFI verwendet. Das
+ * gilt auch, solange jemand power_hold() aufgerufen hat. Die Treiber mit
+ * DMA-Transfers tun das selbst: uart.c beim Senden und fr die gesamte
+ * Dauer des Empfangs, spi_bus.c und dma_copy.c, solange Auftrge laufen,
+ * und pwm_burst.c, solange eine Tabelle abgespielt wird.
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "swtimer.h"
+
+/* Krzere Pausen verbringt der Prozessor im Sleep mode. Das Aufwachen aus
+dem Stop mode dauert etwa 1ms (vor allem das Anlaufen von HSE und PLL). */
+#define POWER_STOP_MIN  SWTIMER_MS(5)
+
+// So viel frher weckt die RTC, um rechtzeitig wieder bereit zu sein
+#define POWER_WAKE_US   SWTIMER_MS(2)
+
+// lngster Stop mode (Grenze des Wakeup-Timers bei LSI / 16)
+#define POWER_STOP_MAX  SWTIMER_MS(30000)
+
+// Statistik, z.B. zur Betrachtung im Debugger
+typedef struct
+{
+    uint32_t sleeps;        // Sleep mode
+    uint32_t stops;         // Stop mode
+    uint32_t early;         // davon durch einen anderen Interrupt beendet
+    uint32_t stopUs;        // Summe der Zeit im Stop mode in us
+    uint32_t wakeCycles;    // Takte von WFI bis zum Ende von rcc_init()
+    uint32_t wakeMax;       // ... hchster Wert
+    uint32_t lsiHz;         // gemessene Frequenz des LSI
+} power_stats_t;
+
+extern volatile power_stats_t power_stats;
+
+/* Richtet die RTC samt Wakeup-Timer ein und misst die Frequenz des LSI
+(dauert etwa 100ms). Der Scheduler muss zuvor mit sched_init() initiali-
+siert worden sein. Ohne power_init() verwendet power_idle() nur WFI. */
+void power_init(void);
+
+/* Verbietet bzw. erlaubt wieder den Stop mode. Die Aufrufe werden gezhlt,
+jedes power_hold() braucht also ein power_release(). */
+void power_hold(void);
+void power_release(void);
+
+/* Legt den Prozessor im tiefsten Modus schlafen, der zum nchsten Software-
+Timer passt. Wird von sched_run() mit gesperrten Interrupts aufgerufen. */
+void power_idle(void);
+
+#endif
@@ -0,0 +1,298 @@
+/*
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+*/
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "pwm_burst.h"
+#include "gpio.h"
+#include "dma.h"
+#include "power.h"
+
+// u.a. Definition der Hardwareregister des STM32F4
+#include "libfoo/stm32f4xx.h"
+
+
+/* Das Register DCR legt fest, wohin DMAR-Zugriffe umgeleitet werden: DBA
+(Bits 0 bis 4) ist die Adresse des ersten Zielregisters in 32-Bit Worten ab
+dem Beginn des Timers, DBL (Bits 8 bis 12) die Anzahl der Register minus 1.
+CCR1 liegt bei Offset 0x34, also DBA = 0x34 / 4 = 13, und bei 4 Kanlen
+ist DBL = 3.
+
+Fordert der Timer beim Update einen DMA-Transfer an, so schreibt der DMA-
+Controller den ersten Wert nach DMAR, der Timer leitet ihn nach CCR1 weiter
+und fordert sofort den nchsten Transfer an - so lange, bis alle Register
+beschrieben sind. Fr den DMA-Controller sind das ganz gewhnliche Einzel-
+transfers ber einen einzigen Stream. */
+#define PWM_BURST_DBA  13
+
+/* Konfiguration des Streams wie in dma_pwm_led_example() (ohne den Kanal,
+den dma_claim() in dma.chsel liefert): 16-Bit in Speicher und Peripherie,
+MINC, circular mode, Memory-to-peripheral. Dazu kommt der "double buffer
+mode" (DBM, Bit 18): Der Stream hat zwei Speicheradressen M0AR und M1AR und
+wechselt am Ende jedes Durchlaufs zwischen ihnen. Bit 19 (CT) zeigt an,
+welche gerade benutzt wird. Die jeweils andere darf whrenddessen
+beschrieben werden - so wird die nchste Tabelle eingereiht, ohne den
+Stream anzuhalten. */
+#define PWM_BURST_CR   0x00042D40
+#define PWM_BURST_CT   0x00080000
+#define PWM_BURST_TCIE 0x00000010
+
+volatile pwm_burst_stats_t pwm_burst_stats;
+
+// TIM4_UP gibt es nur an DMA1 Stream 6 Kanal 2 (Tabelle 20 in [1])
+static dma_stream_t dma;
+static void pwm_burst_irq(dma_stream_t *s);
+
+static uint8_t   channels = PWM_BURST_CHANNELS;
+static uint16_t  curCount;                  // frames der laufenden Tabelle
+static const uint16_t *nextFrames;
+static uint16_t  nextCount;
+static volatile uint8_t pending;
+static pwm_burst_fill_fn streamFill;
+static uint8_t   held;                      // power_hold() fr den Stream
+
+
+
+/* Im Stop mode stnden Timer 4 und der Stream still, die LEDs blieben auf
+dem gerade aktuellen frame stehen. Solange eine Tabelle luft, ist der Stop
+mode daher verboten. */
+static void stream_disable(void)
+{
+    dma_disable(&dma);
+    dma_clear(&dma, DMA_FLAG_ALL);
+
+    if (held) {
+        held = 0;
+        power_release();
+    }
+}
+
+static void stream_start(const uint16_t *frames, const uint16_t *frames1,
+                         uint16_t count, uint32_t cr)
+{
+    dma.stream->PAR  = (uint32_t)&TIM4->DMAR;
+    dma.stream->M0AR = (uint32_t)frames;
+    dma.stream->M1AR = (uint32_t)frames1;
+    dma.stream->NDTR = (uint32_t)count * channels;
+    dma.stream->FCR  = 0x00000021;    // direct mode (Reset-Wert)
+    dma.stream->CR   = dma.chsel | cr;
+    dma.stream->CR  |= 0x00000001;
+
+    curCount = count;
+
+    if (!held) {
+        held = 1;
+        power_hold();
+    }
+}
+
+/* Schreibt die gerade nicht benutzte Speicheradresse. */
+static void set_idle_buffer(const uint16_t *frames)
+{
+    if (dma.stream->CR & PWM_BURST_CT)
+        dma.stream->M0AR = (uint32_t)frames;
+    else
+        dma.stream->M1AR = (uint32_t)frames;
+}
+
+static const uint16_t *active_buffer(void)
+{
+    if (dma.stream->CR & PWM_BURST_CT)
+        return (const uint16_t*)dma.stream->M1AR;
+    return (const uint16_t*)dma.stream->M0AR;
+}
+
+
+
+//----------------------------------------------------------------------------
+
+void pwm_burst_init(uint16_t psc, uint16_t arr, uint8_t channels_)
+{
+    if (channels_ < 1)
+        channels_ = 1;
+    if (channels_ > PWM_BURST_CHANNELS)
+        channels_ = PWM_BURST_CHANNELS;
+    channels = channels_;
+
+    // PD12 bis PD15: Alternate Function 2 (TIM4_CH1 bis TIM4_CH4)
+    GPIO_CONFIGURE(GPIOD,
+        GPIO_PIN(12) | GPIO_PIN(13) | GPIO_PIN(14) | GPIO_PIN(15),
+        GPIO_MODE_AF | GPIO_PP | GPIO_50MHZ | GPIO_NOPULL | GPIO_AF(2));
+
+    RCC->APB1ENR |= 0x00000004;     // Timer 4 mit Takt versorgen
+
+    // Stream holen (versorgt DMA1 mit Takt und schaltet den Interrupt frei)
+    if (!dma.stream) {
+        dma.fn = pwm_burst_irq;
+        if (!dma_claim(DMA_REQ_TIM4_UP, &dma))
+            while (1);
+    }
+
+    TIM4->CR1   = 0x0080;           // Up-Counter, ARR gepuffert (ARPE)
+    TIM4->PSC   = psc;
+    TIM4->ARR   = arr;
+    TIM4->CCMR1 = 0x6868;           // PWM mode 1, CCR gepuffert (OCxPE)
+    TIM4->CCMR2 = 0x6868;
+    TIM4->CCER  = 0x1111 & (0xFFFF >> (16 - 4 * channels));
+    TIM4->CCR1  = 0;
+    TIM4->CCR2  = 0;
+    TIM4->CCR3  = 0;
+    TIM4->CCR4  = 0;
+    TIM4->DCR   = ((channels - 1) << 8) | PWM_BURST_DBA;
+    TIM4->DIER  = 0x0000;
+    TIM4->EGR   = 0x0001;           // Prescaler und Compare-Werte bernehmen
+    TIM4->SR    = 0x0000;
+    TIM4->CR1  |= 0x0001;
+}
+
+
+
+void pwm_burst_rate(uint16_t psc, uint16_t arr)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    /* PSC ist immer gepuffert, ARR dank ARPE ebenfalls. Beide Schreib-
+       zugriffe folgen direkt aufeinander, damit kein Update dazwischen
+       fllt. */
+    __disable_irq();
+    TIM4->PSC = psc;
+    TIM4->ARR = arr;
+    __set_PRIMASK(primask);
+}
+
+
+
+void pwm_burst_play(const uint16_t *frames, uint16_t count)
+{
+    pwm_burst_stop();
+
+    stream_start(frames, frames, count, PWM_BURST_CR);
+
+    // Update DMA request (UDE, Bit 8) ein
+    TIM4->DIER = 0x0100;
+}
+
+
+
+void pwm_burst_stream(uint16_t *buf0, uint16_t *buf1, uint16_t count,
+                      pwm_burst_fill_fn fill)
+{
+    pwm_burst_stop();
+
+    fill(buf0, count);
+    fill(buf1, count);
+    streamFill = fill;
+
+    /* Hier wird der double buffer mode so genutzt, wie er gedacht ist: Der
+       Stream wechselt zwischen zwei verschiedenen Puffern, und der gerade
+       nicht benutzte wird im Interrupt "transfer complete" neu gefllt. */
+    stream_start(buf0, buf1, count, PWM_BURST_CR | PWM_BURST_TCIE);
+
+    TIM4->DIER = 0x0100;
+}
+
+
+
+void pwm_burst_queue(const uint16_t *frames, uint16_t count)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+
+    nextFrames = frames;
+    nextCount  = count;
+    pending    = 1;
+
+    /* Bei gleicher Lnge kann die neue Tabelle sofort in die nicht benutzte
+       Speicheradresse geschrieben werden - allerdings nur, solange der
+       Stream nicht gerade im letzten frame steht. Der Wechsel geschieht
+       frhestens beim nchsten Update, also mindestens eine PWM-Periode
+       nach der Prfung von NDTR. Andernfalls erledigt das die Interrupt-
+       routine am Ende des Durchlaufs. */
+    if (count == curCount && dma.stream->NDTR > channels)
+        set_idle_buffer(frames);
+
+    dma.stream->CR |= PWM_BURST_TCIE;
+
+    __set_PRIMASK(primask);
+}
+
+
+
+int pwm_burst_pending(void)
+{
+    return pending;
+}
+
+
+
+void pwm_burst_stop(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    if (!dma.stream)
+        return;
+
+    /* Der Stream darf nicht mitten in einem burst angehalten werden, sonst
+       beginnt der nchste burst nicht bei CCR1. Nach einem vollstndigen
+       burst ist NDTR ein Vielfaches der Kanalzahl - der nchste folgt erst
+       mit dem nchsten Update, also frhestens eine PWM-Periode spter. */
+    __disable_irq();
+    if (dma.stream->CR & 0x00000001)
+        while (dma.stream->NDTR % channels);
+    TIM4->DIER = 0x0000;
+    pending    = 0;
+    streamFill = 0;
+    __set_PRIMASK(primask);
+
+    stream_disable();
+}
+
+
+
+/* Der Interrupt "transfer complete" kommt am Ende eines Durchlaufs, wenn
+der Stream gerade auf die andere Speicheradresse gewechselt hat. Er ist nur
+eingeschaltet, solange eine Tabelle eingereiht ist oder pwm_burst_stream()
+luft. */
+static void pwm_burst_irq(dma_stream_t *s)
+{
+    dma_clear(&dma, DMA_FLAG_TC);
+    pwm_burst_stats.irqs++;
+
+    if (streamFill) {
+        streamFill((uint16_t*)(dma.stream->CR & PWM_BURST_CT
+                               ? dma.stream->M0AR : dma.stream->M1AR),
+                   curCount);
+        return;
+    }
+
+    if (!pending) {
+        dma.stream->CR &= ~PWM_BURST_TCIE;
+        return;
+    }
+
+    if (nextCount != curCount) {
+        /* Bei anderer Lnge muss NDTR neu gesetzt werden, und das geht nur
+           bei abgeschaltetem Stream. Der nchste Transfer folgt erst mit
+           dem nchsten Update - solange die Interruptroutine schneller ist
+           als eine PWM-Periode, entsteht also keine Lcke. */
+        stream_disable();
+        stream_start(nextFrames, nextFrames, nextCount, PWM_BURST_CR);
+        pwm_burst_stats.restarts++;
+    } else if (active_buffer() != nextFrames) {
+        /* Die neue Tabelle konnte in pwm_burst_queue() nicht mehr eingetragen
+           werden. Das geschieht jetzt, sie luft ab dem nchsten Wechsel. */
+        set_idle_buffer(nextFrames);
+        return;
+    } else {
+        // Die neue Tabelle luft - sie soll auch nach dem nchsten Wechsel laufen
+        set_idle_buffer(nextFrames);
+        dma.stream->CR &= ~PWM_BURST_TCIE;
+    }
+
+    pending = 0;
+    pwm_burst_stats.swaps++;
+}
@@ -0,0 +1,87 @@
+#ifndef PWM_BURST_H
+#define PWM_BURST_H
+
+/*
+ * In den Dateien pwm_burst.h und pwm_burst.c findet sich eine Ansteuerung
+ * der 4 LEDs des discovery boards (PD12 bis PD15) per PWM ber Timer 4, bei
+ * der die Compare-Werte aller Kanle per DMA nachgeladen werden. Anders als
+ * im Beispiel dma_pwm_led_example() (4 Streams, ausgelst von Timer 3)
+ * gengt hierfr ein einziger Stream: Timer 4 fordert bei jedem Update selbst
+ * einen DMA-Transfer an und leitet diesen ber das Register DMAR der Reihe
+ * nach auf CCR1 bis CCR4 um ("DMA burst", Register TIMx_DCR und TIMx_DMAR
+ * in Kapitel 18 von [1]).
+ *
+ * Die Werte liegen im Speicher als "frames" zu je einem Wert pro Kanal
+ * hintereinander (bei 4 Kanlen CCR1, CCR2, CCR3, CCR4, CCR1, ...). Pro PWM-
+ * Periode wird ein frame bernommen. Eine solche Tabelle beliebiger Lnge
+ * wird als Wellenform zyklisch abgespielt. Mit pwm_burst_queue() kann eine
+ * neue Tabelle eingereiht werden, die nahtlos am Ende eines Durchlaufs der
+ * alten bernommen wird. Dazwischen ist der Prozessor nicht beteiligt.
+ *
+ * Belegt: Timer 4, DMA1 Stream 6 Kanal 2 (TIM4_UP, ber dma.c), PD12 bis
+ * PD15.
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+// Hchstzahl der Kanle pro frame (CCR1 bis CCR4)
+#define PWM_BURST_CHANNELS  4
+
+// Statistik, z.B. zur Betrachtung im Debugger
+typedef struct
+{
+    uint32_t swaps;     // bernommene Tabellen (pwm_burst_queue())
+    uint32_t restarts;  // davon mit Neustart des Streams (andere Lnge)
+    uint32_t irqs;      // Aufrufe der Interruptroutine
+} pwm_burst_stats_t;
+
+extern volatile pwm_burst_stats_t pwm_burst_stats;
+
+/* Fllt count frames ab frames, s. pwm_burst_stream(). */
+typedef void (*pwm_burst_fill_fn)(uint16_t *frames, uint16_t count);
+
+/* Richtet PD12 bis PD15 und Timer 4 (PWM mode 1) ein. Ein frame enthlt
+die Werte fr die ersten channels Kanle (1 bis PWM_BURST_CHANNELS), die
+brigen Kanle bleiben aus. Die PWM-Frequenz - und damit die Rate, mit der
+frames abgespielt werden - betrgt 84MHz / (psc + 1) / (arr + 1). Die
+Compare-Werte liegen zwischen 0 (aus) und arr + 1 (an). */
+void pwm_burst_init(uint16_t psc, uint16_t arr, uint8_t channels);
+
+/* ndert Prescaler und Maximalwert von Timer 4. Beide Werte werden erst mit
+dem nchsten Update bernommen, eine laufende PWM-Periode wird also nicht
+abgeschnitten. */
+void pwm_burst_rate(uint16_t psc, uint16_t arr);
+
+/* Spielt count frames ab frames sofort und zyklisch ab, bis
+pwm_burst_stop() aufgerufen wird. Der Speicher muss so lange gltig bleiben
+und darf nicht im CCM-RAM liegen. count * channels darf 65535 nicht
+bersteigen. */
+void pwm_burst_play(const uint16_t *frames, uint16_t count);
+
+/* Spielt abwechselnd die Puffer buf0 und buf1 mit je count frames ab, bis
+pwm_burst_stop() aufgerufen wird. Ist ein Puffer abgespielt, so wird fill
+im Interrupt mit diesem Puffer aufgerufen und muss ihn neu fllen, bevor der
+andere Puffer abgespielt ist. Zu Beginn fllt fill beide Puffer.
+pwm_burst_queue() darf whrenddessen nicht verwendet werden. */
+void pwm_burst_stream(uint16_t *buf0, uint16_t *buf1, uint16_t count,
+                      pwm_burst_fill_fn fill);
+
+/* Reiht eine neue Tabelle ein, die am Ende des laufenden Durchlaufs die
+alte ablst und dann zyklisch abgespielt wird. Die alte Tabelle muss bis
+dahin gltig bleiben (s. pwm_burst_pending()). Eine bereits eingereihte,
+aber noch nicht bernommene Tabelle wird ersetzt. Die Funktion darf auch aus
+Interruptroutinen aufgerufen werden. */
+void pwm_burst_queue(const uint16_t *frames, uint16_t count);
+
+/* Liefert 1, solange eine eingereihte Tabelle noch nicht bernommen ist. */
+int pwm_burst_pending(void);
+
+/* Hlt die bertragung an. Die zuletzt bernommenen Compare-Werte bleiben
+stehen. */
+void pwm_burst_stop(void);
+
+#endif
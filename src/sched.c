@@ -0,0 +1,202 @@
+/*
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+*/
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "sched.h"
+#include "power.h"
+
+// u.a. Definition der Hardwareregister des STM32F4
+#include "libfoo/stm32f4xx.h"
+
+
+/* Wie in spi_bus.c werden neu gemeldete Aufgaben mit LDREX und STREX
+(s. dort) ohne Sperren von Interrupts auf einen Stapel pro Prioritt
+gelegt. Nur die Hauptschleife nimmt Aufgaben wieder herunter. Sie holt
+sich jeweils den gesamten Stapel auf einmal, dreht ihn um und arbeitet
+die Aufgaben dann in der Reihenfolge ab, in der sie gemeldet wurden. */
+
+static sched_task_t * volatile pending[SCHED_PRIOS];
+static sched_task_t *queue[SCHED_PRIOS];
+
+volatile sched_stats_t sched_stats;
+
+static uint32_t lastNow;
+static uint32_t lastIdle;
+
+
+
+// *p |= v, liefert den alten Wert
+static uint32_t atomic_or(volatile uint32_t *p, uint32_t v)
+{
+    uint32_t old;
+
+    do {
+        old = __LDREXW(p);
+    } while (__STREXW(old | v, p));
+
+    return old;
+}
+
+// *p = v, liefert den alten Wert
+static uint32_t atomic_swap(volatile uint32_t *p, uint32_t v)
+{
+    uint32_t old;
+
+    do {
+        old = __LDREXW(p);
+    } while (__STREXW(v, p));
+
+    return old;
+}
+
+static void atomic_inc(volatile uint32_t *p)
+{
+    do {
+    } while (__STREXW(__LDREXW(p) + 1, p));
+}
+
+
+static sched_task_t *next_task(void)
+{
+    sched_task_t *t, *rev;
+    uint32_t p;
+
+    for (p = 0; p < SCHED_PRIOS; ++p) {
+        if (!queue[p] && pending[p]) {
+            rev = 0;
+            t = (sched_task_t*)atomic_swap((volatile uint32_t*)&pending[p], 0);
+            while (t) {
+                sched_task_t *n = t->next;
+                t->next = rev;
+                rev = t;
+                t = n;
+            }
+            queue[p] = rev;
+        }
+        if (queue[p]) {
+            t = queue[p];
+            queue[p] = t->next;
+            return t;
+        }
+    }
+
+    return 0;
+}
+
+static int anything_pending(void)
+{
+    uint32_t p;
+
+    for (p = 0; p < SCHED_PRIOS; ++p)
+        if (pending[p])
+            return 1;
+
+    return 0;
+}
+
+
+
+//----------------------------------------------------------------------------
+
+void sched_init(void)
+{
+    uint32_t p;
+
+    for (p = 0; p < SCHED_PRIOS; ++p) {
+        pending[p] = 0;
+        queue[p]   = 0;
+    }
+
+    swtimer_init();
+    lastNow  = swtimer_now();
+    lastIdle = sched_stats.idleUs;
+}
+
+
+
+void sched_post(sched_task_t *t, uint32_t events)
+{
+    volatile uint32_t *head = (volatile uint32_t*)&pending[t->prio];
+
+    atomic_or(&t->events, events);
+    atomic_inc(&sched_stats.posts);
+
+    // steht die Aufgabe schon an, gengt das gesetzte Ereignis-Bit
+    if (atomic_swap(&t->queued, 1))
+        return;
+
+    do {
+        t->next = (sched_task_t*)__LDREXW(head);
+    } while (__STREXW((uint32_t)t, head));
+}
+
+
+
+void sched_timer_post(swtimer_t *t)
+{
+    sched_post((sched_task_t*)t->arg, SCHED_EV_TIMER);
+}
+
+
+
+void sched_run(void)
+{
+    sched_task_t *t;
+    uint32_t events, t0;
+
+    while (1) {
+        t = next_task();
+
+        if (t) {
+            /* queued wird vor dem Abholen der Ereignisse zurckgesetzt.
+               Kommt danach ein neues Ereignis, so wird die Aufgabe erneut
+               eingereiht und ggf. mit events = 0 abgeholt - sie wird dann
+               einfach bersprungen. */
+            t->queued = 0;
+            events = atomic_swap(&t->events, 0);
+            if (events) {
+                sched_stats.runs++;
+                t->fn(t, events);
+            }
+            continue;
+        }
+
+        /* Es liegt nichts an. Damit zwischen der letzten Prfung und dem
+           WFI kein Ereignis verloren geht, werden die Interrupts vorher
+           gesperrt. WFI wacht trotzdem auf, sobald ein Interrupt ansteht -
+           die Interruptroutine luft dann nach __enable_irq(). Die Schlaf-
+           zeit wird ber Timer 2 gemessen, da der Taktzhler der DWT im
+           Schlaf stehen bleiben kann. power_idle() whlt zwischen Sleep
+           und Stop mode und stellt Timer 2 nach dem Stop mode nach. */
+        __disable_irq();
+        if (!anything_pending()) {
+            t0 = swtimer_now();
+            power_idle();
+            sched_stats.idleUs += swtimer_now() - t0;
+            sched_stats.sleeps++;
+        }
+        __enable_irq();
+    }
+}
+
+
+
+uint32_t sched_idle(void)
+{
+    uint32_t now  = swtimer_now();
+    uint32_t idle = sched_stats.idleUs;
+    uint32_t dt   = now - lastNow;
+    uint32_t di   = idle - lastIdle;
+
+    lastNow  = now;
+    lastIdle = idle;
+
+    if (dt == 0)
+        return 0;
+
+    return (uint32_t)(((uint64_t)di * 10000) / dt);
+}
@@ -0,0 +1,77 @@
+#ifndef SCHED_H
+#define SCHED_H
+
+/*
+ * In den Dateien sched.h und sched.c findet sich ein einfacher, ereignis-
+ * gesteuerter Scheduler. Anstatt in einer Hauptschleife stndig Register
+ * abzufragen, werden kleine Aufgaben ("tasks") nur dann aufgerufen, wenn
+ * fr sie ein Ereignis vorliegt - z.B. weil eine Interruptroutine oder ein
+ * Software-Timer (swtimer.h) es gemeldet hat. Jede Aufgabe luft bis zu
+ * ihrem Ende durch ("run to completion") und wird nicht von anderen Auf-
+ * gaben unterbrochen, nur von Interrupts. Liegt nichts an, legt sich der
+ * Prozessor mit WFI ("wait for interrupt") schlafen, bis der nchste
+ * Interrupt - z.B. der nchste fllige Software-Timer - ihn weckt.
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "swtimer.h"
+
+// Anzahl der Prioritten (0 = hchste)
+#define SCHED_PRIOS  8
+
+// Ereignis, das sched_timer_post() meldet
+#define SCHED_EV_TIMER  0x80000000UL
+
+struct sched_task;
+typedef void (*sched_fn)(struct sched_task *t, uint32_t events);
+
+/* Eine Aufgabe. Der Speicher gehrt dem Aufrufer. Die Felder fn, arg und
+prio werden vor dem ersten sched_post() gesetzt, die brigen Felder ver-
+waltet sched.c. */
+typedef struct sched_task
+{
+    struct sched_task *next;        // Verkettung in der Warteschlange
+    volatile uint32_t  queued;      // 1, solange die Aufgabe ansteht
+    volatile uint32_t  events;      // gemeldete, noch nicht bearbeitete
+                                    // Ereignisse (je ein Bit)
+    uint8_t            prio;        // 0 bis SCHED_PRIOS - 1
+    sched_fn           fn;
+    void              *arg;         // zur freien Verwendung durch fn
+} sched_task_t;
+
+// Statistik, z.B. zur Betrachtung im Debugger
+typedef struct
+{
+    uint32_t runs;      // Aufrufe von Aufgaben
+    uint32_t posts;     // gemeldete Ereignisse
+    uint32_t sleeps;    // Schlafphasen (WFI)
+    uint32_t idleUs;    // Summe der Schlafzeit in us (luft ber!)
+} sched_stats_t;
+
+extern volatile sched_stats_t sched_stats;
+
+/* Initialisiert den Scheduler und die Software-Timer (swtimer_init()). */
+void sched_init(void);
+
+/* Meldet der Aufgabe t die Ereignisse events (ODER-verknpft mit bereits
+gemeldeten). Die Funktion kommt ohne Sperren von Interrupts aus und darf
+daher aus jeder Interruptroutine aufgerufen werden. */
+void sched_post(sched_task_t *t, uint32_t events);
+
+/* Eine Rckruffunktion fr swtimer_t: Meldet der Aufgabe in t->arg das
+Ereignis SCHED_EV_TIMER. */
+void sched_timer_post(swtimer_t *t);
+
+/* Die Hauptschleife des Schedulers. Kehrt nicht zurck. */
+void sched_run(void);
+
+/* Liefert den Anteil der Schlafzeit (in 1/100 Prozent) seit dem letzten
+Aufruf. */
+uint32_t sched_idle(void);
+
+#endif
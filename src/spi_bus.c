@@ -0,0 +1,241 @@
+/*
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+*/
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "spi_bus.h"
+#include "discovery.h"
+#include "power.h"
+
+
+/* Mehrere Programmteile (und Interruptroutinen!) sollen Transaktionen auf
+demselben Bus einstellen drfen. Der einfachste Weg, die Warteschlange dabei
+konsistent zu halten, wre das kurzzeitige Abschalten aller Interrupts. Der
+Cortex-M4 bietet mit den Befehlen LDREX und STREX (exclusive load/store)
+jedoch eine elegantere Mglichkeit: LDREX liest einen Wert und "merkt" sich
+die Adresse. STREX schreibt nur dann, wenn seit dem LDREX niemand sonst auf
+die Adresse geschrieben hat und auch keine Unterbrechung stattgefunden hat.
+Ansonsten liefert STREX eine 1 und man versucht es einfach erneut. Die
+passenden Funktionen __LDREXW und __STREXW finden sich in core_cmInstr.h.
+
+Neue Transaktionen werden auf diese Weise auf einen einfachen Stapel
+(pending) gelegt. Wer den Bus gerade besitzt (busy = 1), nimmt sich bei
+Bedarf den gesamten Stapel auf einmal, dreht die Reihenfolge um und arbeitet
+ihn der Reihe nach ab. */
+
+static void push_pending(spi_bus_t *bus, spi_xfer_t *x)
+{
+    volatile uint32_t *p = (volatile uint32_t*)&bus->pending;
+
+    do {
+        x->next = (spi_xfer_t*)__LDREXW(p);
+    } while (__STREXW((uint32_t)x, p));
+}
+
+static spi_xfer_t *take_pending(spi_bus_t *bus)
+{
+    volatile uint32_t *p = (volatile uint32_t*)&bus->pending;
+    uint32_t list;
+
+    do {
+        list = __LDREXW(p);
+    } while (__STREXW(0, p));
+
+    return (spi_xfer_t*)list;
+}
+
+/* Versucht, den Bus zu belegen (busy von 0 auf 1). Liefert 1 bei Erfolg.
+Solange der Bus belegt ist, ist der Stop mode verboten (s. power.h) - er
+hielte die DMA-Transfers an. */
+static int claim(spi_bus_t *bus)
+{
+    do {
+        if (__LDREXW(&bus->busy)) {
+            __CLREX();
+            return 0;
+        }
+    } while (__STREXW(1, &bus->busy));
+
+    power_hold();
+
+    return 1;
+}
+
+static void release(spi_bus_t *bus)
+{
+    bus->busy = 0;
+    power_release();
+}
+
+
+static uint8_t dummyTx = 0;
+static uint8_t dummyRx;
+
+/* Startet die nchste Transaktion. Darf nur vom Besitzer des Busses
+aufgerufen werden. Liefert 0, falls keine Transaktion vorliegt. */
+static int start_next(spi_bus_t *bus)
+{
+    spi_xfer_t *x, *rev;
+
+    if (!bus->queue) {
+        // den Stapel in die richtige (FIFO-)Reihenfolge bringen
+        rev = 0;
+        x = take_pending(bus);
+        while (x) {
+            spi_xfer_t *n = x->next;
+            x->next = rev;
+            rev = x;
+            x = n;
+        }
+        bus->queue = rev;
+    }
+
+    x = bus->queue;
+    if (!x)
+        return 0;
+    bus->queue  = x->next;
+    bus->active = x;
+
+    /* Taktrate und Modus drfen nur bei abgeschaltetem SPI (SPE = 0)
+       gendert werden. Wir tun dies nur, wenn sich etwas ndert: */
+    if (x->cr1 != bus->cr1) {
+        bus->spi->CR1 &= 0xFFBF;
+        bus->spi->CR1  = 0x0304 | x->cr1;   // SSM, SSI, MSTR
+        bus->spi->CR1 |= 0x0040;
+        bus->cr1 = x->cr1;
+    }
+
+    dma_clear(&bus->rx, DMA_FLAG_ALL);
+    dma_clear(&bus->tx, DMA_FLAG_ALL);
+
+    /* Fehlt ein Puffer, so wird ohne MINC (Bit 10) von bzw. in ein
+       einzelnes Dummy-Byte bertragen: */
+    if (x->rx) {
+        bus->rx.stream->M0AR = (uint32_t)x->rx;
+        bus->rx.stream->CR   = bus->rx.chsel | 0x00020410;
+    } else {
+        bus->rx.stream->M0AR = (uint32_t)&dummyRx;
+        bus->rx.stream->CR   = bus->rx.chsel | 0x00020010;
+    }
+    if (x->tx) {
+        bus->tx.stream->M0AR = (uint32_t)x->tx;
+        bus->tx.stream->CR   = bus->tx.chsel | 0x00020440;
+    } else {
+        bus->tx.stream->M0AR = (uint32_t)&dummyTx;
+        bus->tx.stream->CR   = bus->tx.chsel | 0x00020040;
+    }
+    bus->rx.stream->NDTR = x->len;
+    bus->tx.stream->NDTR = x->len;
+
+    x->csPort->BSRRH = x->csPin;
+
+    bus->rx.stream->CR |= 0x00000001;
+    bus->tx.stream->CR |= 0x00000001;
+
+    return 1;
+}
+
+/* Sorgt dafr, dass wartende Transaktionen gestartet werden, falls der Bus
+frei ist. Ist er belegt, kmmert sich der Besitzer darum. */
+static void kick(spi_bus_t *bus)
+{
+    while (bus->pending) {
+        if (!claim(bus))
+            return;
+        if (start_next(bus))
+            return;
+        release(bus);
+    }
+}
+
+
+
+void spi_bus_submit(spi_bus_t *bus, spi_xfer_t *x)
+{
+    x->state = SPI_XFER_QUEUED;
+    push_pending(bus, x);
+    kick(bus);
+}
+
+
+
+void spi_bus_transfer(spi_bus_t *bus, spi_xfer_t *x)
+{
+    spi_bus_submit(bus, x);
+    while (x->state != SPI_XFER_DONE);
+}
+
+
+
+void spi_bus_irq(spi_bus_t *bus)
+{
+    spi_xfer_t *x = bus->active;
+
+    dma_clear(&bus->rx, DMA_FLAG_ALL);
+
+    /* Mit dem letzten empfangenen Byte ist die Transaktion beendet. Wir
+       geben den Chip-Select frei und starten ohne Pause die nchste
+       Transaktion - erst danach wird der Aufrufer benachrichtigt, damit der
+       Bus nicht auf dessen Rckruffunktion warten muss: */
+    x->csPort->BSRRL = x->csPin;
+    bus->active = 0;
+
+    if (!start_next(bus)) {
+        release(bus);
+        kick(bus);
+    }
+
+    x->state = SPI_XFER_DONE;
+    if (x->done)
+        x->done(x);
+}
+
+
+
+//----------------------------------------------------------------------------
+
+spi_bus_t spi_bus1;
+
+static void spi_bus1_irq(dma_stream_t *s)
+{
+    spi_bus_irq(&spi_bus1);
+}
+
+void spi_bus1_init(void)
+{
+    static const uint8_t reqs[2] = { DMA_REQ_SPI1_RX, DMA_REQ_SPI1_TX };
+    spi_bus_t *bus = &spi_bus1;
+
+    /* Die Pins PA5 bis PA7 werden in discovery_acc_init() auf die Alternate
+       Function 5 (SPI1) eingestellt. SPI1 wird ber Bit 12 im RCC_APB2ENR
+       mit Takt versorgt: */
+    discovery_acc_init();
+    RCC->APB2ENR |= 0x00001000;
+
+    /* Die DMA-Streams holen wir uns von der Verwaltung in dma.c. SPI1_RX
+       gibt es an DMA2 Stream 0 und 2, SPI1_TX an Stream 3 und 5, jeweils
+       Kanal 3 (Tabelle 21 in [1]). Die Verwaltung versorgt DMA2 auch mit
+       Takt und schaltet den Interrupt des RX-Streams frei. */
+    bus->rx.fn = spi_bus1_irq;
+    bus->tx.fn = 0;
+    if (!dma_claim_set(reqs, &bus->rx, 2))
+        while (1);
+
+    bus->spi        = SPI1;
+    bus->pending    = 0;
+    bus->queue      = 0;
+    bus->active     = 0;
+    bus->busy       = 0;
+    bus->cr1        = SPI_BUS_DIV16 | SPI_BUS_MODE3;
+
+    bus->rx.stream->PAR = (uint32_t)(&(SPI1->DR));
+    bus->tx.stream->PAR = (uint32_t)(&(SPI1->DR));
+
+    // Master, Software Slave Management, SPI-Requests fr RX und TX
+    SPI1->CR1  = 0x0304 | bus->cr1;
+    SPI1->CR2 |= 0x0003;
+    SPI1->CR1 |= 0x0040;
+}
@@ -0,0 +1,110 @@
+#ifndef SPI_BUS_H
+#define SPI_BUS_H
+
+/*
+ * In den Dateien spi_bus.h und spi_bus.c findet sich eine Verwaltung fr
+ * SPI-Busse, an denen mehrere Gerte hngen. Jeder Zugriff auf ein Gert
+ * wird als "Transaktion" beschrieben: welcher Chip-Select, welche
+ * Taktrate und welcher SPI-Modus, welche Daten und welche Funktion am Ende
+ * aufgerufen werden soll. Die Transaktionen werden ohne Sperren von
+ * Interrupts in eine Warteschlange gestellt und per DMA direkt nacheinander
+ * ausgefhrt.
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+// u.a. Definition der Hardwareregister des STM32F4
+#include "libfoo/stm32f4xx.h"
+
+// Verwaltung der DMA-Streams
+#include "dma.h"
+
+/* Einstellungen fr das Feld cr1 einer Transaktion. Sie entsprechen den
+Bits im Register SPI_CR1 (s. [1]): Taktteiler BR (Bits 3 bis 5) bezogen
+auf den Bustakt (84MHz fr SPI1) sowie CPOL (Bit 1) und CPHA (Bit 0). */
+#define SPI_BUS_DIV2    0x0000
+#define SPI_BUS_DIV4    0x0008
+#define SPI_BUS_DIV8    0x0010
+#define SPI_BUS_DIV16   0x0018
+#define SPI_BUS_DIV32   0x0020
+#define SPI_BUS_DIV64   0x0028
+#define SPI_BUS_DIV128  0x0030
+#define SPI_BUS_DIV256  0x0038
+
+#define SPI_BUS_MODE0   0x0000
+#define SPI_BUS_MODE1   0x0001
+#define SPI_BUS_MODE2   0x0002
+#define SPI_BUS_MODE3   0x0003
+
+#define SPI_BUS_LSBFIRST 0x0080
+
+// Zustand einer Transaktion
+#define SPI_XFER_IDLE    0
+#define SPI_XFER_QUEUED  1
+#define SPI_XFER_DONE    2
+
+struct spi_xfer;
+typedef void (*spi_done_fn)(struct spi_xfer *x);
+
+/* Eine Transaktion. Der Speicher gehrt dem Aufrufer und muss gltig
+bleiben, bis state den Wert SPI_XFER_DONE annimmt. Ist tx gleich 0, so
+werden Nullen gesendet, ist rx gleich 0, werden die empfangenen Bytes
+verworfen. */
+typedef struct spi_xfer
+{
+    struct spi_xfer *next;      // Verkettung in der Warteschlange
+
+    GPIO_TypeDef    *csPort;    // Chip-Select (low-aktiv), z.B. GPIOE
+    uint16_t         csPin;     // Bitmaske des Pins, z.B. 0x0008 fr PE3
+    uint16_t         cr1;       // SPI_BUS_DIVx | SPI_BUS_MODEx
+
+    const uint8_t   *tx;
+    uint8_t         *rx;
+    uint16_t         len;
+
+    volatile uint8_t state;
+    spi_done_fn      done;      // wird im Interrupt aufgerufen (oder 0)
+    void            *arg;       // zur freien Verwendung durch done
+} spi_xfer_t;
+
+/* Ein SPI-Bus mit den zugehrigen DMA-Streams. Die Felder werden von
+spi_bus.c verwaltet. */
+typedef struct
+{
+    SPI_TypeDef        *spi;
+    dma_stream_t        rx;         // muss direkt vor tx stehen,
+    dma_stream_t        tx;         // s. dma_claim_set()
+
+    spi_xfer_t * volatile pending;  // neu eingestellte Transaktionen (LIFO)
+    spi_xfer_t         *queue;      // abzuarbeitende Transaktionen (FIFO)
+    spi_xfer_t         *active;     // laufende Transaktion
+    volatile uint32_t   busy;       // 1, solange der Bus in Benutzung ist
+    uint16_t            cr1;        // aktuell eingestellte Taktrate/Modus
+} spi_bus_t;
+
+// SPI1 (PA5 bis PA7), DMA-Streams von dma_claim_set()
+extern spi_bus_t spi_bus1;
+
+/* Richtet SPI1 samt Pins, DMA und Interrupt ein. */
+void spi_bus1_init(void);
+
+/* Stellt eine Transaktion in die Warteschlange des Busses. Die Funktion
+darf auch aus Interruptroutinen aufgerufen werden. Ist der Bus frei, so
+beginnt die bertragung sofort. */
+void spi_bus_submit(spi_bus_t *bus, spi_xfer_t *x);
+
+/* Stellt eine Transaktion in die Warteschlange und wartet auf ihr Ende.
+Aus Interruptroutinen darf die Funktion nur aufgerufen werden, wenn deren
+Prioritt niedriger ist als die des DMA-Interrupts des Busses (Prioritt
+0, die hchste). Sonst wartet man ewig auf das Ende der Transaktion. */
+void spi_bus_transfer(spi_bus_t *bus, spi_xfer_t *x);
+
+/* Muss aus der Interruptroutine des RX-Streams aufgerufen werden (bei
+spi_bus1 ber dma.c). */
+void spi_bus_irq(spi_bus_t *bus);
+
+#endif
@@ -0,0 +1,360 @@
+/*
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+*/
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "swtimer.h"
+#include "cycles.h"
+
+// u.a. Definition der Hardwareregister des STM32F4
+#include "libfoo/stm32f4xx.h"
+
+
+/* Das timing wheel besteht aus 4 Ebenen mit je 256 Fchern. Jede Ebene ist
+fr eines der 4 Bytes des Ablaufzeitpunkts zustndig: Ein Timer, dessen
+Ablaufzeitpunkt sich von "base" (dem nchsten noch nicht bearbeiteten
+Zeitpunkt) nur im untersten Byte unterscheidet, kommt in Ebene 0, und zwar
+in das Fach, das diesem Byte entspricht. Alle Timer eines Fachs der Ebene 0
+laufen also zum exakt gleichen Zeitpunkt ab. Unterscheidet sich auch das
+zweite Byte, kommt der Timer in Ebene 1 usw.
+
+Erreicht base den Beginn eines Fachs einer hheren Ebene, so werden die
+Timer dieses Fachs neu einsortiert ("cascade"). Sie landen dann in einer
+tieferen Ebene. Jeder Timer wird so hchstens dreimal umsortiert.
+
+Um das nchste belegte Fach schnell zu finden, gibt es zu jeder Ebene eine
+Bitmaske aus 8 Worten. Fach s entspricht hierbei Bit (31 - s % 32) in Wort
+s / 32. Der Befehl CLZ (count leading zeros, __CLZ in core_cmInstr.h)
+liefert dann direkt das erste belegte Fach eines Wortes. */
+
+#define LEVELS  4
+#define SLOTS   256
+
+static swtimer_t *wheel[LEVELS][SLOTS];
+static uint32_t   used[LEVELS][SLOTS / 32];
+static uint32_t   base;
+
+volatile swtimer_stats_t swtimer_stats;
+
+
+
+static void enqueue(swtimer_t *t)
+{
+    swtimer_t **head;
+    uint32_t level, s;
+
+    // Zeitpunkte vor base wurden schon bearbeitet
+    if ((int32_t)(t->expires - base) < 0)
+        t->expires = base;
+
+    /* Die Ebene ergibt sich aus dem hchsten Bit, in dem sich Ablaufzeit-
+       punkt und base unterscheiden (die 1 sorgt dafr, dass auch bei
+       Gleichheit Ebene 0 herauskommt): */
+    level = (31 - __CLZ((t->expires ^ base) | 1)) >> 3;
+    s     = (t->expires >> (level * 8)) & (SLOTS - 1);
+
+    head = &wheel[level][s];
+    t->next = *head;
+    if (t->next)
+        t->next->pprev = &t->next;
+    *head    = t;
+    t->pprev = head;
+    t->slot  = (uint16_t)(level * SLOTS + s);
+
+    used[level][s >> 5] |= 0x80000000UL >> (s & 31);
+}
+
+static void dequeue(swtimer_t *t)
+{
+    uint32_t level = t->slot / SLOTS;
+    uint32_t s     = t->slot % SLOTS;
+
+    *t->pprev = t->next;
+    if (t->next)
+        t->next->pprev = t->pprev;
+    t->pprev = 0;
+
+    if (!wheel[level][s])
+        used[level][s >> 5] &= ~(0x80000000UL >> (s & 31));
+}
+
+
+/* Liefert das erste belegte Fach ab Fach first (einschlielich) oder
+SLOTS, falls es keines gibt. */
+static uint32_t find_slot(const uint32_t *map, uint32_t first)
+{
+    uint32_t w, bits;
+
+    if (first >= SLOTS)
+        return SLOTS;
+
+    w    = first >> 5;
+    bits = map[w] & (0xFFFFFFFFUL >> (first & 31));
+    while (!bits) {
+        if (++w == SLOTS / 32)
+            return SLOTS;
+        bits = map[w];
+    }
+
+    return (w << 5) + __CLZ(bits);
+}
+
+/* Sucht das nchste Ereignis: den Ablauf eines Fachs in Ebene 0 oder den
+Beginn eines Fachs einer hheren Ebene. Da alle Timer einer Ebene spter
+dran sind als die aller tieferen Ebenen, gengt es, die Ebenen von unten
+nach oben zu durchsuchen. Liefert die Ebene oder -1, falls kein Timer
+luft. */
+static int next_event(uint32_t *when)
+{
+    uint32_t level, shift, c, s;
+
+    // Ebene 0: Fcher ab base (einschlielich)
+    s = find_slot(used[0], base & (SLOTS - 1));
+    if (s < SLOTS) {
+        *when = (base & 0xFFFFFF00UL) | s;
+        return 0;
+    }
+
+    // Ebenen 1 und 2: Fcher hinter dem aktuellen Fach
+    for (level = 1; level < LEVELS - 1; ++level) {
+        shift = level * 8;
+        c = (base >> shift) & (SLOTS - 1);
+        s = find_slot(used[level], c + 1);
+        if (s < SLOTS) {
+            *when = (base & (0xFFFFFF00UL << shift)) | (s << shift);
+            return level;
+        }
+    }
+
+    /* Ebene 3: Da der Zhler nach 2^32 Ticks berluft, kann das nchste
+       Fach auch "vor" dem aktuellen liegen. */
+    c = base >> 24;
+    s = find_slot(used[3], c + 1);
+    if (s == SLOTS)
+        s = find_slot(used[3], 0);
+    if (s == SLOTS)
+        return -1;
+    *when = s << 24;
+    return 3;
+}
+
+
+/* Stellt den Compare-Kanal auf das nchste Ereignis ein. Liefert 0, falls
+dieses schon erreicht ist - dann wrde der Compare-Interrupt erst nach
+einem berlauf des Zhlers kommen, und das Ereignis muss sofort bearbeitet
+werden. */
+static int program_compare(void)
+{
+    uint32_t when;
+
+    if (next_event(&when) < 0) {
+        TIM2->DIER = 0x0000;
+        return 1;
+    }
+
+    TIM2->CCR1 = when;
+    TIM2->DIER = 0x0002;
+
+    return (int32_t)(when - TIM2->CNT) > 0;
+}
+
+
+/* Bearbeitet alle Ereignisse bis einschlielich now. Wird mit gesperrten
+Interrupts aufgerufen, die nur fr die Rckruffunktionen kurz freigegeben
+werden. */
+static void process(uint32_t now, uint32_t primask)
+{
+    swtimer_t *t, *n, **head;
+    uint32_t when, s;
+    int level;
+
+    while ((level = next_event(&when)) >= 0 && (int32_t)(when - now) <= 0) {
+        base = when;
+        s    = (when >> (level * 8)) & (SLOTS - 1);
+        head = &wheel[level][s];
+
+        if (level > 0) {
+            // das Fach leeren und alle Timer neu einsortieren
+            t = *head;
+            *head = 0;
+            used[level][s >> 5] &= ~(0x80000000UL >> (s & 31));
+            while (t) {
+                n = t->next;
+                enqueue(t);
+                swtimer_stats.cascaded++;
+                t = n;
+            }
+            continue;
+        }
+
+        /* Die Liste wird bei jedem Durchlauf neu gelesen, da die Rckruf-
+           funktionen (oder Interrupts) Timer starten und abbrechen drfen. */
+        while ((t = *head) != 0) {
+            dequeue(t);
+            if (t->period) {
+                t->expires += t->period;
+                enqueue(t);
+            } else {
+                swtimer_stats.active--;
+            }
+            swtimer_stats.fired++;
+
+            __set_PRIMASK(primask);
+            t->fn(t);
+            __disable_irq();
+        }
+    }
+
+    /* Bis einschlielich now gibt es nichts mehr zu tun. base darf daher
+       bis now vorrcken, ohne dass sich an der Einsortierung etwas ndert.
+       (Bei now + 1 knnte base genau auf dem noch nicht bearbeiteten Beginn
+       eines Fachs einer hheren Ebene landen.) */
+    if ((int32_t)(now - base) > 0)
+        base = now;
+}
+
+
+
+//----------------------------------------------------------------------------
+
+void swtimer_init(void)
+{
+    /* Timer 2 ist einer der beiden 32-Bit Timer des STM32F4. Er hngt am
+       APB1 (Bit 0 im RCC_APB1ENR) und wird wie Timer 3 mit 84MHz getaktet.
+       Ein Prescaler von 83 ergibt 84MHz / (83 + 1) = 1MHz: */
+
+    RCC->APB1ENR |= 0x00000001;
+
+    TIM2->CR1   = 0x0000;
+    TIM2->PSC   = 84 - 1;
+    TIM2->ARR   = 0xFFFFFFFF;
+    TIM2->CCMR1 = 0x0000;       // Kanal 1: "frozen", nur Vergleich
+    TIM2->DIER  = 0x0000;
+    TIM2->EGR   = 0x0001;       // Prescaler bernehmen
+    TIM2->SR    = 0x0000;
+    TIM2->CR1   = 0x0001;
+
+    base = TIM2->CNT;
+
+    // Timer 2 ist Interrupt Nummer 28 (Tabelle 30 in [1])
+    NVIC->ISER[0] = 0x10000000;
+}
+
+
+
+uint32_t swtimer_now(void)
+{
+    return TIM2->CNT;
+}
+
+
+
+void swtimer_start(swtimer_t *t, uint32_t delay)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    if (delay > SWTIMER_MAX_DELAY)
+        delay = SWTIMER_MAX_DELAY;
+
+    __disable_irq();
+
+    /* base rckt nur in process() vor. Lief lange kein Timer, kann base
+       daher mehr als 2^31 Ticks zurckliegen, und der neue Timer she
+       schon abgelaufen aus. Bei leerem wheel darf base einfach auf den
+       aktuellen Stand springen. */
+    if (t->pprev)
+        dequeue(t);
+    else if (swtimer_stats.active++ == 0)
+        base = TIM2->CNT;
+
+    t->expires = TIM2->CNT + delay;
+    enqueue(t);
+
+    // Ist der neue Timer der nchste, muss der Compare-Kanal nachziehen
+    if (!program_compare())
+        NVIC->ISPR[0] = 0x10000000;
+
+    __set_PRIMASK(primask);
+}
+
+
+
+void swtimer_cancel(swtimer_t *t)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    if (t->pprev) {
+        dequeue(t);
+        swtimer_stats.active--;
+    }
+    __set_PRIMASK(primask);
+
+    /* Der Compare-Kanal wird nicht umgestellt. Ein berflssiger Interrupt
+       findet einfach nichts zu tun. */
+}
+
+
+
+int swtimer_active(const swtimer_t *t)
+{
+    return t->pprev != 0;
+}
+
+
+
+int swtimer_next(uint32_t *delay)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t when;
+    int level;
+
+    __disable_irq();
+    level = next_event(&when);
+    if (level >= 0) {
+        when -= TIM2->CNT;
+        *delay = (int32_t)when > 0 ? when : 0;
+    }
+    __set_PRIMASK(primask);
+
+    return level >= 0;
+}
+
+
+
+void swtimer_skip(uint32_t ticks)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    /* Der Compare-Kanal meldet nur Gleichheit. Springt der Zhler ber
+       den eingestellten Wert hinweg, muss der Interrupt von Hand ausgelst
+       werden. */
+    __disable_irq();
+    TIM2->CNT += ticks;
+    if (!program_compare())
+        NVIC->ISPR[0] = 0x10000000;
+    __set_PRIMASK(primask);
+}
+
+
+
+void TIM2_IRQHandler(void)
+{
+    uint32_t t0 = cycles_now();
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+
+    TIM2->SR = 0xFFFD;      // CC1IF lschen (rc_w0)
+    do {
+        process(TIM2->CNT, primask);
+    } while (!program_compare());
+
+    swtimer_stats.irqs++;
+    swtimer_stats.cycles += cycles_now() - t0;
+
+    __set_PRIMASK(primask);
+}
@@ -0,0 +1,95 @@
+#ifndef SWTIMER_H
+#define SWTIMER_H
+
+/*
+ * In den Dateien swtimer.h und swtimer.c findet sich eine Verwaltung fr
+ * beliebig viele Software-Timer, die sich gemeinsam einen einzigen Hard-
+ * ware-Timer teilen. Timer 2 zhlt hierfr als freilaufender 32-Bit Zhler
+ * mit 1MHz. ber seinen Compare-Kanal 1 wird immer genau der nchste
+ * Zeitpunkt eingestellt, zu dem etwas zu tun ist - einen periodischen
+ * "Tick", der auch dann Rechenzeit kostet, wenn kein Timer abluft, gibt es
+ * nicht.
+ *
+ * Die Timer werden in einem hierarchischen "timing wheel" verwaltet (s.
+ * G. Varghese, T. Lauck: "Hashed and Hierarchical Timing Wheels", 1987).
+ * Starten, Abbrechen und Ablaufen eines Timers kosten unabhngig von der
+ * Anzahl der Timer konstant viel Zeit.
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+// Auflsung der Timer: 1 Tick = 1us
+#define SWTIMER_HZ         1000000UL
+#define SWTIMER_US(us)     ((uint32_t)(us))
+#define SWTIMER_MS(ms)     ((uint32_t)(ms) * 1000UL)
+
+/* Grte zulssige Verzgerung (etwa 17 Minuten). Lngere Zeiten mssen
+ber mehrere Ablufe zusammengesetzt werden. */
+#define SWTIMER_MAX_DELAY  0x40000000UL
+
+struct swtimer;
+typedef void (*swtimer_fn)(struct swtimer *t);
+
+/* Ein Software-Timer. Der Speicher gehrt dem Aufrufer und muss gltig
+bleiben, solange der Timer luft. Die Felder fn, arg und period werden vom
+Aufrufer vor swtimer_start() gesetzt, alle brigen Felder verwaltet
+swtimer.c. */
+typedef struct swtimer
+{
+    struct swtimer  *next;      // Verkettung innerhalb eines Fachs
+    struct swtimer **pprev;     // Zeiger auf den Zeiger, der auf uns zeigt
+    uint32_t         expires;   // Ablaufzeitpunkt (Stand von TIM2->CNT)
+    uint16_t         slot;      // Ebene * 256 + Fach im timing wheel
+
+    uint32_t         period;    // 0 = einmalig, sonst Periode in Ticks
+    swtimer_fn       fn;        // wird im Interrupt aufgerufen
+    void            *arg;       // zur freien Verwendung durch fn
+} swtimer_t;
+
+// Statistik, z.B. zur Betrachtung im Debugger
+typedef struct
+{
+    uint32_t active;    // Anzahl laufender Timer
+    uint32_t fired;     // abgelaufene Timer
+    uint32_t cascaded;  // Umsortierungen in eine tiefere Ebene
+    uint32_t irqs;      // Aufrufe der Interruptroutine
+    uint32_t cycles;    // Takte in der Interruptroutine (inkl. Rckrufe)
+} swtimer_stats_t;
+
+extern volatile swtimer_stats_t swtimer_stats;
+
+/* Richtet Timer 2 als freilaufenden 1MHz-Zhler samt Compare-Interrupt
+ein. Muss vor allen anderen Funktionen aufgerufen werden. */
+void swtimer_init(void);
+
+/* Liefert den aktuellen Zhlerstand (in us). Wie bei cycles_now() sollten
+nur Differenzen betrachtet werden. */
+uint32_t swtimer_now(void);
+
+/* Startet einen Timer, der nach delay Ticks abluft. Luft der Timer
+bereits, so wird er zuvor abgebrochen. Die Funktion darf auch aus Inter-
+ruptroutinen (und insbesondere aus den Rckruffunktionen) aufgerufen
+werden. */
+void swtimer_start(swtimer_t *t, uint32_t delay);
+
+/* Bricht einen Timer ab. Ein nicht laufender Timer wird ignoriert. */
+void swtimer_cancel(swtimer_t *t);
+
+/* Liefert 1, falls der Timer luft. */
+int swtimer_active(const swtimer_t *t);
+
+/* Liefert 1 und in delay die Zeit (in Ticks) bis zum nchsten Ereignis des
+timing wheels, bzw. 0 falls kein Timer luft. Das Ereignis kann auch das
+Umsortieren einer hheren Ebene sein - delay ist also hchstens so gro wie
+die Zeit bis zum Ablauf des nchsten Timers, nie grer. */
+int swtimer_next(uint32_t *delay);
+
+/* Stellt den Zhler um ticks vor, z.B. nach dem Stop mode (s. power.c), in
+dem Timer 2 keinen Takt erhlt. Dabei fllige Timer laufen sofort ab. */
+void swtimer_skip(uint32_t ticks);
+
+#endif
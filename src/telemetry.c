@@ -0,0 +1,149 @@
+/*
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+*/
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "telemetry.h"
+#include "uart.h"
+#include "rcc.h"
+#include "cycles.h"
+
+
+#define RING_MASK  (UART_RING - 1)
+
+volatile telemetry_stats_t telemetry_stats;
+
+static const uint8_t sizes[TELEM_TYPES] = TELEM_SIZES;
+
+// das Paket, das gerade gefllt wird
+static uint8_t  frame[TELEM_FRAME_MAX];
+static uint32_t fill;
+static uint32_t lastT;
+static uint8_t  seq;
+
+// Zustand von telemetry_time()
+static uint32_t lastCycles;
+static uint32_t timeUs;
+static uint32_t timeRest;
+
+
+
+//----------------------------------------------------------------------------
+
+void telemetry_init(void)
+{
+    fill       = 0;
+    seq        = 0;
+    timeUs     = 0;
+    timeRest   = 0;
+    lastCycles = cycles_now();
+}
+
+
+
+void telemetry_put(uint8_t type, uint32_t t, const void *data)
+{
+    const uint8_t *d = data;
+    uint32_t size, dt, k;
+
+    if (type == 0 || type >= TELEM_TYPES)
+        return;
+
+    size = sizes[type];
+    dt   = t - lastT;
+
+    if (fill && (dt > 0xFFFF ||
+                 fill + TELEM_RECORD + size + TELEM_CRC > TELEM_FRAME_MAX))
+        telemetry_flush();
+
+    if (!fill) {
+        frame[0] = seq++;
+        frame[1] = (uint8_t)t;
+        frame[2] = (uint8_t)(t >> 8);
+        frame[3] = (uint8_t)(t >> 16);
+        frame[4] = (uint8_t)(t >> 24);
+        fill = TELEM_HEADER;
+        dt   = 0;
+    }
+
+    frame[fill++] = type;
+    frame[fill++] = (uint8_t)dt;
+    frame[fill++] = (uint8_t)(dt >> 8);
+    for (k = 0; k < size; ++k)
+        frame[fill++] = d[k];
+
+    lastT = t;
+    ++telemetry_stats.records;
+}
+
+
+
+/* COBS ersetzt jedes Nullbyte durch den Abstand zum nchsten Nullbyte. Ein
+zustzliches Byte am Anfang gibt den Abstand zum ersten an. Da ein solcher
+"code" hchstens 255 sein kann, wird nach 254 Bytes ohne Nullbyte ein
+weiterer code eingefgt. Kodiert wird direkt in den Ringpuffer von uart.c,
+dort wird jeweils erst am Ende eines Abschnitts dessen code eingetragen. */
+void telemetry_flush(void)
+{
+    uart_slot_t s;
+    uint32_t i, n, at;
+    uint16_t crc;
+    uint8_t code;
+
+    if (!fill)
+        return;
+
+    crc = telemetry_crc16(0xFFFF, frame, fill);
+    frame[fill++] = (uint8_t)crc;
+    frame[fill++] = (uint8_t)(crc >> 8);
+
+    if (!uart_reserve(&s, TELEM_COBS_MAX(fill))) {
+        ++telemetry_stats.dropped;
+        fill = 0;
+        return;
+    }
+
+    at   = s.pos;
+    n    = 1;
+    code = 1;
+    for (i = 0; i < fill; ++i) {
+        if (frame[i] == 0) {
+            uart_ring[at & RING_MASK] = code;
+            at   = s.pos + n++;
+            code = 1;
+        } else {
+            uart_ring[(s.pos + n++) & RING_MASK] = frame[i];
+            if (++code == 0xFF) {
+                uart_ring[at & RING_MASK] = code;
+                at   = s.pos + n++;
+                code = 1;
+            }
+        }
+    }
+    uart_ring[at & RING_MASK] = code;
+    uart_ring[(s.pos + n++) & RING_MASK] = 0;
+
+    uart_commit(&s, n);
+
+    ++telemetry_stats.frames;
+    telemetry_stats.bytes += n;
+    fill = 0;
+}
+
+
+
+uint32_t telemetry_time(void)
+{
+    uint32_t now = cycles_now();
+
+    timeRest  += now - lastCycles;
+    lastCycles = now;
+
+    timeUs   += timeRest / (F_CPU / 1000000);
+    timeRest %= F_CPU / 1000000;
+
+    return timeUs;
+}
@@ -0,0 +1,107 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+/*
+ * In den Dateien telemetry.h und telemetry.c findet sich ein kompaktes
+ * Binrformat fr Messdaten, die ber uart.c gesendet werden. Text wie in
+ * log.c ist fr schnelle Messreihen zu langsam und zu gro: Eine Zeile
+ * "x=-12 y=3 z=55" braucht 15 Byte, als Datensatz sind es 6.
+ *
+ * Datenstze werden zu Paketen ("frames") gesammelt:
+ *
+ *     seq (1) | t0 (4) | Datensatz | Datensatz | ... | CRC-16 (2)
+ *
+ * seq zhlt die Pakete, so fallen verlorene Pakete auf. t0 ist die Zeit
+ * des ersten Datensatzes in us. Jeder Datensatz hat die Form
+ *
+ *     typ (1) | dt (2) | Nutzdaten (Lnge je nach typ fest)
+ *
+ * mit dt als Abstand zum vorherigen Datensatz in us. Passt ein Abstand
+ * nicht in 16 Bit, so beginnt ein neues Paket. Da jedes Paket seine eigene
+ * Startzeit mitbringt, bleibt die Zeitachse auch bei verlorenen Paketen
+ * erhalten. Alle Werte sind little endian, die CRC (CCITT, Polynom 0x1021,
+ * Startwert 0xFFFF) luft ber alle Bytes davor.
+ *
+ * Fr die bertragung wird jedes Paket per COBS ("consistent overhead byte
+ * stuffing") so umkodiert, dass es keine Nullbytes mehr enthlt, und mit
+ * einem Nullbyte abgeschlossen. Ein Empfnger findet den Anfang des nchsten
+ * Pakets daher immer wieder, auch wenn er mitten im Datenstrom einsteigt.
+ *
+ * Das Programm tools/telemetry_decode.c wandelt einen aufgezeichneten
+ * Datenstrom auf dem PC in eine CSV-Datei um.
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+// Typen der Datenstze
+#define TELEM_ACC       1       // int8_t x, y, z (LIS302DL, ca. 18mg/LSB)
+
+// Lnge der Nutzdaten je Typ, Index = Typ (0 ist ungltig)
+#define TELEM_TYPES     2
+#define TELEM_SIZES     { 0, 3 }
+
+// Gre eines Pakets ohne COBS und Nullbyte
+#define TELEM_HEADER    5
+#define TELEM_RECORD    3       // typ und dt
+#define TELEM_CRC       2
+#define TELEM_FRAME_MAX 128
+
+/* Lnge eines Pakets nach COBS mit abschlieendem Nullbyte: ein Byte vorab
+und ein weiteres je angefangene 254 Bytes. */
+#define TELEM_COBS_MAX(n)  ((n) + (n) / 254 + 2)
+
+// Statistik, z.B. zur Betrachtung im Debugger
+typedef struct
+{
+    uint32_t records;   // angenommene Datenstze
+    uint32_t frames;    // gesendete Pakete
+    uint32_t bytes;     // gesendete Bytes (nach COBS)
+    uint32_t dropped;   // verworfene Pakete (Ring von uart.c voll)
+} telemetry_stats_t;
+
+extern volatile telemetry_stats_t telemetry_stats;
+
+/* Setzt den Zustand zurck. uart_init() muss zuvor aufgerufen worden
+sein. */
+void telemetry_init(void);
+
+/* Hngt einen Datensatz vom Typ type mit der Zeit t (in us) an das
+aktuelle Paket an. Ist das Paket voll, so wird es vorher gesendet. Die
+Funktionen dieses Moduls drfen nur aus einem einzigen Programmteil (z.B.
+einer einzigen Interruptroutine) aufgerufen werden. */
+void telemetry_put(uint8_t type, uint32_t t, const void *data);
+
+/* Sendet das aktuelle Paket, auch wenn es noch nicht voll ist. */
+void telemetry_flush(void);
+
+/* Liefert die Zeit in us seit dem ersten Aufruf. Grundlage ist der
+Taktzhler aus cycles.h, der alle 25 Sekunden berluft - die Funktion muss
+daher mindestens so oft aufgerufen werden. */
+uint32_t telemetry_time(void);
+
+/* CRC-16 (CCITT) ber len Byte, beginnend mit crc (0xFFFF fr den Anfang).
+Die Funktion steht hier, damit auch tools/telemetry_decode.c sie verwenden
+kann. Eine Tabelle mit 16 Eintrgen erledigt jeweils 4 Bit auf einmal -
+ein guter Kompromiss aus Gre (32 Byte) und Geschwindigkeit. */
+static inline uint16_t telemetry_crc16(uint16_t crc, const uint8_t *data,
+                                       uint32_t len)
+{
+    static const uint16_t table[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+    };
+
+    while (len--) {
+        crc = (uint16_t)((crc << 4) ^ table[(crc >> 12) ^ (*data >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ table[(crc >> 12) ^ (*data & 15)]);
+        ++data;
+    }
+
+    return crc;
+}
+
+#endif
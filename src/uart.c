@@ -0,0 +1,480 @@
+/*
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+*/
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+#include "uart.h"
+#include "gpio.h"
+#include "dma.h"
+#include "power.h"
+#include "bitband.h"
+
+// u.a. Definition der Hardwareregister des STM32F4
+#include "libfoo/stm32f4xx.h"
+
+
+#define RING_MASK  (UART_RING - 1)
+#define RX_MASK    (UART_RX_RING - 1)
+
+volatile uart_stats_t uart_stats;
+
+uint8_t uart_ring[UART_RING];
+
+/* Der Ring wird ber drei frei laufende 32-Bit Zhler verwaltet, von denen
+nur die unteren Bits als Index dienen:
+
+    tail  <=  committed  <=  head
+
+Bis tail ist alles gesendet, bis committed ist alles zum Senden freigegeben,
+bis head ist alles reserviert. Dazwischen liegt das, was gerade beschrieben
+wird. Reservieren drfen mehrere Programmteile gleichzeitig, z.B. das
+Hauptprogramm und eine Interruptroutine, die es unterbricht. Die Interrupt-
+routine ist dann aber immer fertig, bevor das Hauptprogramm weiterluft.
+Es gengt daher, die Schreibenden zu zhlen (writers): Erst wer als Letzter
+fertig wird, schiebt committed bis head vor - dann sind alle Bereiche bis
+head beschrieben. */
+static volatile uint32_t head;
+static volatile uint32_t committed;
+static volatile uint32_t tail;
+static volatile uint32_t writers;
+
+static volatile uint32_t busy;  // DMA-Stream oder USART sendet
+static uint32_t          chunk; // Lnge des laufenden Transfers
+
+// USART2_TX: DMA1 Stream 6, Kanal 4 (Tabelle 20 in [1])
+static dma_stream_t dma;
+
+// Empfang: USART2_RX an DMA1 Stream 5, Kanal 4
+static uint8_t      uart_rx_ring[UART_RX_RING];
+static dma_stream_t rx;
+static uart_line_fn rxLine;
+static uint32_t     rxRead;     // untersuchte Bytes seit uart_rx_start()
+static uint32_t     rxStart;    // Beginn der aktuellen Zeile im Ring
+static uint32_t     rxLen;      // deren bisherige Lnge
+static uint8_t      rxDrop;     // aktuelle Zeile ist zu lang
+static volatile uint32_t rxHalves;  // gemeldete Ringhlften (HT und TC)
+
+
+
+/* Siehe spi_bus.c zu LDREX und STREX. */
+static uint32_t atomic_add(volatile uint32_t *p, int32_t n)
+{
+    uint32_t v;
+
+    do {
+        v = __LDREXW(p) + n;
+    } while (__STREXW(v, p));
+
+    return v;
+}
+
+/* Wie in spi_bus.c verbietet der Besitzer den Stop mode. busy bleibt
+gesetzt, bis auch das letzte Byte den USART verlassen hat (s. uart_irq()). */
+static int claim(void)
+{
+    do {
+        if (__LDREXW(&busy)) {
+            __CLREX();
+            return 0;
+        }
+    } while (__STREXW(1, &busy));
+
+    power_hold();
+
+    return 1;
+}
+
+static void release(void)
+{
+    busy = 0;
+    power_release();
+}
+
+
+/* Startet den nchsten Transfer ab tail - hchstens bis zum Ende des Rings,
+der Rest folgt im nchsten Transfer. Darf nur aufgerufen werden, wenn busy
+gesetzt ist. Liefert 0, falls nichts zu senden ist. */
+static int start_next(void)
+{
+    uint32_t pos = tail & RING_MASK;
+    uint32_t n   = committed - tail;
+
+    if (!n)
+        return 0;
+    if (n > UART_RING - pos)
+        n = UART_RING - pos;
+
+    chunk = n;
+
+    // TC des USART (Bit 6, rc_w0) gilt erst wieder fr diesen Transfer
+    USART2->SR = (uint16_t)~0x0040;
+
+    dma_clear(&dma, DMA_FLAG_ALL);
+    dma.stream->M0AR = (uint32_t)&uart_ring[pos];
+    dma.stream->NDTR = n;
+    dma.stream->CR  |= 0x00000001;
+
+    ++uart_stats.transfers;
+    uart_stats.sent += n;
+
+    return 1;
+}
+
+static void kick(void)
+{
+    while (committed != tail) {
+        if (!claim())
+            return;
+        if (start_next())
+            return;
+        release();
+    }
+}
+
+
+/* Der DMA-Stream meldet das Ende eines Transfers, sobald das letzte Byte
+im Datenregister des USART steht - gesendet sind dann noch bis zu zwei
+Bytes nicht. Gibt es nichts mehr zu senden, so wartet der Besitzer daher
+auf TC des USART (TCIE, Bit 6 in CR1) und gibt busy und den Stop mode erst
+in USART2_IRQHandler frei. */
+static void uart_irq(dma_stream_t *s)
+{
+    dma_clear(s, DMA_FLAG_ALL);
+
+    tail += chunk;
+
+    if (!start_next())
+        BITBAND_SET(&USART2->CR1, 6);
+}
+
+static void uart_tx_done(void)
+{
+    BITBAND_CLEAR(&USART2->CR1, 6);
+
+    if (!start_next()) {
+        release();
+        kick();
+    }
+}
+
+
+
+//----------------------------------------------------------------------------
+
+void uart_init(uint32_t baud)
+{
+    dma_mode_t mode = {
+        DMA_SIZE_8, DMA_BURST_1, DMA_SIZE_8, DMA_BURST_1, DMA_FIFO_DIRECT
+    };
+    uint32_t cr;
+
+    // PA2: Alternate Function 7 (USART2_TX)
+    RCC->AHB1ENR |= 0x00000001;
+    GPIO_CONFIGURE(GPIOA, GPIO_PIN(2),
+        GPIO_MODE_AF | GPIO_PP | GPIO_50MHZ | GPIO_NOPULL | GPIO_AF(7));
+
+    RCC->APB1ENR |= 0x00020000;     // USART2 mit Takt versorgen
+
+    dma.fn = uart_irq;
+    if (!dma_claim(DMA_REQ_USART2_TX, &dma))
+        while (1);
+
+    head      = 0;
+    committed = 0;
+    tail      = 0;
+    writers   = 0;
+    busy      = 0;
+
+    /* Jede Anforderung des USART holt genau ein Byte - ein FIFO brchte
+       hier nichts (s. dma_mode_benchmark() in discovery_ex.c). MINC,
+       Speicher zu Peripherie, TCIE. */
+    dma_mode(&dma, &mode, &cr);
+    dma.stream->PAR = (uint32_t)(&(USART2->DR));
+    dma.stream->CR  = dma.chsel | cr | 0x00000450;
+
+    /* Bei 16-facher berabtastung ist BRR einfach der Bustakt (42MHz an
+       APB1) geteilt durch die Baudrate, die unteren 4 Bits sind der
+       Nachkommateil. 2MBaud ergeben genau 21 = 0x15. */
+    USART2->CR1 = 0x0000;
+    USART2->BRR = (uint16_t)((42000000UL + baud / 2) / baud);
+    USART2->CR2 = 0x0000;           // 1 Stoppbit
+    USART2->CR3 = 0x0080;           // DMAT: DMA-Anforderungen beim Senden
+    USART2->CR1 = 0x2008;           // UE, TE
+
+    /* USART2 hat die Interrupt Nummer 38 (Tabelle 30 in [1]). Er erhlt eine
+    niedrigere Prioritt als die DMA-Streams, damit uart_rx_irq() die Ring-
+    hlften auch dann mitzhlt, wenn rx_process() gerade luft. */
+    NVIC->IP[38] = 0x10;
+    NVIC->ISER[1] = 1UL << (38 - 32);
+}
+
+
+
+int uart_reserve(uart_slot_t *s, uint32_t len)
+{
+    volatile uint32_t *p = &head;
+    uint32_t h;
+
+    atomic_add(&writers, 1);
+
+    do {
+        h = __LDREXW(p);
+        if (h + len - tail > UART_RING) {
+            __CLREX();
+            uart_stats.dropped += len;
+            uart_commit(0, 0);
+            return 0;
+        }
+    } while (__STREXW(h + len, p));
+
+    s->pos = h & RING_MASK;
+    s->len = len;
+
+    return 1;
+}
+
+
+
+void uart_commit(uart_slot_t *s, uint32_t used)
+{
+    volatile uint32_t *p = &head;
+    uint32_t end, c, h;
+
+    if (s && used < s->len) {
+        /* Ist unser Bereich noch der letzte im Ring, so wird head einfach
+           zurckgesetzt. */
+        end = (s->pos + s->len) & RING_MASK;
+        do {
+            h = __LDREXW(p);
+            if ((h & RING_MASK) != end) {
+                __CLREX();
+                for (c = used; c < s->len; ++c)
+                    uart_ring[(s->pos + c) & RING_MASK] = 0;
+                uart_stats.padded += s->len - used;
+                break;
+            }
+        } while (__STREXW(h - (s->len - used), p));
+    }
+
+    /* writers um eins verringern, der Letzte gibt alles bis head frei.
+       head wird erst danach gelesen: Hat eine Interruptroutine zuvor noch
+       reserviert und geschrieben, so ist ihr Bereich damit enthalten.
+       Reserviert jemand (z.B. ein anderer Thread) zwischen dem Verringern
+       und dem Lesen, so ist writers wieder gesetzt - sein Bereich ist noch
+       nicht geschrieben, und er gibt beim eigenen uart_commit() alles frei. */
+    if (atomic_add(&writers, -1) == 0) {
+        h = head;
+        if (writers == 0) {
+            /* Zwischen dem Lesen von head und dem Setzen von committed
+               kann eine Interruptroutine ihrerseits committed weiter
+               vorschieben. Der Wert darf dann nicht wieder zurckgesetzt
+               werden: */
+            do {
+                c = __LDREXW(&committed);
+                if ((int32_t)(h - c) <= 0) {
+                    __CLREX();
+                    break;
+                }
+            } while (__STREXW(h, &committed));
+        }
+    }
+
+    kick();
+}
+
+
+
+int uart_write(const void *data, uint32_t len)
+{
+    const uint8_t *d = data;
+    uart_slot_t s;
+    uint32_t i;
+
+    if (!uart_reserve(&s, len))
+        return 0;
+
+    for (i = 0; i < len; ++i)
+        uart_ring[(s.pos + i) & RING_MASK] = d[i];
+
+    uart_commit(&s, len);
+
+    return 1;
+}
+
+
+
+void uart_flush(void)
+{
+    while (committed != tail);
+
+    // das letzte Byte verlsst das Schieberegister: TC (Bit 6)
+    while (!(USART2->SR & 0x0040));
+}
+
+
+
+//----------------------------------------------------------------------------
+
+/* Anzahl der Bytes, die der DMA-Controller seit uart_rx_start() in den Ring
+geschrieben hat: die gemeldeten Hlften plus der Abstand der Schreib-
+position von der letzten gemeldeten Grenze. Liegt eine Grenze schon hinter
+der Schreibposition, ohne dass uart_rx_irq() gelaufen ist, so stimmt das
+Ergebnis trotzdem, solange die Versptung unter einem Ring bleibt. */
+static uint32_t rx_written(void)
+{
+    uint32_t h, wr;
+
+    // uart_rx_irq() kann uns unterbrechen - dann noch einmal
+    do {
+        h  = rxHalves;
+        wr = UART_RX_RING - rx.stream->NDTR;
+    } while (h != rxHalves);
+
+    h *= UART_RX_RING / 2;
+
+    return h + ((wr - h) & RX_MASK);
+}
+
+
+/* Untersucht alle Bytes, die der DMA-Controller seit dem letzten Aufruf in
+den Ring geschrieben hat. Luft nur in USART2_IRQHandler.
+
+Ist die Verarbeitung zu lange aufgehalten worden (z.B. durch eine lang-
+same Rckruffunktion), kann der DMA-Controller ungelesene Bytes schon
+wieder berschrieben haben. NDTR allein verrt das nicht. Daher zhlt
+uart_rx_irq() mit hherer Prioritt die Ringhlften mit, und rx_written()
+liefert die Zahl aller geschriebenen Bytes. Liegt sie einen ganzen Ring
+oder mehr vor rxRead, so wird die angefangene Zeile verworfen und ab der
+Schreibposition weitergelesen.
+
+Unerkannt bleibt eine berrundung nur, wenn auch uart_rx_irq() lnger als
+einen Ring lang nicht laufen kann, z.B. bei gesperrten Interrupts: Die
+Flags HT und TC melden dann mehrere Hlften als eine. */
+static void rx_process(void)
+{
+    uint32_t wr = rx_written();
+    uart_slice_t line;
+    uint8_t c;
+
+    if (wr - rxRead >= UART_RX_RING) {
+        ++uart_stats.overruns;
+        rxRead  = wr;
+        rxStart = wr & RX_MASK;
+        rxLen   = 0;
+        rxDrop  = 1;
+        return;
+    }
+
+    while (rxRead != wr) {
+        c = uart_rx_ring[rxRead & RX_MASK];
+        ++rxRead;
+        ++uart_stats.received;
+
+        if (c != '\r' && c != '\n') {
+            if (++rxLen > UART_RX_LINE && !rxDrop) {
+                rxDrop = 1;
+                ++uart_stats.overruns;
+            }
+            continue;
+        }
+
+        if (rxLen && !rxDrop) {
+            line.part[0] = &uart_rx_ring[rxStart];
+            line.part[1] = uart_rx_ring;
+            if (rxStart + rxLen > UART_RX_RING) {
+                line.len[0] = UART_RX_RING - rxStart;
+                line.len[1] = rxLen - line.len[0];
+            } else {
+                line.len[0] = rxLen;
+                line.len[1] = 0;
+            }
+            ++uart_stats.lines;
+            rxLine(&line);
+        }
+
+        rxStart = rxRead & RX_MASK;
+        rxLen   = 0;
+        rxDrop  = 0;
+    }
+}
+
+/* Der Stream meldet die Hlfte (HT) und das Ende (TC) des Rings. Auf eine
+gerade Zahl gemeldeter Hlften folgt HT, auf eine ungerade TC. Ist nur das
+andere Flag gesetzt oder sind es beide, so sind zwei Grenzen vergangen.
+Die Zeilen sucht rx_process() mit niedrigerer Prioritt (s. uart_init()). */
+static void uart_rx_irq(dma_stream_t *s)
+{
+    uint32_t flags = dma_flags(s) & (DMA_FLAG_HT | DMA_FLAG_TC);
+    uint32_t next  = (rxHalves & 1) ? DMA_FLAG_TC : DMA_FLAG_HT;
+
+    dma_clear(s, DMA_FLAG_ALL);
+
+    if (flags)
+        rxHalves += (flags == next) ? 1 : 2;
+
+    NVIC->ISPR[1] = 1UL << (38 - 32);
+}
+
+/* USART2 meldet das Ende des Sendens (TC, Bit 6, s. uart_irq()), eine
+Pause (IDLE, Bit 4) oder einen Fehler (ORE, NE, FE, Bits 3 bis 1). Gelscht
+werden die letzten beiden durch Lesen von SR und danach DR - da der DMA-
+Controller jedes Byte sofort abholt, geht dabei nichts verloren. Auerdem
+lst uart_rx_irq() diesen Interrupt aus. */
+void USART2_IRQHandler(void)
+{
+    uint16_t sr = USART2->SR;
+
+    if ((sr & 0x0040) && BITBAND_TEST(&USART2->CR1, 6))
+        uart_tx_done();
+
+    if (sr & 0x001E) {
+        (void)USART2->DR;
+
+        if (sr & 0x000E)
+            ++uart_stats.errors;
+        if (sr & 0x0010)
+            ++uart_stats.idles;
+    }
+
+    if (rxLine)
+        rx_process();
+}
+
+
+
+void uart_rx_start(uart_line_fn fn)
+{
+    // PA3: Alternate Function 7 (USART2_RX), Pull-Up hlt die Leitung auf 1
+    GPIO_CONFIGURE(GPIOA, GPIO_PIN(3),
+        GPIO_MODE_AF | GPIO_PULLUP | GPIO_AF(7));
+
+    rx.fn = uart_rx_irq;
+    if (!dma_claim(DMA_REQ_USART2_RX, &rx))
+        while (1);
+
+    rxLine  = fn;
+    rxRead  = 0;
+    rxStart = 0;
+    rxLen   = 0;
+    rxDrop  = 0;
+    rxHalves = 0;
+
+    // MINC, circular mode, Peripherie zu Speicher, HTIE und TCIE
+    rx.stream->PAR  = (uint32_t)(&(USART2->DR));
+    rx.stream->M0AR = (uint32_t)uart_rx_ring;
+    rx.stream->NDTR = UART_RX_RING;
+    rx.stream->CR   = rx.chsel | 0x00000518;
+    rx.stream->CR  |= 0x00000001;
+
+    /* Im Stop mode stnde der USART, und er kann den Prozessor auch nicht
+       wecken. Solange empfangen wird, bleibt der Stop mode daher verboten
+       (Empfang und Sendeende teilen sich den Interrupt aus uart_init()). */
+    power_hold();
+
+    USART2->CR3 |= 0x0041;          // DMAR, EIE
+    BITBAND_SET(&USART2->CR1, 2);   // RE
+    BITBAND_SET(&USART2->CR1, 4);   // IDLEIE
+}
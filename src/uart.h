@@ -0,0 +1,121 @@
+#ifndef UART_H
+#define UART_H
+
+/*
+ * In den Dateien uart.h und uart.c findet sich ein Treiber fr das Senden
+ * ber USART2 (TX an PA2, Alternate Function 7). Die Daten landen in einem
+ * Ringpuffer, aus dem sie der DMA-Controller im Hintergrund an den USART
+ * weiterreicht. Wer etwas senden will, reserviert zunchst Platz im Ring
+ * (uart_reserve), schreibt dort direkt hinein und gibt den Platz dann frei
+ * (uart_commit). So wird z.B. ein formatierter Text nicht erst in einen
+ * eigenen Puffer geschrieben und dann kopiert (s. log.c).
+ *
+ * Reservieren und Freigeben kommen ohne Sperren von Interrupts aus und
+ * drfen auch in Interruptroutinen verwendet werden. Ist der Ring voll, so
+ * wird nicht gewartet, sondern die Nachricht verworfen.
+ *
+ * USART2_TX gibt es nur an DMA1 Stream 6 (Kanal 4), den auch pwm_burst.c
+ * fr TIM4_UP braucht - beide lassen sich daher nicht gleichzeitig nutzen.
+ *
+ * Der Empfang (RX an PA3) luft ebenfalls per DMA, und zwar im circular
+ * mode in einen eigenen Ring. Statt eines Interrupts pro Byte meldet der
+ * USART eine Pause auf der Leitung ("idle line"), dazu kommen die
+ * Interrupts bei halb und ganz geflltem Ring. Erst dann werden die neuen
+ * Bytes nach Zeilenenden durchsucht und jede Zeile direkt im Ring an eine
+ * Funktion bergeben (s. cmd.h).
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+// Definition der standard Integer-Typen
+#include <stdint.h>
+
+// Gre des Ringpuffers in Byte (Zweierpotenz)
+#define UART_RING  4096
+
+/* Ein reservierter Bereich im Ring. Er beginnt bei uart_ring[pos] und kann
+ber das Ende des Rings hinweg an dessen Anfang weiterlaufen, geschrieben
+wird daher z.B. mit uart_ring[(s.pos + i) % UART_RING]. */
+typedef struct
+{
+    uint32_t pos;
+    uint32_t len;
+} uart_slot_t;
+
+/* Gre des Empfangsrings in Byte (Zweierpotenz) und lngste Zeile.
+Lngere Zeilen werden verworfen. */
+#define UART_RX_RING  256
+#define UART_RX_LINE  (UART_RX_RING / 2)
+
+/* Eine empfangene Zeile (ohne Zeilenende) im Empfangsring. Luft sie ber
+das Ende des Rings, so besteht sie aus zwei Teilen, sonst ist len[1] = 0. */
+typedef struct
+{
+    const uint8_t *part[2];
+    uint32_t       len[2];
+} uart_slice_t;
+
+typedef void (*uart_line_fn)(const uart_slice_t *line);
+
+// Statistik, z.B. zur Betrachtung im Debugger
+typedef struct
+{
+    uint32_t sent;      // an den DMA-Controller bergebene Bytes
+    uint32_t dropped;   // verworfene Bytes (Ring voll)
+    uint32_t padded;    // Fllbytes, s. uart_commit()
+    uint32_t transfers; // DMA-Transfers
+
+    uint32_t received;  // empfangene Bytes
+    uint32_t lines;     // bergebene Zeilen
+    uint32_t overruns;  // verworfene Zeilen (zu lang oder berrundet)
+    uint32_t errors;    // Fehler des USART (overrun, noise, framing)
+    uint32_t idles;     // Pausen auf der Leitung
+} uart_stats_t;
+
+extern volatile uart_stats_t uart_stats;
+
+extern uint8_t uart_ring[UART_RING];
+
+/* Initialisiert USART2 (8N1) mit der angegebenen Baudrate, z.B. 2000000,
+sowie den DMA-Stream fr das Senden. */
+void uart_init(uint32_t baud);
+
+/* Reserviert len Byte im Ring. Liefert 0, falls nicht genug Platz frei ist
+(die Bytes zhlen dann als verworfen). */
+int uart_reserve(uart_slot_t *s, uint32_t len);
+
+/* Gibt einen reservierten Bereich zum Senden frei, von dem nur die ersten
+used Bytes beschrieben wurden. Den Rest gibt die Funktion an den Ring
+zurck, wenn seit dem Reservieren niemand sonst reserviert hat - sonst wird
+er mit Nullbytes gefllt, die ein Terminal nicht anzeigt und ein COBS-
+Decoder als leere Pakete berspringt. */
+void uart_commit(uart_slot_t *s, uint32_t used);
+
+/* Kopiert len Byte in den Ring. Liefert 0, falls nicht genug Platz frei
+ist. */
+int uart_write(const void *data, uint32_t len);
+
+/* Wartet, bis alle freigegebenen Bytes gesendet sind. */
+void uart_flush(void);
+
+/* Startet den Empfang. uart_init() muss zuvor aufgerufen worden sein. Die
+Funktion fn wird im Interrupt fr jede Zeile aufgerufen, die mit '\r' oder
+'\n' endet (leere Zeilen werden bersprungen). Die Zeile liegt noch im
+Ring und wird berschrieben, sobald weitere UART_RX_RING - UART_RX_LINE
+Bytes eingetroffen sind (bei 2MBaud nach 640us) - fn muss also zgig
+fertig werden oder die Daten kopieren. */
+void uart_rx_start(uart_line_fn fn);
+
+/* Liefert das Byte an Position i einer Zeile. */
+static inline uint8_t uart_slice_at(const uart_slice_t *s, uint32_t i)
+{
+    return i < s->len[0] ? s->part[0][i] : s->part[1][i - s->len[0]];
+}
+
+static inline uint32_t uart_slice_len(const uart_slice_t *s)
+{
+    return s->len[0] + s->len[1];
+}
+
+#endif
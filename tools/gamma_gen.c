@@ -0,0 +1,63 @@
+/*
+ * Erzeugt die Gamma-Tabelle src/gamma_lut.h fr led.c. Das Programm luft
+ * auf dem PC, nicht auf dem Mikrocontroller:
+ *
+ *     make gamma
+ *
+ * oder von Hand
+ *
+ *     gcc -O2 -o gamma_gen tools/gamma_gen.c -lm
+ *     ./gamma_gen 2.2 > src/gamma_lut.h
+ *
+ * Das Auge nimmt Helligkeit nicht linear wahr: Die Hlfte der Leistung
+ * erscheint deutlich heller als "halb so hell". Eine Tabelle bildet daher
+ * jede der LED_LEVELS Helligkeitsstufen ber out = in^gamma auf einen PWM-
+ * Wert ab. Die Werte haben 4 Nachkommabits (16.4 Festkomma). Diese Bits
+ * verteilt led.c zeitlich ber 16 PWM-Perioden ("dithering").
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+// muss zu LED_LEVELS in led.h passen
+#define LEVELS  1024
+
+int main(int argc, char **argv)
+{
+    double gamma = 2.2;
+    double x;
+    unsigned long v;
+    int i;
+
+    if (argc > 1)
+        gamma = atof(argv[1]);
+
+    printf("#ifndef GAMMA_LUT_H\n");
+    printf("#define GAMMA_LUT_H\n\n");
+    printf("/*\n");
+    printf(" * Erzeugt von tools/gamma_gen.c (gamma = %.2f) - nicht von Hand ndern!\n",
+           gamma);
+    printf(" * %d Helligkeitsstufen, PWM-Werte im Format 16.4 (0 bis 0xFFFF0).\n",
+           LEVELS);
+    printf(" */\n\n");
+    printf("// Definition der standard Integer-Typen\n");
+    printf("#include <stdint.h>\n\n");
+    printf("static const uint32_t gammaLut[%d] = {", LEVELS);
+
+    for (i = 0; i < LEVELS; ++i) {
+        x = pow((double)i / (LEVELS - 1), gamma);
+        v = (unsigned long)(x * 0xFFFF0 + 0.5);
+
+        if (i % 8 == 0)
+            printf("\n   ");
+        printf(" 0x%05lX%s", v, i < LEVELS - 1 ? "," : "");
+    }
+
+    printf("\n};\n\n#endif\n");
+
+    return 0;
+}
@@ -0,0 +1,87 @@
+/*
+ * Erzeugt aus einem fr Slot A oder B gelinkten Programm ein Image fr den
+ * Bootloader (s. src/boot.h): Kopf mit Version, Lnge und CRC-32, aufgefllt
+ * auf 512 Byte, dahinter das Programm. Das Programm luft auf dem PC, nicht
+ * auf dem Mikrocontroller:
+ *
+ *     make SLOT=a VERSION=3 image
+ *
+ * oder von Hand
+ *
+ *     arm-none-eabi-objcopy -O binary obj/STM32F4_Edu.elf app.bin
+ *     gcc -O2 -Isrc -o imgpack tools/imgpack.c
+ *     ./imgpack 3 app.bin app.img
+ *
+ * Das Image wird an den Anfang des Slots geschrieben, z.B. mit
+ *
+ *     st-flash write app.img 0x08020000
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "boot.h"
+
+// Programm und Kopf, das Programm beginnt bei image[BOOT_HEADER / 4]
+static uint32_t image[BOOT_SLOT_SIZE / 4];
+
+
+int main(int argc, char **argv)
+{
+    uint8_t *bytes = (uint8_t*)&image[BOOT_HEADER / 4];
+    boot_header_t *h = (boot_header_t*)image;
+    uint32_t len, i;
+    FILE *in, *out;
+    int c;
+
+    if (argc != 4) {
+        fprintf(stderr, "usage: imgpack version app.bin app.img\n");
+        return 1;
+    }
+
+    in = fopen(argv[2], "rb");
+    if (!in) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    // gelschter Flash-Speicher: alle Bits 1
+    for (i = 0; i < BOOT_SLOT_SIZE / 4; ++i)
+        image[i] = 0xFFFFFFFF;
+
+    len = 0;
+    while ((c = fgetc(in)) != EOF) {
+        if (len == BOOT_SLOT_SIZE - BOOT_HEADER) {
+            fprintf(stderr, "%s: program larger than a slot\n", argv[2]);
+            return 1;
+        }
+        bytes[len++] = (uint8_t)c;
+    }
+    fclose(in);
+
+    // die CRC-Einheit rechnet in ganzen Worten (Rest bleibt 0xFF)
+    len = (len + 3) & ~3UL;
+
+    h->magic   = BOOT_MAGIC;
+    h->version = (uint32_t)strtoul(argv[1], 0, 0);
+    h->length  = len;
+    h->crc     = boot_crc32(0xFFFFFFFF, &image[BOOT_HEADER / 4], len / 4);
+
+    /* Auch der Mikrocontroller liest die Worte little endian - das Image
+       muss also auf einem little endian PC (x86, ARM) erzeugt werden. */
+    out = fopen(argv[3], "wb");
+    if (!out || fwrite(image, 1, BOOT_HEADER + len, out) != BOOT_HEADER + len) {
+        perror(argv[3]);
+        return 1;
+    }
+    fclose(out);
+
+    fprintf(stderr, "%s: version %u, %u bytes, crc 0x%08X\n", argv[3],
+            (unsigned)h->version, (unsigned)len, (unsigned)h->crc);
+
+    return 0;
+}
@@ -0,0 +1,151 @@
+/*
+ * Wandelt einen aufgezeichneten Telemetrie-Datenstrom (s. src/telemetry.h)
+ * in eine CSV-Datei um. Das Programm luft auf dem PC, nicht auf dem
+ * Mikrocontroller:
+ *
+ *     make telemetry_decode
+ *
+ * oder von Hand
+ *
+ *     gcc -O2 -Isrc -o telemetry_decode tools/telemetry_decode.c
+ *
+ * Aufzeichnen z.B. unter Linux mit einem USB-Seriell-Wandler an PA2:
+ *
+ *     stty -F /dev/ttyUSB0 2000000 raw
+ *     cat /dev/ttyUSB0 > capture.bin
+ *     ./telemetry_decode capture.bin > capture.csv
+ *
+ * Ohne Dateiname wird von der Standardeingabe gelesen. Jede Zeile der
+ * Ausgabe ist ein Datensatz: Paketnummer, Zeit in us, Typ und Nutzdaten.
+ * Fehlerhafte und verlorene Pakete werden am Ende auf stderr gemeldet.
+ *
+ * Autor:  J. Kerdels
+ * Lizenz: CC BY 3.0
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "telemetry.h"
+
+static const uint8_t sizes[TELEM_TYPES] = TELEM_SIZES;
+
+static unsigned long frames, crcErrors, formatErrors, lost;
+
+
+/* Macht die Kodierung von telemetry_flush() rckgngig. Liefert die Lnge
+des Pakets oder 0 bei einem Fehler. */
+static uint32_t cobs_decode(const uint8_t *in, uint32_t len, uint8_t *out)
+{
+    uint32_t i = 0, n = 0, k;
+    uint8_t code;
+
+    while (i < len) {
+        code = in[i++];
+        if (code == 0 || i + code - 1 > len)
+            return 0;
+        for (k = 1; k < code; ++k)
+            out[n++] = in[i++];
+        if (code < 0xFF && i < len)
+            out[n++] = 0;
+    }
+
+    return n;
+}
+
+
+static void frame_decode(const uint8_t *f, uint32_t len)
+{
+    static int first = 1;
+    static uint8_t lastSeq;
+    uint32_t t, pos, dt;
+    uint16_t crc;
+    uint8_t type;
+
+    if (len < TELEM_HEADER + TELEM_CRC) {
+        ++formatErrors;
+        return;
+    }
+
+    crc = telemetry_crc16(0xFFFF, f, len - TELEM_CRC);
+    if (crc != (f[len - 2] | (f[len - 1] << 8))) {
+        ++crcErrors;
+        return;
+    }
+
+    ++frames;
+    if (!first)
+        lost += (uint8_t)(f[0] - lastSeq - 1);
+    first   = 0;
+    lastSeq = f[0];
+
+    t   = f[1] | (f[2] << 8) | (f[3] << 16) | ((uint32_t)f[4] << 24);
+    pos = TELEM_HEADER;
+    len -= TELEM_CRC;
+
+    while (pos < len) {
+        type = f[pos];
+        if (type == 0 || type >= TELEM_TYPES ||
+            pos + TELEM_RECORD + sizes[type] > len) {
+            ++formatErrors;
+            return;
+        }
+        dt   = f[pos + 1] | (f[pos + 2] << 8);
+        t   += dt;
+        pos += TELEM_RECORD;
+
+        switch (type) {
+        case TELEM_ACC:
+            printf("%u,%lu,acc,%d,%d,%d\n", f[0], (unsigned long)t,
+                   (int8_t)f[pos], (int8_t)f[pos + 1], (int8_t)f[pos + 2]);
+            break;
+        }
+        pos += sizes[type];
+    }
+}
+
+
+int main(int argc, char **argv)
+{
+    FILE *in = stdin;
+    uint8_t raw[TELEM_COBS_MAX(TELEM_FRAME_MAX)];
+    uint8_t frame[sizeof(raw)];
+    uint32_t n = 0, len;
+    int c;
+
+    if (argc > 1) {
+        in = fopen(argv[1], "rb");
+        if (!in) {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    printf("seq,t_us,type,x,y,z\n");
+
+    /* Bis zum nchsten Nullbyte sammeln. Leere Pakete (z.B. die Fllbytes
+       aus uart_commit()) und zu lange Pakete werden bergangen. */
+    while ((c = fgetc(in)) != EOF) {
+        if (c != 0) {
+            if (n < sizeof(raw))
+                raw[n] = (uint8_t)c;
+            ++n;
+            continue;
+        }
+        if (n > sizeof(raw)) {
+            ++formatErrors;
+        } else if (n > 0) {
+            len = cobs_decode(raw, n, frame);
+            if (len)
+                frame_decode(frame, len);
+            else
+                ++formatErrors;
+        }
+        n = 0;
+    }
+
+    fprintf(stderr, "%lu Pakete, %lu CRC-Fehler, %lu Formatfehler, "
+            "%lu verloren\n", frames, crcErrors, formatErrors, lost);
+
+    return 0;
+}